@@ -95,6 +95,17 @@ public:
     /** \copydoc tools::collections::Iterable::iterator */
     virtual tools::dp::Iterator<Sequence>* iterator () = 0;
 
+    /** Create an iterator on the bank that is split into parts. The parts are the iterators given by
+     * the getComposition method of the returned iterator; they iterate disjoint subsets of the sequences
+     * and can be iterated concurrently by different threads (see IDispatcher::iterate). The returned
+     * iterator itself iterates all the sequences, part after part.
+     *
+     * An implementation that can't split the bank returns an iterator with a single part, so the number
+     * of parts may be smaller than the requested one.
+     * \param[in] nbParts : number of requested parts
+     * \return the iterator. */
+    virtual tools::dp::Iterator<Sequence>* splitIterator (size_t nbParts) = 0;
+
     /** \copydoc tools::collections::Bag::insert */
     virtual void insert (const Sequence& item) = 0;
 
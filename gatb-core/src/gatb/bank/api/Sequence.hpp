@@ -78,6 +78,29 @@ struct Sequence
      * \param[in] seq : the genomic data as an ascii string */
     Sequence (char* seq) : _data(seq), _index(0)  {}
 
+    /** Copy constructor. The comment and the quality are retrieved through the getters, so they
+     * are available in the copy even if the source provides them lazily.
+     * \param[in] s : the sequence to be copied */
+    Sequence (const Sequence& s) : _comment(s.getComment()), _quality(s.getQuality()), _data(s.getDataEncoding()), _index(s._index)
+    {
+        _data = s._data;
+    }
+
+    /** Affectation operator (see the copy constructor).
+     * \param[in] s : the sequence to be copied
+     * \return the instance */
+    Sequence& operator= (const Sequence& s)
+    {
+        if (this != &s)
+        {
+            _comment = s.getComment();
+            _quality = s.getQuality();
+            _data    = s._data;
+            _index   = s._index;
+        }
+        return *this;
+    }
+
     /** Destructor. */
     virtual ~Sequence ()  { }
 
@@ -85,7 +108,7 @@ struct Sequence
     virtual const std::string& getComment ()  const  { return _comment; }
 
     /** \return description of the sequence until first space */
-    virtual const std::string getCommentShort ()  const  { return _comment.substr(0, _comment.find(' ')); }
+    virtual const std::string getCommentShort ()  const  { const std::string& cmt = getComment();  return cmt.substr(0, cmt.find(' ')); }
 
     /** \return quality of the sequence (set if the underlying bank is a fastq file). */
     virtual const std::string& getQuality ()  const  { return _quality; }
@@ -138,6 +161,16 @@ struct Sequence
      * \param[in] qual : quality string of the sequence. */
     void setQuality (const std::string& qual)  { _quality = qual; }
 
+    /** Exchange the content of two sequences, without copying the nucleotides, the comments and the qualities.
+     * \param[in] s : sequence to be exchanged with the current instance */
+    void swap (Sequence& s)
+    {
+        _comment.swap (s._comment);
+        _quality.swap (s._quality);
+        _data.swap    (s._data);
+        std::swap (_index, s._index);
+    }
+
     /** Comment attribute (note: should be private with a setter and getter). */
     std::string _comment;
 
@@ -153,6 +186,9 @@ private:
     size_t _index;
 };
 
+/** Exchange the content of two sequences (found by argument dependent lookup, see Sequence::swap). */
+inline void swap (Sequence& a, Sequence& b)  {  a.swap (b);  }
+
 /********************************************************************************/
 } } } /* end of namespaces. */
 /********************************************************************************/
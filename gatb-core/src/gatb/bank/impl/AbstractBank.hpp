@@ -84,6 +84,10 @@ public:
     /** \copydoc IBank::finalize */
     void finalize ()  {}
 
+    /** \copydoc IBank::splitIterator
+     * By default, the bank is not split. */
+    tools::dp::Iterator<Sequence>* splitIterator (size_t nbParts)  { return this->iterator(); }
+
     /** \copydoc IBank::getCompositionNb */
     size_t getCompositionNb ()
     {
@@ -21,8 +21,13 @@
 #include <gatb/tools/misc/api/StringsRepository.hpp>
 
 #include <gatb/system/impl/System.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
+#include <algorithm>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 using namespace std;
 using namespace gatb::core::system;
@@ -39,20 +44,26 @@ static u_int64_t BINREADS_BUFFER = 100000;
 
 /********************************************************************************/
 
-static u_int64_t MAGIC_NUMBER = 0x12345678;  // set to 0 for no usage of magic number
+static u_int64_t MAGIC_NUMBER    = 0x12345678;  // first version of the format (no index)
+static u_int64_t MAGIC_NUMBER_V2 = 0x12345679;  // second version of the format (index at the end of the file)
+
+/** Number of fields of an index entry in the file. */
+static const size_t BLOCK_NB_FIELDS = 5;
+
+/** Bit of the sequence length telling that the nucleotides are followed by a mask of the invalid ones. */
+static const u_int32_t INVALID_MASK_FLAG = 0x80000000;
 
 static void writeMagic (FILE* file)
 {
-    if (MAGIC_NUMBER != 0)  {  fwrite (&MAGIC_NUMBER, sizeof(MAGIC_NUMBER), 1, file);  }
+    fwrite (&MAGIC_NUMBER_V2, sizeof(MAGIC_NUMBER_V2), 1, file);
 }
 
-static bool checkMagic (FILE* file)
+/** Returns the version of the format (0 if the file is not a binary bank). */
+static int checkMagic (FILE* file)
 {
-    if (MAGIC_NUMBER == 0)  { return true; }
-
     u_int64_t value = 0;
-    fread (&value, sizeof(value), 1, file);
-    return  value==MAGIC_NUMBER;
+    if (fread (&value, sizeof(value), 1, file) != 1)  { return 0; }
+    return  value==MAGIC_NUMBER ? 1 : (value==MAGIC_NUMBER_V2 ? 2 : 0);
 }
 
 /********************************************************************************/
@@ -101,7 +112,8 @@ unsigned char  code_n_NT(const char *seq, int nb)
 ** REMARKS :
 *********************************************************************/
 BankBinary::BankBinary (const std::string& filename, size_t nbValidLetters)
-    : _filename(filename), _nbValidLetters(nbValidLetters), binary_read_file(0)
+    : _filename(filename), _nbValidLetters(nbValidLetters), binary_read_file(0),
+      _map(0), _mapSize(0), _nbIterators(0), _isLoaded(false), _synchro(0)
 {
     read_write_buffer_size = BINREADS_BUFFER;
 
@@ -110,6 +122,10 @@ BankBinary::BankBinary (const std::string& filename, size_t nbValidLetters)
     buffer = (unsigned char *) MALLOC (read_write_buffer_size*sizeof(unsigned char));
 
     cpt_buffer = 0;
+
+    memset (&_currentBlock, 0, sizeof(_currentBlock));
+
+    _synchro = System::thread().newSynchronizer();
 }
 
 /*********************************************************************
@@ -126,6 +142,14 @@ BankBinary::~BankBinary ()
     {
         FREE (buffer); //buffer =NULL;
     }
+
+    unload ();
+
+    for (size_t i=0; i<_releasedMaps.size(); i++)  {  munmap (_releasedMaps[i].first, _releasedMaps[i].second);  }
+
+    if (binary_read_file != 0)  {  fclose (binary_read_file);  }
+
+    delete _synchro;
 }
 
 /*********************************************************************
@@ -146,7 +170,6 @@ void BankBinary::insert (const Sequence& seq)
     int readlen = 0;
     int tai = readlen;
     unsigned char rbin;
-    unsigned int block_size = 0;
     char *pt;
     
     char * pt_begin = pt_start;
@@ -179,34 +202,40 @@ void BankBinary::insert (const Sequence& seq)
         //we have a seq beginning at  pt_begin of size idx  ,without any N, will be treated as a read: of size readlen, beginning at pt
         readlen = tai = idx;
         pt      = pt_begin;
-        
+
+        /** We look for the invalid nucleotides (same criterion as Data::ConvertASCII), coded as runs (start,length). */
+        _invalidRuns.clear();
+        for (int i=0; i<readlen; i++)
+        {
+            if (((pt[i]>>3) & 1) == 0)  { continue; }
+
+            if (!_invalidRuns.empty() && _invalidRuns[_invalidRuns.size()-2] + _invalidRuns.back() == (u_int32_t)i)  { _invalidRuns.back() ++; }
+            else  {  _invalidRuns.push_back (i);  _invalidRuns.push_back (1);  }
+        }
+
+        /** Number of bytes needed for the read: length, nucleotides and mask (number of runs and runs). */
+        int needed = sizeof(int) + (readlen+3)/4 + (_invalidRuns.empty() ? 0 : (_invalidRuns.size()+1)*sizeof(u_int32_t));
+
         /** We may have to open the file at first call. */
         if (binary_read_file == 0)  {  open (true); }
         
         //todo : also flush to disk  sometimes (ie if very large buffer, to create smaller blocks..)
-        if(cpt_buffer >= (read_write_buffer_size-readlen) || cpt_buffer > 10000000 )  ////not enough space to store next read   true space is 4 + readlen/4 + rem
+        if(cpt_buffer > (read_write_buffer_size-needed) || cpt_buffer > 10000000 )  ////not enough space to store next read
             //flush buffer to disk
         {
-            block_size = cpt_buffer;
-            
-            if(block_size) fwrite(&block_size, sizeof(unsigned int), 1, binary_read_file); // block header
-            if (!fwrite(buffer, 1, cpt_buffer, binary_read_file)) // write a block, it ends at end of a read
-            {
-                printf("error: can't fwrite (disk full?)\n");
-                exit(1);
-            }
-            cpt_buffer=0;
+            writeBlock ();
         }
         
         //check if still not enough space in empty buffer : can happen if large read, then enlarge buffer
-        if(read_write_buffer_size < readlen)
+        if(read_write_buffer_size < needed)
         {
-            read_write_buffer_size = 2*readlen; // too large but ok
+            read_write_buffer_size = 2*needed; // too large but ok
             buffer =  (unsigned char *) REALLOC (buffer,sizeof(unsigned char) * read_write_buffer_size);
         }
         
-        /** We write the length of the read. */
-        memcpy(buffer+cpt_buffer,&readlen,sizeof(int));
+        /** We write the length of the read; a flag tells whether a mask follows the nucleotides. */
+        u_int32_t header = readlen | (_invalidRuns.empty() ? 0 : INVALID_MASK_FLAG);
+        memcpy(buffer+cpt_buffer,&header,sizeof(int));
         cpt_buffer+= sizeof(int);
         
         /** We write one byte for 4 nucleotides. */
@@ -223,6 +252,21 @@ void BankBinary::insert (const Sequence& seq)
             rbin = code_n_NT(pt,tai);
             buffer[cpt_buffer]=rbin; cpt_buffer++;
         }
+
+        /** We write the mask of the invalid nucleotides. */
+        if (!_invalidRuns.empty())
+        {
+            u_int32_t nbRuns = _invalidRuns.size() / 2;
+            memcpy (buffer+cpt_buffer, &nbRuns, sizeof(nbRuns));
+            cpt_buffer += sizeof(nbRuns);
+            memcpy (buffer+cpt_buffer, _invalidRuns.data(), _invalidRuns.size()*sizeof(u_int32_t));
+            cpt_buffer += _invalidRuns.size()*sizeof(u_int32_t);
+        }
+
+        /** We update the statistics of the current block. */
+        _currentBlock.nbSequences   ++;
+        _currentBlock.nbNucleotides += readlen;
+        _currentBlock.maxLength      = std::max (_currentBlock.maxLength, (u_int64_t)readlen);
     }
  }
 
@@ -234,26 +278,61 @@ void BankBinary::insert (const Sequence& seq)
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void BankBinary::flush ()
+void BankBinary::writeBlock ()
 {
-    unsigned int block_size =0;
+    if (cpt_buffer == 0)  { return; }
+
+    unsigned int block_size = cpt_buffer;
+
+    fwrite(&block_size, sizeof(unsigned int), 1, binary_read_file); // block header
+
+    _currentBlock.offset        = ftello (binary_read_file);
+    _currentBlock.size          = block_size;
+    _currentBlock.firstSequence = _blocks.empty() ? 0 : _blocks.back().firstSequence + _blocks.back().nbSequences;
+
+    if (!fwrite(buffer, 1, cpt_buffer, binary_read_file)) // write a block, it ends at end of a read
+    {
+        throw gatb::core::system::ExceptionErrno (STR_BANK_unable_write_file);
+    }
+
+    _blocks.push_back (_currentBlock);
+
+    memset (&_currentBlock, 0, sizeof(_currentBlock));
+    cpt_buffer=0;
+}
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the index of the blocks is written at the end of the file.
+*********************************************************************/
+void BankBinary::flush ()
+{
     if (binary_read_file != 0)
     {
-        if(cpt_buffer)
-        {
-            block_size = cpt_buffer;
+        writeBlock ();
 
-            fwrite(&block_size, sizeof(unsigned int), 1, binary_read_file); // block header
-            if (!fwrite(buffer, 1, cpt_buffer, binary_read_file))
-            {
-                throw gatb::core::system::ExceptionErrno (STR_BANK_unable_write_file);
-            }
+        bool isOk = true;
+
+        for (size_t i=0; i<_blocks.size(); i++)
+        {
+            u_int64_t fields[BLOCK_NB_FIELDS] = {
+                _blocks[i].offset, _blocks[i].size, _blocks[i].nbSequences, _blocks[i].nbNucleotides, _blocks[i].maxLength
+            };
+            isOk = isOk && fwrite (fields, sizeof(u_int64_t), BLOCK_NB_FIELDS, binary_read_file) == BLOCK_NB_FIELDS;
         }
-        cpt_buffer=0;
 
-        fclose(binary_read_file);
+        u_int64_t nbBlocks = _blocks.size();
+        isOk = isOk && fwrite (&nbBlocks,        sizeof(nbBlocks),        1, binary_read_file) == 1;
+        isOk = isOk && fwrite (&MAGIC_NUMBER_V2, sizeof(MAGIC_NUMBER_V2), 1, binary_read_file) == 1;
+
+        isOk = (fclose(binary_read_file) == 0) && isOk;
         binary_read_file = 0;
+
+        if (isOk == false)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_write_file);  }
     }
 }
 
@@ -267,6 +346,15 @@ void BankBinary::flush ()
 *********************************************************************/
 void BankBinary::open (bool write)
 {
+    /** The file is going to be rewritten, so we forget the current mapping. The file is removed
+     * rather than truncated, so a mapping kept by living iterators still refers the former content. */
+    if (write == true)
+    {
+        LocalSynchronizer sync (_synchro);
+        unload ();
+        if (System::file().doesExist (_filename))  {  System::file().remove (_filename);  }
+    }
+
     binary_read_file = fopen (_filename.c_str(), write?"wb":"rb");
     if( binary_read_file == NULL)
     {
@@ -277,6 +365,215 @@ void BankBinary::open (bool write)
     if (write == true)  {  writeMagic (binary_read_file);  }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : may be called by several iterators at the same time.
+*********************************************************************/
+void BankBinary::load ()
+{
+    LocalSynchronizer sync (_synchro);
+
+    if (_isLoaded == true)  { return; }
+
+    /** The index of the blocks is being built by the writer and is not in the file yet. */
+    if (binary_read_file != 0)  {  throw gatb::core::system::Exception (STR_BANK_being_written, _filename.c_str());  }
+
+    int fd = ::open (_filename.c_str(), O_RDONLY);
+    if (fd < 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    _mapSize = System::file().getSize (_filename);
+
+    /** The mapping is private, so the sequences of the bank may be modified in memory by the client. */
+    _map = _mapSize > 0 ? (char*) mmap (0, _mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : 0;
+    ::close (fd);
+
+    if (_map == MAP_FAILED)  {  _map = 0;  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    /** We check the magic number. */
+    u_int64_t magic = 0;
+    if (_mapSize >= sizeof(magic))  {  memcpy (&magic, _map, sizeof(magic));  }
+
+    _blocks.clear();
+
+    if (magic == MAGIC_NUMBER_V2)
+    {
+        /** We read the index at the end of the file. */
+        u_int64_t footer[2] = {0,0};
+        if (_mapSize >= sizeof(magic) + sizeof(footer))  {  memcpy (footer, _map + _mapSize - sizeof(footer), sizeof(footer));  }
+
+        /** The number of blocks comes from the file, so we check it before computing the index size
+         * (a huge number would wrap the product). */
+        const u_int64_t fieldsSize = BLOCK_NB_FIELDS * sizeof(u_int64_t);
+        u_int64_t nbBlocks  = footer[0];
+
+        if (footer[1] != MAGIC_NUMBER_V2  ||  _mapSize < sizeof(magic) + sizeof(footer)
+            ||  nbBlocks > (_mapSize - sizeof(magic) - sizeof(footer)) / fieldsSize)
+        {
+            unload ();
+            throw gatb::core::system::Exception (STR_BANK_unable_open_file, _filename.c_str());
+        }
+
+        u_int64_t indexSize = nbBlocks * fieldsSize;
+
+        /** The blocks are between the magic number and the index. */
+        u_int64_t dataEnd = _mapSize - sizeof(footer) - indexSize;
+
+        const char* loop = _map + dataEnd;
+
+        for (u_int64_t i=0; i<nbBlocks; i++, loop += fieldsSize)
+        {
+            u_int64_t fields[BLOCK_NB_FIELDS];
+            memcpy (fields, loop, sizeof(fields));
+
+            Block block;
+            block.offset        = fields[0];
+            block.size          = fields[1];
+            block.nbSequences   = fields[2];
+            block.nbNucleotides = fields[3];
+            block.maxLength     = fields[4];
+            block.firstSequence = _blocks.empty() ? 0 : _blocks.back().firstSequence + _blocks.back().nbSequences;
+
+            if (block.offset < sizeof(magic)  ||  block.offset > dataEnd  ||  block.size > dataEnd - block.offset)
+            {
+                unload ();
+                throw gatb::core::system::Exception (STR_BANK_unable_open_file, _filename.c_str());
+            }
+
+            _blocks.push_back (block);
+        }
+    }
+    else if (magic == MAGIC_NUMBER)
+    {
+        buildIndex ();
+    }
+    else
+    {
+        unload ();
+        throw gatb::core::system::Exception (STR_BANK_unable_open_file, _filename.c_str());
+    }
+
+    _isLoaded = true;
+
+    DEBUG (("BankBinary::load  uri=%s  size=%lld  nbBlocks=%ld\n", _filename.c_str(), _mapSize, _blocks.size()));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinary::unload ()
+{
+    if (_map != 0)
+    {
+        if (_nbIterators > 0)  {  _releasedMaps.push_back (std::make_pair (_map, _mapSize));  }
+        else                   {  munmap (_map, _mapSize);                                    }
+    }
+
+    _map      = 0;
+    _mapSize  = 0;
+    _isLoaded = false;
+    _blocks.clear();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinary::addIterator ()
+{
+    LocalSynchronizer sync (_synchro);
+
+    _nbIterators ++;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinary::removeIterator ()
+{
+    LocalSynchronizer sync (_synchro);
+
+    if (--_nbIterators == 0)
+    {
+        for (size_t i=0; i<_releasedMaps.size(); i++)  {  munmap (_releasedMaps[i].first, _releasedMaps[i].second);  }
+        _releasedMaps.clear();
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : a file of the first version is just a list of blocks.
+*********************************************************************/
+void BankBinary::buildIndex ()
+{
+    u_int64_t offset = sizeof(MAGIC_NUMBER);
+
+    while (offset + sizeof(unsigned int) <= _mapSize)
+    {
+        unsigned int block_size = 0;
+        memcpy (&block_size, _map + offset, sizeof(block_size));
+        offset += sizeof(block_size);
+
+        if (offset + block_size > _mapSize)  { break; }
+
+        Block block;
+        block.offset        = offset;
+        block.size          = block_size;
+        block.nbSequences   = 0;
+        block.nbNucleotides = 0;
+        block.maxLength     = 0;
+        block.firstSequence = _blocks.empty() ? 0 : _blocks.back().firstSequence + _blocks.back().nbSequences;
+
+        /** We loop the sequences of the block. */
+        for (const char* loop = _map + offset; loop < _map + offset + block_size; )
+        {
+            u_int32_t header = 0;
+            memcpy (&header, loop, sizeof(int));
+            loop += sizeof(int);
+
+            u_int32_t readlen = header & ~INVALID_MASK_FLAG;
+            loop += (readlen+3)/4;
+
+            /** We skip the mask of the invalid nucleotides. */
+            if (header & INVALID_MASK_FLAG)
+            {
+                u_int32_t nbRuns = 0;
+                memcpy (&nbRuns, loop, sizeof(nbRuns));
+                loop += sizeof(nbRuns) + 2*nbRuns*sizeof(u_int32_t);
+            }
+
+            block.nbSequences   ++;
+            block.nbNucleotides += readlen;
+            block.maxLength      = std::max (block.maxLength, (u_int64_t)readlen);
+        }
+
+        _blocks.push_back (block);
+
+        offset += block_size;
+    }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -290,6 +587,61 @@ u_int64_t BankBinary::getSize ()
     return System::file().getSize (_filename);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t BankBinary::getNbBlocks ()
+{
+    load ();
+    return _blocks.size();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+int64_t BankBinary::getNbItems ()
+{
+    /** The number of sequences is known only once the file is written. */
+    if (binary_read_file != 0 || System::file().doesExist (_filename) == false)  { return -1; }
+
+    load ();
+    return _blocks.empty() ? 0 : _blocks.back().firstSequence + _blocks.back().nbSequences;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+tools::dp::Iterator<Sequence>* BankBinary::splitIterator (size_t nbParts)
+{
+    size_t nbBlocks = getNbBlocks();
+
+    if (nbParts > nbBlocks)  { nbParts = nbBlocks; }
+    if (nbParts <= 1)        { return iterator();  }
+
+    std::vector <tools::dp::Iterator<Sequence>*>  iterators;
+    for (size_t i=0; i<nbParts; i++)
+    {
+        iterators.push_back (new Iterator (*this, (nbBlocks*i)/nbParts, (nbBlocks*(i+1))/nbParts));
+    }
+
+    return new tools::dp::impl::CompositeIterator<Sequence> (iterators);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -317,6 +669,8 @@ void BankBinary::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& m
 *********************************************************************/
 void BankBinary::remove ()
 {
+    {  LocalSynchronizer sync (_synchro);  unload ();  }
+
     System::file().remove (_filename);
 }
 
@@ -333,6 +687,19 @@ void  BankBinary::setBufferSize (u_int64_t bufferSize)
     BINREADS_BUFFER = bufferSize;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t  BankBinary::getBufferSize ()
+{
+    return BINREADS_BUFFER;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -348,7 +715,7 @@ bool BankBinary::check (const std::string& uri)
     FILE* file = fopen (uri.c_str(), "rb");
     if (file != NULL)
     {
-        result = checkMagic (file);
+        result = checkMagic (file) > 0;
         fclose (file);
     }
 
@@ -365,9 +732,10 @@ bool BankBinary::check (const std::string& uri)
 *********************************************************************/
 BankBinary::Iterator::Iterator (BankBinary& ref)
     : _ref(ref), _isDone(true), _bufferData (0), cpt_buffer(0), blocksize_toread(0), nseq_lues(0),
-      binary_read_file(0),
+      _blockBegin(0), _blockEnd(~0), _block(0),
       _index(0)
 {
+    _ref.addIterator ();
 }
 
 /*********************************************************************
@@ -378,11 +746,27 @@ BankBinary::Iterator::Iterator (BankBinary& ref)
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-BankBinary::Iterator::~Iterator ()
+BankBinary::Iterator::Iterator (BankBinary& ref, size_t blockBegin, size_t blockEnd)
+    : _ref(ref), _isDone(true), _bufferData (0), cpt_buffer(0), blocksize_toread(0), nseq_lues(0),
+      _blockBegin(blockBegin), _blockEnd(blockEnd), _block(0),
+      _index(0)
 {
-    if (binary_read_file != 0)  {  fclose (binary_read_file);  }
+    _ref.addIterator ();
+}
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinary::Iterator::~Iterator ()
+{
     setBufferData(0);
+
+    _ref.removeIterator ();
 }
 
 /*********************************************************************
@@ -395,28 +779,16 @@ BankBinary::Iterator::~Iterator ()
 *********************************************************************/
 void BankBinary::Iterator::first()
 {
-    if (binary_read_file == 0)
-    {
-        /** We open the binary file at first call. */
-        binary_read_file = fopen (_ref._filename.c_str(), "rb");
-
-        /** We check that the file is opened => send an exception otherwise. */
-        if (binary_read_file == 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());  }
-    }
-
-    if (binary_read_file != 0)
-    {
-        rewind (binary_read_file);
-
-        /** We read the magic number. */
-        if (checkMagic(binary_read_file)==false)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());  }
-    }
+    /** We map the file at first call. */
+    _ref.load ();
 
     /** We reinitialize some attributes. */
     _isDone          = false;
     cpt_buffer       = 0;
     blocksize_toread = 0;
     nseq_lues        = 0;
+    _block           = _blockBegin;
+    _index           = _block < _ref._blocks.size() ? _ref._blocks[_block].firstSequence : 0;
 
     /** We go to the next sequence. */
     next();
@@ -433,27 +805,32 @@ void BankBinary::Iterator::first()
 void BankBinary::Iterator::next ()
 {
     int len = 0;
-    unsigned int block_size = 0;
 
     //////////////////////////////////////////////
-    //reading new block from disk if needed
+    //going to the next block if needed
     //////////////////////////////////////////////
-    if (cpt_buffer == blocksize_toread)
+    while (cpt_buffer == blocksize_toread)
     {
-        /** We read the size of the following cache buffer. */
-        if (! fread(&block_size,sizeof(unsigned int),1, binary_read_file)) //read block header
+        /** The index and the mapping may be replaced by a writer (see BankBinary::open), so we read
+         * them under the lock of the bank. The sequences of the block are then read without it: the
+         * mapping referred by the block data is kept until the last iterator is gone (see unload). */
+        LocalSynchronizer sync (_ref._synchro);
+
+        if (_block >= _blockEnd || _block >= _ref._blocks.size())
         {
             _isDone = true;
             return;
         }
 
-        /** We are about to read another chunk of data from the disk. We need */
-        setBufferData (new Data (block_size));
+        const Block& block = _ref._blocks[_block++];
 
-        fread (_bufferData->getBuffer(), sizeof( char),block_size, binary_read_file); // read a block of reads into the buffer
+        /** The block is referred directly in the mapped file. */
+        Data* data = new Data (Data::BINARY);
+        data->setRef (_ref._map + block.offset, block.size);
+        setBufferData (data);
 
         cpt_buffer       = 0;
-        blocksize_toread = block_size;
+        blocksize_toread = block.size;
     }
 
     //////////////////////////////////////////////
@@ -464,7 +841,9 @@ void BankBinary::Iterator::next ()
         /** We increase the number of read sequences so far. */
         nseq_lues ++;
 
-        memcpy (&len, _bufferData->getBuffer() + cpt_buffer, sizeof(int)); // read len
+        u_int32_t header = 0;
+        memcpy (&header, _bufferData->getBuffer() + cpt_buffer, sizeof(int)); // read len
+        len = header & ~INVALID_MASK_FLAG;
 
         /** We go ahead in the file parsing. */
         cpt_buffer += sizeof(int);
@@ -480,6 +859,23 @@ void BankBinary::Iterator::next ()
 
         /** We go ahead in the file parsing. */
         cpt_buffer += nchar;
+
+        /** We get the mask of the invalid nucleotides. */
+        Data::InvalidMask& mask = _item->getData().getInvalidMask();
+        if (header & INVALID_MASK_FLAG)
+        {
+            u_int32_t nbRuns = 0;
+            memcpy (&nbRuns, _bufferData->getBuffer() + cpt_buffer, sizeof(nbRuns));
+            cpt_buffer += sizeof(nbRuns);
+
+            mask.resize (2*nbRuns);
+            memcpy (mask.data(), _bufferData->getBuffer() + cpt_buffer, mask.size()*sizeof(u_int32_t));
+            cpt_buffer += mask.size()*sizeof(u_int32_t);
+        }
+        else
+        {
+            mask.clear();
+        }
     }
 }
 
@@ -489,7 +885,7 @@ void BankBinary::Iterator::next ()
 ** INPUT   :
 ** OUTPUT  :
 ** RETURN  :
-** REMARKS :
+** REMARKS : the index of the blocks gives the exact values.
 *********************************************************************/
 void  BankBinary::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
 {
@@ -498,66 +894,19 @@ void  BankBinary::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u
     totalSize = 0;
     maxSize   = 0;
 
-    /** We open the binary file at first call. */
-    FILE* file = fopen (_ref._filename.c_str(), "rb");
-    if (file != 0)
-    {
-        if (checkMagic(file)==false)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filename.c_str());  }
-
-        vector<char> buffer;
-
-        while (feof (file) == false)
-        {
-            unsigned int block_size = 0;
-
-            // we read the block header
-            if (! fread (&block_size,sizeof(unsigned int), 1, file))  { break; }
-
-            // we resize the buffer
-            buffer.resize (block_size);
+    /** Nothing to estimate if the file is not written yet. */
+    if (System::file().doesExist (_ref._filename) == false)  { return; }
 
-            // read a block of reads into the buffer
-            if (! fread (buffer.data(), sizeof(char), block_size, file))  { break; }
+    _ref.load ();
 
-            // we loop the sequences
-            char* loop = buffer.data();
-            while (loop < buffer.data() + block_size)
-            {
-                int readlen = 0;
-                memcpy (&readlen, loop, sizeof(int));
-
-                loop += sizeof(int) + (readlen+3)/4;
-
-                number ++;
-                if (readlen > (int)maxSize)  { maxSize = readlen; }
-                totalSize += readlen;
-            }
-
-            // we may count only a part of the file
-            if (number >= _ref.getEstimateThreshold())  { break; }
-        }
-
-        // we extrapolate the result according to the current location in the file
-        if (feof (file) == false)
-        {
-            // we keep the current location in the file
-            u_int64_t current = ftell (file);
-
-            // we go to the end of the file
-            fseeko (file, 0, SEEK_END);
-
-            // we keep the current location in the file
-            u_int64_t end = ftell (file);
-
-            // we extrapolate the result
-            number    = (number    * end) / current;
-            totalSize = (totalSize * end) / current;
-        }
-
-        // we clean up resources
-        fclose (file);
+    for (size_t i=_blockBegin; i<_blockEnd && i<_ref._blocks.size(); i++)
+    {
+        const Block& block = _ref._blocks[i];
 
-    }  /* end of if (file != 0) */
+        number    += block.nbSequences;
+        totalSize += block.nbNucleotides;
+        maxSize    = std::max (maxSize, block.maxLength);
+    }
 }
 
 /********************************************************************************/
@@ -29,6 +29,7 @@
 /********************************************************************************/
 
 #include <gatb/bank/impl/AbstractBank.hpp>
+#include <gatb/system/api/IThread.hpp>
 
 #include <vector>
 #include <string>
@@ -52,13 +53,29 @@ namespace impl      {
  *                  - a sequence is:
  *                      - a sequence length (on 4 bytes)
  *                      - the nucleotides of the sequences (4 nucleotides encoded in 1 byte)
- * - number of sequences (on 4 bytes)
+ *                      - if the highest bit of the length is set, the invalid nucleotides (like N):
+ *                        number of runs (on 4 bytes), then start and length of each run (on 4 bytes each)
+ *    - an index of the blocks (since version 2 of the format)
+ *        - for each block: offset of its sequences, size, number of sequences, number of
+ *          nucleotides and size of the longest sequence (each one on 8 bytes)
+ *        - number of blocks (on 8 bytes)
+ *        - the magic number
+ *
+ * Since a nucleotide is coded on 2 bits, the invalid ones (like N) are given by a mask attached to the
+ * data of the iterated sequences (see Data::getInvalidMask); the kmers models take this mask into
+ * account, so a binary bank provides the same valid kmers as the original bank.
  *
  * Historically, BinaryBank has been used in the first step of the DSK tool to convert
  * one input FASTA file into a binary format. DSK used to read several times the reads
  * so having a binary (and so compressed) format had the nice effect to have less I/O
  * operations and therefore less execution time.
  *
+ * The file is mapped in memory for reading. Thanks to the index, the blocks can be iterated
+ * separately (see getBlockIterator and splitIterator), for instance by different threads, and
+ * the estimate method gives exact values without reading the file. Files written with the first
+ * version of the format (without index) can still be read; their index is then built by reading
+ * the file once.
+ *
  * In the following example, we can see how to convert any kind of bank into a binary bank:
  * \snippet bank8.cpp  snippet8_binary
  *
@@ -88,8 +105,21 @@ public:
     /** \copydoc IBank::iterator */
     tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
 
+    /** \copydoc IBank::splitIterator
+     * The parts are made of consecutive blocks of the file. */
+    tools::dp::Iterator<Sequence>* splitIterator (size_t nbParts);
+
+    /** Get the number of blocks of the file.
+     * \return the number of blocks. */
+    size_t getNbBlocks ();
+
+    /** Create an iterator on one block of the file (heap allocation).
+     * \param[in] idx : index of the block
+     * \return the iterator. */
+    tools::dp::Iterator<Sequence>* getBlockIterator (size_t idx)  {  return new Iterator (*this, idx, idx+1);  }
+
     /** \copydoc IBank::getNbItems */
-    int64_t getNbItems () { return -1; }
+    int64_t getNbItems ();
 
     /** \copydoc IBank::insert */
     void insert (const Sequence& item);
@@ -111,6 +141,11 @@ public:
       */
     static void setBufferSize (u_int64_t bufferSize);
 
+    /** Get default buffer size (static method).
+      * \return the size of the buffer.
+      */
+    static u_int64_t getBufferSize ();
+
     /** Check that the given uri is a correct binary bank. */
     static bool check (const std::string& uri);
 
@@ -126,6 +161,13 @@ public:
          */
         Iterator (BankBinary& ref);
 
+        /** Constructor for a range of blocks.
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] blockBegin : index of the first block to be iterated
+         * \param[in] blockEnd : index of the block after the last one to be iterated
+         */
+        Iterator (BankBinary& ref, size_t blockBegin, size_t blockEnd);
+
         /** Destructor */
         virtual ~Iterator ();
 
@@ -156,7 +198,7 @@ public:
         /** Tells whether the iteration is finished or not. */
         bool _isDone;
 
-        /** Block buffer read from file. */
+        /** Block of the mapped file currently parsed. */
         tools::misc::Data* _bufferData;
         void setBufferData (tools::misc::Data* bufferData)  { SP_SETATTR(bufferData); }
 
@@ -164,7 +206,10 @@ public:
         int   blocksize_toread;
         int   nseq_lues;
 
-        FILE* binary_read_file;
+        /** Range of blocks to be iterated and next block to be parsed. */
+        size_t _blockBegin;
+        size_t _blockEnd;
+        size_t _block;
 
         size_t _index;
     };
@@ -182,7 +227,59 @@ protected:
     FILE*          binary_read_file;
 
     void open  (bool write);
-    void close ();
+
+    /** Entry of the index for one block. */
+    struct Block
+    {
+        u_int64_t offset;          // offset in the file of the first sequence of the block
+        u_int64_t size;            // size of the block (without its header)
+        u_int64_t nbSequences;     // number of sequences of the block
+        u_int64_t nbNucleotides;   // number of nucleotides of the block
+        u_int64_t maxLength;       // size of the longest sequence of the block
+        u_int64_t firstSequence;   // index of the first sequence of the block (not saved in the file)
+    };
+
+    /** Index of the blocks (being written, or read from the file). */
+    std::vector<Block> _blocks;
+
+    /** Statistics of the block being written. */
+    Block _currentBlock;
+
+    /** Invalid nucleotides of the sequence being written. */
+    std::vector<u_int32_t> _invalidRuns;
+
+    /** Write the current block into the file. */
+    void writeBlock ();
+
+    /** Memory mapping of the file. */
+    char*     _map;
+    u_int64_t _mapSize;
+
+    /** Mappings released while some iterators were alive; the sequences of these iterators may
+     * still refer them, so they are unmapped when the last iterator is destroyed. */
+    std::vector<std::pair<char*,u_int64_t> > _releasedMaps;
+
+    /** Number of living iterators. */
+    size_t _nbIterators;
+
+    /** Tells whether the file is mapped and its index read. */
+    bool _isLoaded;
+
+    /** Used for loading the file by the first iterator that needs it. */
+    system::ISynchronizer* _synchro;
+
+    /** Map the file in memory and read its index. An exception is thrown if the file is being written.
+     * Unloading while some iterators are alive keeps the mapping until the last iterator is destroyed;
+     * such an iterator ends with its current block. The caller of unload must hold the synchronizer. */
+    void load   ();
+    void unload ();
+
+    /** Called by the iterators at their creation and destruction. */
+    void addIterator    ();
+    void removeIterator ();
+
+    /** Build the index of a file of the first version of the format. */
+    void buildIndex ();
 };
 
 /********************************************************************************/
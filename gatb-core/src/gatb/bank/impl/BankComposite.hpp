@@ -30,9 +30,11 @@
 
 #include <gatb/bank/impl/AbstractBank.hpp>
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/designpattern/impl/ParallelCompositeIterator.hpp>
 
 #include <vector>
 #include <string>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb      {
@@ -52,6 +54,11 @@ namespace impl      {
  * Most of the methods of IBank are implemented by iterating the list of referred banks.
  *
  * A BankComposite can be created with a vector of IBank instances to be referred.
+ *
+ * By default, the referred banks are iterated one after the other by the iterating thread.
+ * With setNbReaders, several referred banks are parsed concurrently by reader threads
+ * (see ParallelCompositeIterator); the iterator still provides the referred banks one after
+ * the other, and its getComposition method provides the sequences of each one separately.
  */
 class BankComposite : public AbstractBank
 {
@@ -61,12 +68,12 @@ public:
     static const char* name()  { return "composite"; }
 
     /** Default constructor (no referred bank). */
-    BankComposite () : _nbItems(0), _size(0)  {}
+    BankComposite () : _nbItems(0), _size(0), _nbReaders(0)  {}
 
     /** Constructor.
      * \param[in] banks : list of banks to be associated to the album.
      */
-    BankComposite (const std::vector<IBank*>& banks) : _nbItems(0), _size(0)
+    BankComposite (const std::vector<IBank*>& banks) : _nbItems(0), _size(0), _nbReaders(0)
     {
         for (size_t i=0; i<banks.size(); i++)  {  this->addBank (banks[i]); }
     }
@@ -111,11 +118,57 @@ public:
     /** \copydoc IBank::iterator */
     tools::dp::Iterator<Sequence>* iterator ()
     {
+        if (_nbReaders > 1 && _banks.size() > 1)  {  return iteratorParallel (_nbReaders);  }
+
         std::vector <tools::dp::Iterator<Sequence>*>  iterators;
         for (size_t i=0; i<_banks.size(); i++)  { iterators.push_back (_banks[i]->iterator()); }
         return new tools::dp::impl::CompositeIterator<Sequence> (iterators);
     }
 
+    /** Create an iterator whose referred banks are parsed concurrently.
+     * \param[in] nbReaders : number of reader threads
+     * \return the iterator. */
+    tools::dp::impl::ParallelCompositeIterator<Sequence>* iteratorParallel (size_t nbReaders)
+    {
+        std::vector <tools::dp::Iterator<Sequence>*>  iterators;
+        for (size_t i=0; i<_banks.size(); i++)  { iterators.push_back (_banks[i]->iterator()); }
+        return new tools::dp::impl::ParallelCompositeIterator<Sequence> (iterators, nbReaders);
+    }
+
+    /** \copydoc IBank::splitIterator
+     * The parts are the parts of the referred banks, each one being split into nbParts/nbBanks parts. */
+    tools::dp::Iterator<Sequence>* splitIterator (size_t nbParts)
+    {
+        size_t nbPartsPerBank = std::max (nbParts / (_banks.size() > 0 ? _banks.size() : 1), (size_t)1);
+
+        std::vector <tools::dp::Iterator<Sequence>*>  banksIterators;
+        std::vector <tools::dp::Iterator<Sequence>*>  iterators;
+        for (size_t i=0; i<_banks.size(); i++)
+        {
+            tools::dp::Iterator<Sequence>* it = _banks[i]->splitIterator (nbPartsPerBank);
+            it->use ();
+            banksIterators.push_back (it);
+
+            std::vector <tools::dp::Iterator<Sequence>*> parts = it->getComposition();
+            iterators.insert (iterators.end(), parts.begin(), parts.end());
+        }
+
+        /** The composite iterator holds the parts, so we can release the iterators of the banks. */
+        tools::dp::Iterator<Sequence>* result = new tools::dp::impl::CompositeIterator<Sequence> (iterators);
+        for (size_t i=0; i<banksIterators.size(); i++)  { banksIterators[i]->forget(); }
+
+        return result;
+    }
+
+    /** Set the number of reader threads used by the iterator; 0 or 1 means that the referred banks
+     * are iterated one after the other by the iterating thread.
+     * \param[in] nbReaders : number of reader threads */
+    void setNbReaders (size_t nbReaders)  { _nbReaders = nbReaders; }
+
+    /** Get the number of reader threads used by the iterator.
+     * \return the number of reader threads. */
+    size_t getNbReaders () const  { return _nbReaders; }
+
     /** \copydoc IBank::getNbItems */
     int64_t getNbItems ()
     {
@@ -182,6 +235,7 @@ protected:
     u_int64_t _nbItems;
     u_int64_t _size;
     std::string _id;
+    size_t _nbReaders;
 };
 
 /********************************************************************************/
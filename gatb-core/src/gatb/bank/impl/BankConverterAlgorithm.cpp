@@ -198,8 +198,9 @@ IBank* BankConverterAlgorithm::createBank (
         nbInputSequences, outputName.c_str(), nbSeq
     ));
 
-    /** We create a new binary bank. */
-    IBank* result = new BankBinary (outputName, _kmerSize);
+    /** We create a new binary bank. The sequences are not split on invalid nucleotides: the binary bank keeps
+     * them in a mask, so it provides the same sequences and the same valid kmers as the input bank. */
+    IBank* result = new BankBinary (outputName);
 
     /** We need an iterator on the input bank. */
     Iterator<Sequence>* itBank = createIterator<Sequence> (
@@ -30,6 +30,10 @@
 #include <errno.h>
 #include <zlib.h> // Added by Pierre Peterlongo on 02/08/2012.
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 using namespace gatb::core::tools::dp;
 using namespace gatb::core::tools::dp::impl;
@@ -50,13 +54,735 @@ using namespace gatb::core::tools::misc;
 namespace gatb {  namespace core {  namespace bank {  namespace impl {
 /********************************************************************************/
 
-size_t BankFasta::_dataLineSize = 70;
+size_t BankFasta::_dataLineSize        = 70;
+size_t BankFasta::_nbDecompressThreads = 4;
+
+/********************************************************************************/
+/** Background decompression of a gzip file. The decompressed data is put into a bounded ring
+ * of blocks, filled by worker threads while the parser consumes the blocks in the file order.
+ *
+ * A usual gzip file can only be inflated sequentially, so it is read by a single worker with
+ * gzread. A BGZF file is a series of small gzip members whose compressed size is given in their
+ * header: the workers read the raw members of their block one after the other (under the input
+ * lock) and then inflate them in parallel.
+ */
+class Decompressor
+{
+public:
+
+    /** Constructor.
+     * \param[in] stream : handle on the file (used for usual gzip files)
+     * \param[in] filename : path of the file (used for BGZF files)
+     * \param[in] bgzf : tells whether the file is a BGZF file
+     * \param[in] nbThreads : number of decompression threads for a BGZF file */
+    Decompressor (gzFile stream, const char* filename, bool bgzf, size_t nbThreads);
+
+    /** Destructor. */
+    ~Decompressor ();
+
+    /** Get the next block of decompressed data; the previous block is given back to the ring.
+     * \param[out] data : the decompressed data
+     * \return size of the block, 0 at the end of the file. */
+    int next (unsigned char*& data);
+
+    /** Go back to the beginning of the file. */
+    void rewind ();
+
+    /** Get the number of decompressed bytes got through the 'next' method.
+     * \return the position in the decompressed file. */
+    u_int64_t tell () const  { return _position; }
+
+    /** Tells whether a file is a BGZF file, ie. its first gzip member has a 'BC' extra subfield.
+     * \param[in] filename : path of the file
+     * \return true if the file is a BGZF file. */
+    static bool isBGZF (const char* filename);
+
+private:
+
+    /** Location of a raw BGZF member in a slot. */
+    struct Member  {  size_t offset;  size_t size;  u_int32_t crc;  u_int32_t isize;  };
+
+    /** One block of the ring. */
+    struct Slot
+    {
+        Slot () : length(0), ready(false), last(false), error(false)  {}
+        std::vector<unsigned char> data;
+        std::vector<unsigned char> raw;
+        std::vector<Member>        members;
+        int  length;
+        bool ready;
+        bool last;
+        bool error;
+    };
+
+    gzFile       _stream;
+    std::string  _filename;
+    FILE*        _file;
+    bool         _bgzf;
+    size_t       _nbThreads;
+
+    std::vector<Slot>     _slots;
+    std::vector<IThread*> _threads;
+
+    /** Protects the state of the ring. */
+    ISynchronizer* _synchro;
+
+    /** Serializes the reads of the input file. */
+    ISynchronizer* _input;
+
+    u_int64_t _nbTaken;      // number of blocks taken by the workers
+    u_int64_t _nbConsumed;   // number of blocks given back by the parser
+    bool      _hasCurrent;   // tells whether the parser holds a block
+    bool      _eof;          // the end of the input has been reached by a worker
+    bool      _done;         // the end of the input has been reached by the parser
+    bool      _stop;
+    u_int64_t _position;
+
+    void start ();
+    void stop  ();
+
+    static void* mainloop (void* arg)  {  ((Decompressor*)arg)->work();  return 0;  }
+    void work ();
+
+    int  read       (Slot& slot);
+    int  readMember (Slot& slot, u_int32_t& isize);
+    bool inflate    (Slot& slot);
+};
+
+/** Little endian helpers for the BGZF headers. */
+static inline u_int32_t get_le16 (const unsigned char* p)  {  return p[0] | (p[1] << 8);  }
+static inline u_int32_t get_le32 (const unsigned char* p)  {  return get_le16(p) | (get_le16(p+2) << 16);  }
+
+/** Maximum size of the decompressed data of a BGZF member. */
+#define BGZF_MAX_BLOCK_SIZE  (64*1024)
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : read the header of a BGZF member
+** INPUT   : file located at the beginning of a member
+** OUTPUT  : remaining : number of bytes of the member after its header (compressed data, crc and size)
+** RETURN  : 1 if a header has been read, 0 at the end of the file, -1 if the header is not a BGZF one
+** REMARKS : see the SAM/BAM specification for the BGZF format
+*********************************************************************/
+static int bgzf_read_header (FILE* file, size_t& remaining)
+{
+    unsigned char header[12];
+
+    size_t nb = fread (header, 1, sizeof(header), file);
+    if (nb == 0)  { return 0; }
+
+    if (nb < sizeof(header) || header[0] != 31 || header[1] != 139 || header[2] != 8 || (header[3] & 4) == 0)  { return -1; }
+
+    /** We look for the 'BC' subfield that gives the size of the member; the other subfields are skipped. */
+    size_t xlen  = get_le16 (header+10);
+    size_t bsize = 0;
+    size_t i     = 0;
+    unsigned char sub[6];
+
+    while (i+4 <= xlen)
+    {
+        if (fread (sub, 1, 4, file) != 4)  { return -1; }
+
+        size_t slen = get_le16 (sub+2);
+        if (i + 4 + slen > xlen)  { return -1; }
+
+        if (sub[0]=='B' && sub[1]=='C' && slen==2)
+        {
+            if (fread (sub+4, 1, 2, file) != 2)  { return -1; }
+            bsize = get_le16 (sub+4) + 1;
+        }
+        else if (slen > 0 && fseek (file, slen, SEEK_CUR) != 0)  { return -1; }
+
+        i += 4 + slen;
+    }
+    if (i < xlen && fseek (file, xlen - i, SEEK_CUR) != 0)  { return -1; }
+
+    /** The member holds the header, the extra field, the compressed data, the crc and the size. */
+    if (bsize < sizeof(header) + xlen + 8)  { return -1; }
+    remaining = bsize - sizeof(header) - xlen;
+
+    return 1;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+Decompressor::Decompressor (gzFile stream, const char* filename, bool bgzf, size_t nbThreads)
+    : _stream(stream), _filename(filename), _file(0), _bgzf(bgzf), _nbThreads(bgzf ? nbThreads : 1),
+      _synchro(0), _input(0), _nbTaken(0), _nbConsumed(0), _hasCurrent(false), _eof(false), _done(false), _stop(false), _position(0)
+{
+    if (_nbThreads == 0)  { _nbThreads = 1; }
+
+    /** A BGZF file is read without zlib buffering, the workers inflate the members themselves. */
+    if (_bgzf)
+    {
+        _file = fopen (filename, "rb");
+        if (_file == 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, filename);  }
+    }
+
+    /** Each worker may hold one block while the parser holds another one. */
+    _slots.resize (_bgzf ? 2*_nbThreads+2 : 4);
+
+    _synchro = System::thread().newSynchronizer();
+    _input   = System::thread().newSynchronizer();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+Decompressor::~Decompressor ()
+{
+    stop ();
+
+    if (_file != 0)  { fclose (_file); }
+
+    delete _synchro;
+    delete _input;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the threads are launched at the first call, so an iterator that
+**           is not used doesn't cost anything.
+*********************************************************************/
+int Decompressor::next (unsigned char*& data)
+{
+    if (_done)  { return 0; }
+
+    if (_threads.empty())  { start (); }
+
+    while (true)
+    {
+        _synchro->lock ();
+
+        /** We give back the current block. */
+        if (_hasCurrent)
+        {
+            _slots[_nbConsumed++ % _slots.size()].ready = false;
+            _hasCurrent = false;
+            _synchro->notify ();
+        }
+
+        /** We wait for the next block. */
+        Slot& slot = _slots[_nbConsumed % _slots.size()];
+        while (slot.ready == false)  { _synchro->wait (); }
+        _hasCurrent = true;
+
+        _synchro->unlock ();
+
+        if (slot.error)  {  throw gatb::core::system::Exception (_bgzf ? STR_BANK_bad_bgzf_block : STR_BANK_bad_gzip_file, _filename.c_str());  }
+
+        /** The threads are not needed anymore at the end of the file. */
+        if (slot.last)  {  stop ();  _done = true;  return 0;  }
+
+        /** A BGZF block may be empty (end of file marker of a concatenated file for instance). */
+        if (slot.length > 0)
+        {
+            data       = &slot.data[0];
+            _position += slot.length;
+            return slot.length;
+        }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void Decompressor::rewind ()
+{
+    stop ();
+
+    if (_bgzf)  { fseek (_file, 0, SEEK_SET); }
+    else        { gzrewind (_stream);         }
+
+    _done     = false;
+    _position = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void Decompressor::start ()
+{
+    for (size_t i=0; i<_slots.size(); i++)
+    {
+        _slots[i].data.resize (BUFFER_SIZE);
+        _slots[i].ready = _slots[i].last = _slots[i].error = false;
+    }
+
+    _nbTaken    = _nbConsumed = 0;
+    _hasCurrent = _eof = _stop = false;
+
+    for (size_t i=0; i<_nbThreads; i++)  {  _threads.push_back (System::thread().newThread (mainloop, this));  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void Decompressor::stop ()
+{
+    if (_threads.empty())  { return; }
+
+    _synchro->lock ();
+    _stop = true;
+    _synchro->notify ();
+    _synchro->unlock ();
+
+    for (size_t i=0; i<_threads.size(); i++)  {  _threads[i]->join ();  delete _threads[i];  }
+    _threads.clear ();
+
+    /** We release the memory of the ring. */
+    for (size_t i=0; i<_slots.size(); i++)
+    {
+        std::vector<unsigned char>().swap (_slots[i].data);
+        std::vector<unsigned char>().swap (_slots[i].raw);
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the blocks are taken in the file order under the input lock; the BGZF
+**           members are inflated outside any lock.
+*********************************************************************/
+void Decompressor::work ()
+{
+    while (true)
+    {
+        _input->lock ();
+        _synchro->lock ();
+
+        /** We wait for a free block in the ring. */
+        while (!_stop && !_eof && _nbTaken - _nbConsumed >= _slots.size())  { _synchro->wait (); }
+
+        if (_stop || _eof)  {  _synchro->unlock ();  _input->unlock ();  break;  }
+
+        Slot& slot = _slots[_nbTaken++ % _slots.size()];
+
+        _synchro->unlock ();
+
+        int length = read (slot);
+
+        bool last = length <= 0 && slot.error == false;
+        if (last || slot.error)  {  _synchro->lock ();  _eof = true;  _synchro->unlock ();  }
+
+        _input->unlock ();
+
+        if (_bgzf && length > 0 && inflate (slot) == false)  {  slot.error = true;  }
+
+        _synchro->lock ();
+        slot.length = (length > 0 ? length : 0);
+        slot.last   = last;
+        slot.ready  = true;
+        _synchro->notify ();
+        _synchro->unlock ();
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  : the size of the decompressed data of the block
+** REMARKS :
+*********************************************************************/
+int Decompressor::read (Slot& slot)
+{
+    slot.error = false;
+
+    /** A usual gzip file is simply decompressed here. */
+    if (_bgzf == false)
+    {
+        int length = gzread (_stream, &slot.data[0], BUFFER_SIZE);
+
+        /** A truncated file is seen as an end of file by gzread, only gzerror tells it. */
+        int errnum = Z_OK;
+        if (length <= 0)  {  gzerror (_stream, &errnum);  }
+
+        if (length < 0 || errnum != Z_OK)  {  slot.error = true;  return 0;  }
+
+        return length;
+    }
+
+    /** We read as many raw members as the block can hold once inflated. */
+    slot.raw.clear ();
+    slot.members.clear ();
+
+    int length = 0;
+    u_int32_t isize = 0;
+
+    while (length + BGZF_MAX_BLOCK_SIZE <= BUFFER_SIZE)
+    {
+        int res = readMember (slot, isize);
+
+        if (res <  0)  {  slot.error = true;  return 0;  }
+        if (res == 0)  {  break;  }
+
+        length += isize;
+    }
+
+    /** The end of the file is reached when no member has been read (even an empty one). */
+    return slot.members.empty() ? 0 : (length > 0 ? length : -1);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  : 1 if a member has been read, 0 at the end of the file, -1 if the member is corrupted
+** REMARKS : see the SAM/BAM specification for the BGZF format
+*********************************************************************/
+int Decompressor::readMember (Slot& slot, u_int32_t& isize)
+{
+    size_t remaining = 0;
+
+    int res = bgzf_read_header (_file, remaining);
+    if (res <= 0)  { return res; }
+
+    size_t offset = slot.raw.size();
+    slot.raw.resize (offset + remaining);
+    if (fread (&slot.raw[offset], 1, remaining, _file) != remaining)  { return -1; }
+
+    Member member;
+    member.offset = offset;
+    member.size   = remaining - 8;
+    member.crc    = get_le32 (&slot.raw[offset + remaining - 8]);
+    member.isize  = get_le32 (&slot.raw[offset + remaining - 4]);
+
+    if (member.isize > BGZF_MAX_BLOCK_SIZE)  { return -1; }
+
+    slot.members.push_back (member);
+    isize = member.isize;
+
+    return 1;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  : false if a member can't be inflated or doesn't match its crc
+** REMARKS :
+*********************************************************************/
+bool Decompressor::inflate (Slot& slot)
+{
+    z_stream zs;
+    memset (&zs, 0, sizeof(zs));
+
+    /** Raw deflate data (no zlib/gzip header). */
+    if (inflateInit2 (&zs, -15) != Z_OK)  { return false; }
+
+    bool   result = true;
+    size_t length = 0;
+
+    for (size_t i=0; result && i<slot.members.size(); i++)
+    {
+        Member& member = slot.members[i];
+
+        inflateReset (&zs);
+
+        zs.next_in   = &slot.raw[member.offset];
+        zs.avail_in  = member.size;
+        zs.next_out  = &slot.data[length];
+        zs.avail_out = slot.data.size() - length;
+
+        result = ::inflate (&zs, Z_FINISH) == Z_STREAM_END
+            &&   zs.total_out == member.isize
+            &&   crc32 (0, &slot.data[length], member.isize) == member.crc;
+
+        length += member.isize;
+    }
+
+    inflateEnd (&zs);
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool Decompressor::isBGZF (const char* filename)
+{
+    bool result = false;
+
+    if (FILE* file = fopen (filename, "rb"))
+    {
+        unsigned char header[18];
+
+        /** Header of a gzip member with an extra field of 6 bytes holding the 'BC' subfield. */
+        result = fread (header, 1, sizeof(header), file) == sizeof(header)
+            &&   header[0] == 31 && header[1] == 139 && header[2] == 8 && (header[3] & 4) != 0
+            &&   get_le16 (header+10) == 6
+            &&   header[12] == 'B' && header[13] == 'C' && get_le16 (header+14) == 2;
+
+        fclose (file);
+    }
+
+    return result;
+}
+
+/** Number of decompressed bytes used for estimating the compression ratio of a gzip file. */
+#define GZ_SAMPLE_SIZE  (1024*1024)
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : compute the size of the decompressed data of a BGZF file
+** INPUT   : filename : path of the BGZF file
+** OUTPUT  : size : the decompressed size
+** RETURN  : false if the file is not a valid BGZF file
+** REMARKS : the members are skipped with the size given in their header. If the bgzip
+**           index (.gzi file) is available, only the members after the last indexed
+**           one are read.
+*********************************************************************/
+static bool bgzf_get_size (const char* filename, u_int64_t& size)
+{
+    FILE* file = fopen (filename, "rb");
+    if (file == 0)  { return false; }
+
+    u_int64_t offset = 0;
+    size = 0;
+
+    /** The index holds the number of entries, then (compressed offset, uncompressed offset) for each member but the first. */
+    string indexname = string(filename) + ".gzi";
+    if (FILE* index = fopen (indexname.c_str(), "rb"))
+    {
+        unsigned char buffer[16];
+        if (fread (buffer, 1, 8, index) == 8)
+        {
+            u_int64_t nb = get_le32 (buffer) | ((u_int64_t)get_le32 (buffer+4) << 32);
+
+            if (nb > 0  &&  fseeko (index, 8 + 16*(nb-1), SEEK_SET) == 0  &&  fread (buffer, 1, 16, index) == 16)
+            {
+                offset = get_le32 (buffer)   | ((u_int64_t)get_le32 (buffer+4)  << 32);
+                size   = get_le32 (buffer+8) | ((u_int64_t)get_le32 (buffer+12) << 32);
+            }
+        }
+        fclose (index);
+    }
+
+    bool result = fseeko (file, offset, SEEK_SET) == 0;
+
+    /** The decompressed size of a member is given by its last 4 bytes. */
+    size_t        remaining = 0;
+    unsigned char isize[4];
+    int           res       = 0;
+
+    while (result  &&  (res = bgzf_read_header (file, remaining)) > 0)
+    {
+        result = fseeko (file, remaining - 4, SEEK_CUR) == 0  &&  fread (isize, 1, 4, file) == 4;
+        size  += get_le32 (isize);
+    }
+
+    fclose (file);
+
+    return result && res == 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : estimate the size of the decompressed data of a file
+** INPUT   : filename : path of the file
+** OUTPUT  :
+** RETURN  : the estimated size, ie. the file size for an uncompressed file
+** REMARKS : the size of a usual gzip file is extrapolated from the compression ratio of
+**           its first bytes. The gzip trailer (ISIZE) gives the exact size modulo 2^32,
+**           but only for the last member of the file; we use it when it is consistent
+**           with the extrapolation.
+*********************************************************************/
+static u_int64_t get_uncompressed_size (const char* filename)
+{
+    u_int64_t fileSize = System::file().getSize (filename);
+
+    FILE* file = fopen (filename, "rb");
+    if (file == 0)  { return fileSize; }
+
+    unsigned char header[2] = { 0, 0 };
+    bool isGzip = fread (header, 1, 2, file) == 2  &&  header[0] == 31  &&  header[1] == 139;
+
+    unsigned char trailer[4] = { 0, 0, 0, 0 };
+    if (isGzip  &&  fseeko (file, -4, SEEK_END) == 0)  {  isGzip = fread (trailer, 1, 4, file) == 4;  }
+
+    fclose (file);
+
+    if (isGzip == false)  { return fileSize; }
+
+    /** A BGZF file gives the exact size of each member. */
+    u_int64_t size = 0;
+    if (Decompressor::isBGZF (filename)  &&  bgzf_get_size (filename, size))  { return size; }
+
+    /** We decompress the beginning of the file. */
+    gzFile stream = gzopen (filename, "r");
+    if (stream == 0)  { return fileSize; }
+
+    vector<char> sample (GZ_SAMPLE_SIZE);
+    int     nbOut = gzread   (stream, &sample[0], sample.size());
+    z_off_t nbIn  = gzoffset (stream);
+
+    gzclose (stream);
+
+    if (nbOut < 0  ||  nbIn <= 0)  { return fileSize; }
+
+    /** The whole file has been decompressed. */
+    if (nbOut < (int)sample.size())  { return nbOut; }
+
+    u_int64_t extrapolated = (u_int64_t) ((double)fileSize * nbOut / nbIn);
+
+    /** We look for the size having the ISIZE value modulo 2^32 that is the closest to the extrapolation. */
+    u_int64_t isize = get_le32 (trailer);
+    u_int64_t wraps = extrapolated > isize ? (extrapolated - isize + ((u_int64_t)1 << 31)) >> 32 : 0;
+    u_int64_t exact = isize + (wraps << 32);
+
+    /** The compression ratio of a sequences file is rather uniform, so a large difference means
+     * that the file has several members (concatenated gzip files for instance). */
+    return (4*exact >= 3*extrapolated  &&  3*exact <= 4*extrapolated) ? exact : extrapolated;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : read one line of a file
+** INPUT   : file : the file
+** OUTPUT  : line : the line content, without the end of line characters
+** RETURN  : false at the end of the file
+** REMARKS :
+*********************************************************************/
+static bool read_line (FILE* file, string& line)
+{
+    line.clear ();
+
+    char buffer[4096];
+    while (fgets (buffer, sizeof(buffer), file) != 0)
+    {
+        line += buffer;
+        if (line[line.size()-1] == '\n')  { break; }
+    }
+
+    if (line.empty())  { return false; }
+
+    while (!line.empty() && (line[line.size()-1] == '\n' || line[line.size()-1] == '\r'))  {  line.resize (line.size()-1);  }
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : check that a FASTQ record starts at the current position of a file
+** INPUT   : file : the file, positioned just after a line starting with '@'
+** OUTPUT  :
+** RETURN  : true if the following lines are the end of a FASTQ record
+** REMARKS : a quality line may start with '@' (and '+'), so we check the structure of the
+**           whole record, as read by the parser: sequence lines until a '+' line, then quality
+**           lines until the quality is as long as the sequence, then a header or the end of file.
+*********************************************************************/
+static bool fastq_check_record (FILE* file)
+{
+    string line;
+
+    size_t seqLength = 0;
+    for (;;)
+    {
+        if (read_line (file, line) == false)  { return false; }
+        if (line.empty())                     { continue; }
+        if (line[0] == '+')                   { break; }
+        if (line[0] == '@' || line[0] == '>') { return false; }
+        seqLength += line.size();
+    }
+
+    size_t qualLength = 0;
+    do
+    {
+        if (read_line (file, line) == false)  { return false; }
+        qualLength += line.size();
+    }
+    while (qualLength < seqLength);
+
+    if (qualLength != seqLength)  { return false; }
+
+    return read_line (file, line) == false  ||  (!line.empty() && line[0] == '@');
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : look for the first record starting at or after some offset of a FASTA/FASTQ file
+** INPUT   : file : the uncompressed file
+**           offset : offset of the search start
+**           fastq : tells whether the file is a FASTQ file
+**           fileSize : size of the file
+** OUTPUT  :
+** RETURN  : the offset of the record start, fileSize if there is no record after the offset
+** REMARKS : a record starts with a line beginning with '>' (FASTA) or '@' (FASTQ)
+*********************************************************************/
+static u_int64_t fasta_resync (FILE* file, u_int64_t offset, bool fastq, u_int64_t fileSize)
+{
+    if (offset == 0)  { return 0; }
+
+    /** We go to the start of the first line after offset-1, ie. the first line starting at or after offset. */
+    string line;
+    if (fseeko (file, offset-1, SEEK_SET) != 0  ||  read_line (file, line) == false)  { return fileSize; }
+
+    for (;;)
+    {
+        u_int64_t start = ftello (file);
+
+        if (read_line (file, line) == false)  { return fileSize; }
+
+        if (fastq == false  &&  !line.empty() && line[0] == '>')  { return start; }
+
+        if (fastq == true  &&  !line.empty() && line[0] == '@')
+        {
+            if (fastq_check_record (file))  { return start; }
+
+            /** Not a header: we go on after this line. */
+            fseeko (file, start, SEEK_SET);
+            read_line (file, line);
+        }
+    }
+}
 
 /********************************************************************************/
 // heavily inspired by kseq.h from Heng Li (https://github.com/attractivechaos/klib)
 typedef struct
 {
     gzFile stream;
+    Decompressor* decompressor;  // background decompression (0 if the file is decompressed by the parser)
     unsigned char *buffer;
     int buffer_start, buffer_end;
     bool eof;
@@ -64,13 +790,29 @@ typedef struct
 
     void rewind ()
     {
-        gzrewind (stream);
+        if (decompressor != 0)  {  decompressor->rewind ();  }
+        else                    {  gzrewind (stream);        }
         last_char    = 0;
         eof          = 0;
         buffer_start = 0;
         buffer_end   = 0;
     }
 
+    /** Go to some offset of an uncompressed file. Note that zlib seeks directly in the file only when
+     * it knows that the file is not compressed (otherwise it reads up to the offset), hence the gzdirect call. */
+    void seek (u_int64_t offset)
+    {
+        rewind ();
+        gzdirect (stream);
+        gzseek (stream, offset, SEEK_SET);
+    }
+
+    /** Position in the decompressed file of the parsed data. */
+    u_int64_t tell ()  {  return decompressor != 0 ? decompressor->tell() : gztell (stream);  }
+
+    /** Position in an uncompressed file of the next character to be parsed. */
+    u_int64_t position ()  {  return gztell (stream) - (buffer_end - buffer_start);  }
+
 } buffered_file_t;
 
 /********************************************************************************/
@@ -86,7 +828,7 @@ struct variable_string_t
 /********************************************************************************/
 struct buffered_strings_t
 {
-     buffered_strings_t () : read(new variable_string_t), dummy(new variable_string_t), header(new variable_string_t), quality(new variable_string_t)   {}
+     buffered_strings_t () : read(new variable_string_t), dummy(new variable_string_t), header(new variable_string_t), quality(new variable_string_t), fastq(false)   {}
     ~buffered_strings_t ()
     {
         delete read;
@@ -96,6 +838,9 @@ struct buffered_strings_t
     }
 
     variable_string_t *read, *dummy, *header, *quality;
+
+    /** Tells whether the last parsed sequence has a quality (fastq). */
+    bool fastq;
 };
 
 /*********************************************************************
@@ -107,7 +852,7 @@ struct buffered_strings_t
 ** REMARKS :
 *********************************************************************/
 BankFasta::BankFasta (const std::string& filename, bool output_fastq, bool output_gz)
-    : filesizes(0), nb_files(0), _insertHandle(0), _gz_insertHandle(0)
+    : filesizes(0), filesizesKnown(false), nb_files(0), _insertHandle(0), _gz_insertHandle(0)
 {
     _output_fastq = output_fastq;
     _output_gz= output_gz;
@@ -160,31 +905,32 @@ void BankFasta::init ()
         throw gatb::core::system::Exception (STR_BANK_bad_file_number, _filenames.size(), getMaxNbFiles());
     }
 
-    nb_files  = _filenames.size();
-    filesizes = 0;
+    nb_files = _filenames.size();
 
-    // estimate total size of files
-    for (size_t i=0; i<nb_files; i++)
-    {
-        /** Shortcut. */
-        const char* fname = _filenames[i].c_str();
-
-        bool compressed = false;
-        u_int64_t estimated_filesize;
-
-        if (strstr (fname, "gz") == (fname + strlen (fname) - 2))
-            compressed = true;
-
-        if (compressed)
-            // crude hack, based on Quip paper reporting compression ratio (~0.3).
-            // gzseek(SEEK_END) isn't supported. need to read whole file otherwise :/
+    /** The files sizes are computed at the first call to getSize. */
+    filesizes      = 0;
+    filesizesKnown = false;
+}
 
-            estimated_filesize = System::file().getSize (fname) * 4;
-        else
-            estimated_filesize = System::file().getSize (fname);
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the size of a compressed file is the estimated size of its decompressed data.
+*********************************************************************/
+u_int64_t BankFasta::getSize ()
+{
+    if (filesizesKnown == false)
+    {
+        filesizes = 0;
+        for (size_t i=0; i<nb_files; i++)  {  filesizes += get_uncompressed_size (_filenames[i].c_str());  }
 
-        filesizes += estimated_filesize;
+        filesizesKnown = true;
     }
+
+    return filesizes;
 }
 
 /*********************************************************************
@@ -204,6 +950,52 @@ void BankFasta::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& ma
     it.estimate (number, totalSize, maxSize);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the bounds of the ranges are computed here, so the parts only have to check
+**           the start offset of their sequences.
+*********************************************************************/
+tools::dp::Iterator<Sequence>* BankFasta::splitIterator (size_t nbParts)
+{
+    const char* filename = _filenames[0].c_str();
+
+    /** A compressed file can't be split. */
+    bool isDirect = false;
+    if (gzFile stream = gzopen (filename, "r"))  {  isDirect = gzdirect (stream) != 0;  gzclose (stream);  }
+
+    if (nbParts <= 1 || isDirect == false)  {  return iterator ();  }
+
+    FILE* file = fopen (filename, "rb");
+    if (file == 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, filename);  }
+
+    u_int64_t fileSize = System::file().getSize (filename);
+
+    /** We look at the first record for knowing the format (as the parser, we look for the first header character). */
+    int c;
+    while ((c = fgetc (file)) != EOF  &&  c != '>'  &&  c != '@')  {}
+    bool fastq = c == '@';
+
+    /** We compute the bounds of the parts; a part may be empty if a sequence overlaps several ranges. */
+    vector<u_int64_t> bounds;
+    for (size_t i=0; i<nbParts; i++)
+    {
+        u_int64_t bound = fasta_resync (file, (fileSize * i) / nbParts, fastq, fileSize);
+        if (bounds.empty() || (bound > bounds.back() && bound < fileSize))  {  bounds.push_back (bound);  }
+    }
+    bounds.push_back (~(u_int64_t)0);
+
+    fclose (file);
+
+    vector<tools::dp::Iterator<Sequence>*> iterators;
+    for (size_t i=0; i+1<bounds.size(); i++)  {  iterators.push_back (new Iterator (*this, bounds[i], bounds[i+1]));  }
+
+    return new tools::dp::impl::CompositeIterator<Sequence> (iterators);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -300,17 +1092,38 @@ void BankFasta::insert (const Sequence& item)
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-BankFasta::Iterator::Iterator (BankFasta& ref, CommentMode_e commentMode)
-    : _ref(ref), _commentsMode(commentMode), _isDone(true), _isInitialized(false), _nIters(0),
+BankFasta::Iterator::Iterator (BankFasta& ref, CommentMode_e commentMode, DataMode_e dataMode)
+    : _ref(ref), _commentsMode(commentMode), _isDone(true), _isInitialized(false), _nIters(0), _begin(0), _end(~(u_int64_t)0),
       index_file(0), buffered_file(0), buffered_strings(0), _index(0)
 {
     DEBUG (("Bank::Iterator::Iterator\n"));
 
+    /** In REFERENCE mode, the iterated item is our own lazy sequence. */
+    if (dataMode == REFERENCE)  {  setItem (_lazyItem);  }
+
     /** We check that the file can be opened. */
     if (gzFile stream = gzopen (_ref._filenames[0].c_str(), "r"))  {  gzclose (stream);  }
     else  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filenames[0].c_str());  }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankFasta::Iterator::Iterator (BankFasta& ref, u_int64_t begin, u_int64_t end, CommentMode_e commentMode, DataMode_e dataMode)
+    : _ref(ref), _commentsMode(commentMode), _isDone(true), _isInitialized(false), _nIters(0), _begin(begin), _end(end),
+      index_file(0), buffered_file(0), buffered_strings(0), _index(0)
+{
+    DEBUG (("Bank::Iterator::Iterator  [%lld,%lld]\n", begin, end));
+
+    /** In REFERENCE mode, the iterated item is our own lazy sequence. */
+    if (dataMode == REFERENCE)  {  setItem (_lazyItem);  }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -344,6 +1157,9 @@ void BankFasta::Iterator::first()
         if (bf != 0)  { bf->rewind(); }
     }
 
+    /** We may iterate only a range of the file. */
+    if (_begin > 0)  {  ((buffered_file_t *) buffered_file[0])->seek (_begin);  }
+
     index_file = 0;
     _isDone = false;
     
@@ -365,7 +1181,26 @@ void BankFasta::Iterator::next()
 {
     if (_isDone)  { return; }
 
-    if (_commentsMode == NONE)
+    if (_item == &_lazyItem)
+    {
+        /** No copy: the item refers to the buffers of the parser. */
+        _isDone = read_next_seq (_commentsMode) == false;
+
+        if (!_isDone)
+        {
+            buffered_strings_t* bs = (buffered_strings_t*) buffered_strings;
+
+            /** As in COPY mode, there is no comment nor quality in NONE mode. */
+            bool none = _commentsMode == NONE;
+
+            _lazyItem.set (
+                bs->read->string, bs->read->length,
+                (none ? 0 : bs->header->string),   (none ? 0 : bs->header->length),
+                (none ? 0 : bs->quality->string),  (none || !bs->fastq ? 0 : bs->quality->length)
+            );
+        }
+    }
+    else if (_commentsMode == NONE)
     {
         _isDone = get_next_seq (_item->getData()) == false;
     }
@@ -390,12 +1225,89 @@ inline bool rebuffer (buffered_file_t *bf)
 {
     if (bf->eof) return false;
     bf->buffer_start = 0;
+    if (bf->decompressor != 0)
+    {
+        /** The data comes from the ring of the background decompression. */
+        bf->buffer_end = bf->decompressor->next (bf->buffer);
+        if (bf->buffer_end == 0)  {  bf->eof = 1;  return false;  }
+        return true;
+    }
     bf->buffer_end = gzread (bf->stream, bf->buffer, BUFFER_SIZE);
+    if (bf->buffer_end < BUFFER_SIZE)
+    {
+        /** A truncated file is seen as an end of file by gzread, only gzerror tells it (its message holds the file name). */
+        int errnum = Z_OK;
+        const char* msg = gzerror (bf->stream, &errnum);
+        if (bf->buffer_end < 0 || errnum != Z_OK)  {  throw gatb::core::system::Exception (STR_BANK_bad_gzip_file, msg);  }
+    }
     if (bf->buffer_end < BUFFER_SIZE) bf->eof = 1;
     if (bf->buffer_end == 0) return false;
     return true;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : look for the first character that is either c1 or c2
+** INPUT   :
+** OUTPUT  :
+** RETURN  : the index of the found character, 'len' if not found
+** REMARKS : 16 bytes are compared at once with SSE2 when available
+*********************************************************************/
+inline size_t scan_chars (const unsigned char* buffer, size_t len, unsigned char c1, unsigned char c2)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i v1 = _mm_set1_epi8 ((char)c1);
+    const __m128i v2 = _mm_set1_epi8 ((char)c2);
+
+    for ( ; i+16 <= len; i+=16)
+    {
+        __m128i block = _mm_loadu_si128 ((const __m128i*) (buffer+i));
+        int mask = _mm_movemask_epi8 (_mm_or_si128 (_mm_cmpeq_epi8 (block, v1), _mm_cmpeq_epi8 (block, v2)));
+        if (mask != 0)  { return i + __builtin_ctz (mask); }
+    }
+#endif
+
+    for ( ; i<len; i++)  {  if (buffer[i]==c1 || buffer[i]==c2)  { return i; }  }
+
+    return len;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : look for the first space character (as isspace in the C locale)
+** INPUT   :
+** OUTPUT  :
+** RETURN  : the index of the found character, 'len' if not found
+** REMARKS : isspace() answers yes for ' ', \t, \n, \v, \f, \r ; 16 bytes are checked
+**           at once with SSE2 when available
+*********************************************************************/
+inline size_t scan_space (const unsigned char* buffer, size_t len)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    /** A space is ' ' or a character in [\t,\r], ie. c-9 <= 4 as an unsigned value. */
+    const __m128i space = _mm_set1_epi8 (' ');
+    const __m128i tab   = _mm_set1_epi8 ('\t');
+    const __m128i range = _mm_set1_epi8 ('\r' - '\t');
+
+    for ( ; i+16 <= len; i+=16)
+    {
+        __m128i block   = _mm_loadu_si128 ((const __m128i*) (buffer+i));
+        __m128i shifted = _mm_sub_epi8 (block, tab);
+        __m128i inRange = _mm_cmpeq_epi8 (_mm_min_epu8 (shifted, range), shifted);
+        int mask = _mm_movemask_epi8 (_mm_or_si128 (_mm_cmpeq_epi8 (block, space), inRange));
+        if (mask != 0)  { return i + __builtin_ctz (mask); }
+    }
+#endif
+
+    for ( ; i<len; i++)  {  if (isspace (buffer[i]))  { return i; }  }
+
+    return len;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -435,14 +1347,12 @@ inline signed int buffered_gets (
         if (bf->buffer_start >= bf->buffer_end) if (!rebuffer (bf)) break;
         if (allow_spaces)
         {
-            for (i = bf->buffer_start; i < bf->buffer_end; i++)
-                if (bf->buffer[i] == '\n') break;
+            const unsigned char* eol = (const unsigned char*) memchr (bf->buffer + bf->buffer_start, '\n', bf->buffer_end - bf->buffer_start);
+            i = (eol != 0) ? (eol - bf->buffer) : bf->buffer_end;
         }
         else
         {
-            for (i = bf->buffer_start; i < bf->buffer_end; i++)
-                // isspace() answers yes for ' ', \t, \n, \v, \f, \r
-                if (isspace (bf->buffer[i])) break;
+            i = bf->buffer_start + scan_space (bf->buffer + bf->buffer_start, bf->buffer_end - bf->buffer_start);
         }
         if (s->max - s->length < (i - bf->buffer_start + 1))
         {
@@ -479,9 +1389,8 @@ inline signed int buffered_gets (
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, string& comment, string& quality, int file_id, CommentMode_e mode)
+bool BankFasta::Iterator::read_next_seq_from_file (int file_id, CommentMode_e mode)
 {
-    
     buffered_strings_t* bs = (buffered_strings_t*) buffered_strings;
    // printf("%i -\n",bs->header->length);
 
@@ -489,12 +1398,24 @@ bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, string& co
     buffered_file_t *bf = (buffered_file_t *) buffered_file[file_id];
     if (bf->last_char == 0)
     {
-        while ((c = buffered_getc (bf)) != -1 && c != '>' && c != '@')
-            ; // go to next header
+        // go to next header
+        for (c = -1; c == -1; )
+        {
+            if (bf->buffer_start >= bf->buffer_end) if (!rebuffer (bf)) break;
+
+            size_t i = bf->buffer_start + scan_chars (bf->buffer + bf->buffer_start, bf->buffer_end - bf->buffer_start, '>', '@');
+
+            if (i < (size_t)bf->buffer_end)  { c = bf->buffer[i];  i++; }
+            bf->buffer_start = i;
+        }
         if (c == -1) return false; // eof
         bf->last_char = c;
     }
+
+    /** The sequences starting after the end of the iterated range are not ours (the header character has been read). */
+    if (_end != ~(u_int64_t)0  &&  bf->position() - 1 >= _end)  { return false; }
     bs->quality->length = bs->read->length = bs->dummy->length = 0;
+    bs->fastq = false;
 
     if (buffered_gets (bf, bs->header, (char *) &c, false, false) < 0) //ici
         return false; // eof
@@ -548,21 +1469,7 @@ bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, string& co
         while (buffered_gets (bf, bs->quality, NULL, true, true) >= 0 && bs->quality->length < bs->read->length)
             ; // read rest of quality
         bf->last_char = 0;
-        
-        quality.assign (bs->quality->string, bs->quality->length);
-       // printf("%i  %i\n",bs->quality->length,bs->header->length);
-    }
-
-    /** We update the data of the sequence. */
-#if 1
-    data.set (bs->read->string, bs->read->length);
-#else
-    data.setRef (bs->read->string, bs->read->length);
-#endif
-
-    //if (comment.empty() == false)
-    {
-        comment.assign (bs->header->string, bs->header->length);
+        bs->fastq = true;
     }
 
     return true;
@@ -576,10 +1483,18 @@ bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, string& co
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, int file_id)
+bool BankFasta::Iterator::read_next_seq (CommentMode_e mode)
 {
-    string dummy;
-    return get_next_seq_from_file (data, dummy,dummy, file_id, NONE);
+    bool success = read_next_seq_from_file (index_file, mode);
+    if (success) return true;
+
+    // cycle to next file if possible
+    if ((u_int64_t)index_file < _ref.nb_files - 1)
+    {
+        index_file++;
+        return read_next_seq (mode);
+    }
+    return false;
 }
 
 /*********************************************************************
@@ -591,18 +1506,22 @@ bool BankFasta::Iterator::get_next_seq_from_file (Vector<char>& data, int file_i
 ** REMARKS :
 *********************************************************************/
 bool BankFasta::Iterator::get_next_seq (Vector<char>& data, string& comment,string& quality, CommentMode_e mode)
-
 {
-    bool success = get_next_seq_from_file (data, comment,quality, index_file, mode);
-    if (success) return true;
+    if (read_next_seq (mode) == false)  { return false; }
 
-    // cycle to next file if possible
-    if ((u_int64_t)index_file < _ref.nb_files - 1)
-    {
-        index_file++;
-        return get_next_seq (data, comment,quality, mode);
-    }
-    return false;
+    buffered_strings_t* bs = (buffered_strings_t*) buffered_strings;
+
+    /** The item may be reused for records of different formats (see BankComposite), so the
+     * quality of a FASTA record is cleared. */
+    if (bs->fastq)  {  quality.assign (bs->quality->string, bs->quality->length);  }
+    else            {  quality.clear ();  }
+
+    /** We update the data of the sequence. */
+    data.set (bs->read->string, bs->read->length);
+
+    comment.assign (bs->header->string, bs->header->length);
+
+    return true;
 }
 
 /*********************************************************************
@@ -615,8 +1534,14 @@ bool BankFasta::Iterator::get_next_seq (Vector<char>& data, string& comment,stri
 *********************************************************************/
 bool BankFasta::Iterator::get_next_seq (Vector<char>& data)
 {
-    string  dummy;
-    return get_next_seq (data, dummy,dummy, NONE);
+    if (read_next_seq (NONE) == false)  { return false; }
+
+    buffered_strings_t* bs = (buffered_strings_t*) buffered_strings;
+
+    /** We update the data of the sequence. */
+    data.set (bs->read->string, bs->read->length);
+
+    return true;
 }
 
 /*********************************************************************
@@ -646,7 +1571,6 @@ void BankFasta::Iterator::init ()
 
         buffered_file_t** bf = (buffered_file_t **) buffered_file + i;
         *bf = (buffered_file_t *)  CALLOC (1, sizeof(buffered_file_t));
-        (*bf)->buffer = (unsigned char*)  MALLOC (BUFFER_SIZE);
         (*bf)->stream = gzopen (fname, "r");
 		
         /** We check that we can open the file. */
@@ -662,6 +1586,17 @@ void BankFasta::Iterator::init ()
             throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, fname);
 
         }
+
+        /** A compressed file may be decompressed in the background; otherwise the parser reads
+         * the file through its own buffer. */
+        if (_ref._nbDecompressThreads > 0  &&  gzdirect ((*bf)->stream) == 0)
+        {
+            (*bf)->decompressor = new Decompressor ((*bf)->stream, fname, Decompressor::isBGZF (fname), _ref._nbDecompressThreads);
+        }
+        else
+        {
+            (*bf)->buffer = (unsigned char*)  MALLOC (BUFFER_SIZE);
+        }
     }
 
     index_file = 0; // initialize the get_next_seq iterator to the first file
@@ -695,12 +1630,13 @@ void BankFasta::Iterator::finalize ()
 
         if (bf != 0)
         {
+            /** We stop the background decompression, which owns the buffers in such a case. */
+            if (bf->decompressor != 0)  {  delete bf->decompressor;  }
+            else                        {  FREE (bf->buffer);        }
+
             /** We close the handle of the file. */
             if (bf->stream != NULL)  {  gzclose (bf->stream);  bf->stream = 0; }
 
-            /** We delete the buffer. */
-            FREE (bf->buffer);
-
             /** We delete the buffered file itself. */
             FREE (bf);
         }
@@ -726,7 +1662,7 @@ void BankFasta::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_i
     /** We may have to initialize the instance. */
     init  ();
 
-    Vector<char> data;
+    buffered_strings_t* bs = (buffered_strings_t*) buffered_strings;
 
     /** We rewind the files. */
     for (u_int64_t i = 0; i < _ref.nb_files; i++)
@@ -741,11 +1677,12 @@ void BankFasta::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_i
     maxSize   = 0;
 
     number = 0;
-    while (get_next_seq (data)  &&  number <= _ref.getEstimateThreshold())
+    /** We only need the sizes of the sequences, so we don't copy them. */
+    while (read_next_seq (NONE)  &&  number <= _ref.getEstimateThreshold())
     {
         number ++;
-        if (data.size() > maxSize)  { maxSize = data.size(); }
-        totalSize += data.size ();
+        if ((u_int64_t)bs->read->length > maxSize)  { maxSize = bs->read->length; }
+        totalSize += bs->read->length;
     }
 
     u_int64_t actualPosition = 0;
@@ -756,7 +1693,7 @@ void BankFasta::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_i
     {
         buffered_file_t* current = (buffered_file_t *) buffered_file[i];
 
-        actualPosition += gztell (current->stream);
+        actualPosition += current->tell ();
     }
 
     if (actualPosition > 0)
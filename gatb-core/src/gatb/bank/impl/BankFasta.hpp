@@ -85,6 +85,11 @@ public:
     /** \copydoc IBank::iterator */
     tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
 
+    /** \copydoc IBank::splitIterator
+     * An uncompressed file is split into byte ranges; the bounds of the ranges are moved to the next
+     * sequence start. A gzip file can't be split. */
+    tools::dp::Iterator<Sequence>* splitIterator (size_t nbParts);
+
     /** \copydoc IBank::getNbItems */
     int64_t getNbItems () { return -1; }
 
@@ -95,7 +100,7 @@ public:
     void flush ();
 
     /** \copydoc IBank::getSize */
-    u_int64_t getSize ()  { return filesizes; }
+    u_int64_t getSize ();
 
     /** \copydoc IBank::estimate */
     void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
@@ -103,6 +108,14 @@ public:
     static void setDataLineSize (size_t len) { _dataLineSize = len; }
     static size_t getDataLineSize ()  { return _dataLineSize; }
 
+    /** Set the number of threads that decompress gzip files in the background during the iteration.
+     * A usual gzip file is decompressed by a single thread; only BGZF files (blocked gzip, as produced
+     * by bgzip) can use several threads. A value of 0 means that the decompression is done by the
+     * iterating thread itself.
+     * \param[in] nb : number of decompression threads */
+    static void setNbDecompressThreads (size_t nb) { _nbDecompressThreads = nb; }
+    static size_t getNbDecompressThreads ()  { return _nbDecompressThreads; }
+
     /** \copydoc IBank::finalize */
     void finalize ();
 
@@ -145,11 +158,37 @@ public:
             FULL
         };
 
+        /** Define how the data of the iterated sequences is provided. */
+        enum DataMode_e
+        {
+            /** The nucleotides, comment and quality are copied into the iterated Sequence object. */
+            COPY,
+            /** The nucleotides of the iterated Sequence object refer to the buffer of the parser, and
+             *  the comment and quality are copied only when the getters are called. \n
+             *  This data is valid only until the next call to 'next' and must not be modified; a copy of the
+             *  item (through the Sequence copy constructor or affectation operator) holds its own data.
+             *  Note that the item must be accessed through the getters (not through the _comment and _quality attributes).
+             *  This mode is used only for the item of the iterator itself: if the iterated items are provided
+             *  by the client (see tools::dp::Iterator::get), the data is copied. */
+            REFERENCE
+        };
+
         /** Constructor.
          * \param[in] ref : the associated iterable instance.
          * \param[in] commentMode : kind of comments we want to retrieve
+         * \param[in] dataMode : tells whether the data is copied or referred
+         */
+        Iterator (BankFasta& ref, CommentMode_e commentMode = FULL, DataMode_e dataMode = COPY);
+
+        /** Constructor for iterating a part of an uncompressed file: only the sequences whose header
+         * starts in the range [begin,end) of the file are iterated.
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] begin : offset of the first sequence of the range; it must be the start of a sequence
+         * \param[in] end : offset of the end of the range
+         * \param[in] commentMode : kind of comments we want to retrieve
+         * \param[in] dataMode : tells whether the data is copied or referred
          */
-        Iterator (BankFasta& ref, CommentMode_e commentMode = FULL);
+        Iterator (BankFasta& ref, u_int64_t begin, u_int64_t end, CommentMode_e commentMode = FULL, DataMode_e dataMode = COPY);
 
         /** Destructor */
         ~Iterator ();
@@ -185,6 +224,10 @@ public:
 
         /* Number of time next has been called   */
         u_int64_t   _nIters;
+
+        /** Range of the file to be iterated (the whole file by default). */
+        u_int64_t _begin;
+        u_int64_t _end;
         
         /** Initialization method. */
         void init ();
@@ -200,10 +243,53 @@ public:
         bool get_next_seq           (tools::misc::Vector<char>& data);
         bool get_next_seq           (tools::misc::Vector<char>& data, std::string& comment, std::string& quality, CommentMode_e mode);
 
-        bool get_next_seq_from_file (tools::misc::Vector<char>& data, int file_id);
-        bool get_next_seq_from_file (tools::misc::Vector<char>& data, std::string& comment, std::string& quality, int file_id, CommentMode_e mode);
+        /** Parse the next sequence into the buffered strings (going to the next file if needed). */
+        bool read_next_seq           (CommentMode_e mode);
+        bool read_next_seq_from_file (int file_id, CommentMode_e mode);
 
         size_t _index;
+
+        /** Sequence referring to the buffers of the parser (see REFERENCE mode). */
+        class LazySequence : public Sequence
+        {
+        public:
+
+            LazySequence () : Sequence(tools::misc::Data::ASCII)  {  set (0, 0, 0, 0, 0, 0);  }
+
+            /** \copydoc Sequence::getComment */
+            const std::string& getComment ()  const
+            {
+                if (_hasComment == false)  {  const_cast<std::string&>(_comment).assign (_header != 0 ? _header : "", _headerLength);  _hasComment = true;  }
+                return _comment;
+            }
+
+            /** \copydoc Sequence::getQuality */
+            const std::string& getQuality ()  const
+            {
+                if (_hasQuality == false)  {  const_cast<std::string&>(_quality).assign (_qual != 0 ? _qual : "", _qualLength);  _hasQuality = true;  }
+                return _quality;
+            }
+
+            /** Set the buffers of the current sequence; no copy is done. */
+            void set (char* data, size_t dataLength, const char* header, size_t headerLength, const char* qual, size_t qualLength)
+            {
+                getData().setRef (data, dataLength);
+                _header = header;  _headerLength = headerLength;  _hasComment = false;
+                _qual   = qual;    _qualLength   = qualLength;    _hasQuality = false;
+            }
+
+        private:
+
+            const char*  _header;
+            size_t       _headerLength;
+            mutable bool _hasComment;
+
+            const char*  _qual;
+            size_t       _qualLength;
+            mutable bool _hasQuality;
+        };
+
+        LazySequence _lazyItem;
     };
 
 protected:
@@ -220,6 +306,7 @@ protected:
     std::vector<std::string> _filenames;
 
     u_int64_t filesizes;  // estimate of total size for all files
+    bool      filesizesKnown;  // tells whether filesizes has been computed
     size_t    nb_files;   // total nb of files
 
     /** File handle for inserting sequences into the bank. */
@@ -228,6 +315,7 @@ protected:
     gzFile _gz_insertHandle;
     
     static size_t _dataLineSize;
+    static size_t _nbDecompressThreads;
 
     /** Initialization method (compute the file sizes). */
     void init ();
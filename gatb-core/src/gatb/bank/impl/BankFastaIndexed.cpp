@@ -0,0 +1,434 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/BankFastaIndexed.hpp>
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/tools/misc/api/StringsRepository.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::misc::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankFastaIndexed::BankFastaIndexed (const std::string& filename)
+    : BankFasta (filename), _fd(-1)
+{
+    const char* fname = _filenames[0].c_str();
+
+    _fd = open (fname, O_RDONLY);
+    if (_fd < 0)  {  throw ExceptionErrno (STR_BANK_unable_open_file, fname);  }
+
+    /** A compressed file can't be accessed randomly. */
+    unsigned char magic[2] = { 0, 0 };
+    if (pread (_fd, magic, 2, 0) == 2  &&  magic[0] == 31  &&  magic[1] == 139)
+    {
+        close (_fd);
+        throw Exception (STR_BANK_unable_index_file, fname, "compressed file");
+    }
+
+    /** We use the existing index, or we build it. */
+    bool isLoaded = loadIndex();
+    if (isLoaded == false)
+    {
+        try
+        {
+            buildIndex ();
+        }
+        catch (...)
+        {
+            close (_fd);
+            throw;
+        }
+    }
+
+    /** As samtools, we reject duplicate names, which would make the access by name ambiguous. */
+    for (size_t i=0; i<_entries.size(); i++)
+    {
+        if (_ids.insert (make_pair (_entries[i].name, i)).second == false)
+        {
+            close (_fd);
+            throw Exception (STR_BANK_unable_index_file, fname, ("duplicate sequence name " + _entries[i].name).c_str());
+        }
+    }
+
+    if (isLoaded == false)  {  saveIndex ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankFastaIndexed::~BankFastaIndexed ()
+{
+    if (_fd >= 0)  {  close (_fd);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t BankFastaIndexed::getId (const std::string& name) const
+{
+    map<string,size_t>::const_iterator lookup = _ids.find (name);
+
+    if (lookup == _ids.end())  {  throw Exception (STR_BANK_unknown_sequence, name.c_str(), _filenames[0].c_str());  }
+
+    return lookup->second;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+const BankFastaIndexed::Entry& BankFastaIndexed::getEntry (size_t id) const
+{
+    if (id >= _entries.size())  {  throw Exception (STR_BANK_bad_sequence_id, (long)id, (long)_entries.size(), _filenames[0].c_str());  }
+
+    return _entries[id];
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFastaIndexed::getSequence (size_t id, Sequence& seq)
+{
+    const Entry& entry = getEntry (id);
+
+    getRegion (id, 0, entry.length, seq);
+
+    seq.setComment (entry.name);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the bytes between the first and the last nucleotides are read at once,
+**           then the end of lines are removed.
+*********************************************************************/
+void BankFastaIndexed::getRegion (size_t id, u_int64_t start, u_int64_t length, Sequence& seq)
+{
+    const Entry& entry = getEntry (id);
+
+    /** We truncate the region at the end of the sequence. */
+    if (start  > entry.length)          { start  = entry.length;         }
+    if (length > entry.length - start)  { length = entry.length - start; }
+
+    vector<char> buffer;
+
+    if (length > 0)
+    {
+        u_int64_t last  = start + length - 1;
+        u_int64_t begin = entry.offset + (start / entry.lineBases) * entry.lineWidth + (start % entry.lineBases);
+        u_int64_t end   = entry.offset + (last  / entry.lineBases) * entry.lineWidth + (last  % entry.lineBases) + 1;
+
+        buffer.resize (end - begin);
+        read (begin, &buffer[0], buffer.size());
+
+        /** We keep only the nucleotides. */
+        buffer.erase (std::remove_if (buffer.begin(), buffer.end(), BankFastaIndexed::isEndOfLine), buffer.end());
+    }
+
+    if (buffer.size() != length)  {  throw Exception (STR_BANK_unable_index_file, _filenames[0].c_str(), "index not consistent with the file");  }
+
+    if (length > 0)  {  seq.getData().set (&buffer[0], length);  }
+    else             {  seq.getData().setSize (0);                }
+
+    seq.setComment (Stringify::format ("%s:%lld-%lld", entry.name.c_str(), start+1, start+length));
+    seq.setQuality ("");
+    seq.setIndex   (id);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFastaIndexed::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
+{
+    number    = _entries.size();
+    totalSize = 0;
+    maxSize   = 0;
+
+    for (size_t i=0; i<_entries.size(); i++)
+    {
+        totalSize += _entries[i].length;
+        maxSize    = std::max (maxSize, _entries[i].length);
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFastaIndexed::read (u_int64_t offset, char* buffer, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t nb = pread (_fd, buffer, size, offset);
+
+        if (nb < 0 && errno == EINTR)  { continue; }
+        if (nb <= 0)  {  throw ExceptionErrno (STR_BANK_unable_open_file, _filenames[0].c_str());  }
+
+        buffer += nb;  offset += nb;  size -= nb;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the index is used only if it is strictly more recent than the FASTA file
+**           and if its sequences lie within the FASTA file.
+*********************************************************************/
+bool BankFastaIndexed::loadIndex ()
+{
+    string indexUri = getIndexUri (_filenames[0]);
+
+    struct stat statFasta, statIndex;
+    if (stat (_filenames[0].c_str(), &statFasta) != 0  ||  stat (indexUri.c_str(), &statIndex) != 0)  { return false; }
+
+    /** The modification times are compared with the nanoseconds when available; an index modified
+     * during the same clock tick as the FASTA file may be stale, so it is not used. */
+#ifdef __APPLE__
+    long nsecFasta = statFasta.st_mtimespec.tv_nsec,  nsecIndex = statIndex.st_mtimespec.tv_nsec;
+#else
+    long nsecFasta = statFasta.st_mtim.tv_nsec,       nsecIndex = statIndex.st_mtim.tv_nsec;
+#endif
+    if (statIndex.st_mtime <  statFasta.st_mtime)                             { return false; }
+    if (statIndex.st_mtime == statFasta.st_mtime  &&  nsecIndex <= nsecFasta)  { return false; }
+
+    ifstream file (indexUri.c_str());
+    if (!file)  { return false; }
+
+    _entries.clear();
+
+    bool isValid = true;
+    string line;
+    while (isValid  &&  getline (file, line))
+    {
+        /** A line is: name, length, offset, bases per line, bytes per line. */
+        size_t tab = line.find ('\t');
+        if (tab == string::npos)  { isValid = false;  break; }
+
+        Entry entry;
+        entry.name.assign (line, 0, tab);
+
+        unsigned long long length, offset, lineBases, lineWidth;
+        isValid = sscanf (line.c_str() + tab + 1, "%llu\t%llu\t%llu\t%llu", &length, &offset, &lineBases, &lineWidth) == 4  &&  lineBases > 0;
+
+        entry.length    = length;
+        entry.offset    = offset;
+        entry.lineBases = lineBases;
+        entry.lineWidth = lineWidth;
+
+        /** The last nucleotide of the sequence must lie within the FASTA file. */
+        if (isValid  &&  entry.length > 0)
+        {
+            u_int64_t last = entry.offset + ((entry.length-1) / entry.lineBases) * entry.lineWidth + (entry.length-1) % entry.lineBases;
+            isValid = last < (u_int64_t)statFasta.st_size;
+        }
+
+        if (isValid)  {  _entries.push_back (entry);  }
+    }
+
+    if (isValid == false)  { _entries.clear(); }
+
+    DEBUG (("BankFastaIndexed::loadIndex  uri=%s  valid=%d  nbEntries=%ld\n", indexUri.c_str(), isValid, _entries.size()));
+
+    return isValid;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : as samtools, we check that the lines of a sequence have the same
+**           length (except the last one).
+*********************************************************************/
+void BankFastaIndexed::buildIndex ()
+{
+    const char* fname = _filenames[0].c_str();
+
+    FILE* file = fopen (fname, "r");
+    if (file == 0)  {  throw ExceptionErrno (STR_BANK_unable_open_file, fname);  }
+
+    _entries.clear();
+
+    char*     line     = 0;
+    size_t    capacity = 0;
+    ssize_t   width    = 0;
+    u_int64_t position = 0;
+
+    /** Tells whether the last line of the current sequence has been read. */
+    bool isLastLine = false;
+
+    string error;
+
+    while (error.empty()  &&  (width = getline (&line, &capacity, file)) > 0)
+    {
+        position += width;
+
+        size_t bases = width;
+        while (bases > 0 && (line[bases-1]=='\n' || line[bases-1]=='\r'))  { bases--; }
+
+        /** A new sequence starts. */
+        if (line[0] == '>')
+        {
+            size_t nameLength = 1;
+            while (nameLength < bases  &&  !isspace (line[nameLength]))  { nameLength++; }
+
+            Entry entry;
+            entry.name.assign (line+1, nameLength-1);
+            entry.length    = 0;
+            entry.offset    = position;
+            entry.lineBases = 0;
+            entry.lineWidth = 0;
+
+            _entries.push_back (entry);
+            isLastLine = false;
+            continue;
+        }
+
+        if (_entries.empty())
+        {
+            if (bases > 0)  { error = "not a FASTA file"; }
+            continue;
+        }
+
+        Entry& entry = _entries.back();
+
+        /** An empty line ends the sequence. */
+        if (bases == 0)  {  isLastLine = entry.length > 0;  continue;  }
+
+        if (isLastLine)  {  error = "different line lengths in sequence " + entry.name;  break;  }
+
+        if (entry.lineBases == 0)  {  entry.lineBases = bases;  entry.lineWidth = width;  }
+
+        if (bases > entry.lineBases)  {  error = "different line lengths in sequence " + entry.name;  break;  }
+
+        /** A shorter line (or without end of line) is the last one of the sequence. */
+        if (bases < entry.lineBases  ||  (size_t)width != entry.lineWidth)  {  isLastLine = true;  }
+
+        entry.length += bases;
+    }
+
+    if (line != 0)  { free (line); }
+    fclose (file);
+
+    if (!error.empty())  {  _entries.clear();  throw Exception (STR_BANK_unable_index_file, fname, error.c_str());  }
+
+    /** A sequence without nucleotides has the layout of an empty line, as in samtools. */
+    for (size_t i=0; i<_entries.size(); i++)
+    {
+        if (_entries[i].lineBases == 0)  {  _entries[i].lineBases = 1;  _entries[i].lineWidth = 2;  }
+    }
+
+    DEBUG (("BankFastaIndexed::buildIndex  uri=%s  nbEntries=%ld\n", fname, _entries.size()));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the index is written into a temporary file that is then renamed, so
+**           concurrent processes never read a partial index.
+*********************************************************************/
+void BankFastaIndexed::saveIndex ()
+{
+    string indexUri = getIndexUri (_filenames[0]);
+    string tmpUri   = indexUri + Stringify::format (".%d", getpid());
+
+    FILE* file = fopen (tmpUri.c_str(), "w");
+    if (file == 0)  { return; }
+
+    bool isValid = true;
+    for (size_t i=0; isValid && i<_entries.size(); i++)
+    {
+        const Entry& e = _entries[i];
+        isValid = fprintf (file, "%s\t%llu\t%llu\t%llu\t%llu\n", e.name.c_str(),
+            (unsigned long long)e.length, (unsigned long long)e.offset, (unsigned long long)e.lineBases, (unsigned long long)e.lineWidth
+        ) > 0;
+    }
+
+    isValid = (fclose (file) == 0) && isValid;
+
+    if (isValid == false  ||  rename (tmpUri.c_str(), indexUri.c_str()) != 0)  {  ::remove (tmpUri.c_str());  }
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,172 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BankFastaIndexed.hpp
+ *  \brief FASTA bank with random access to its sequences
+ */
+
+#ifndef _GATB_CORE_BANK_IMPL_BANK_FASTA_INDEXED_HPP_
+#define _GATB_CORE_BANK_IMPL_BANK_FASTA_INDEXED_HPP_
+
+/********************************************************************************/
+
+#include <gatb/bank/impl/BankFasta.hpp>
+
+#include <vector>
+#include <string>
+#include <map>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief FASTA bank with random access to its sequences
+ *
+ * This bank is iterated like a BankFasta. In addition, a sequence or a region of a sequence
+ * can be fetched directly with getSequence and getRegion, without reading the file from its start.
+ *
+ * The random access relies on an index compatible with 'samtools faidx' (a .fai file next to the
+ * FASTA file). For each sequence, the index gives its name (first word of the header), its length,
+ * the offset of its first nucleotide and the layout of its lines. The index is read from the .fai
+ * file if this one is more recent than the FASTA file; otherwise, it is built by reading the file
+ * once and saved (if possible) into the .fai file. As in samtools, the sequence names must be unique.
+ *
+ * The nucleotides are read with 'pread', so getSequence and getRegion can be called by several threads
+ * at the same time. Only uncompressed FASTA files are supported; all the lines of a sequence, except
+ * the last one, must have the same length.
+ *
+ * Sample of use:
+ * \code
+ * BankFastaIndexed bank ("genome.fa");
+ * Sequence seq;
+ * bank.getRegion ("chr1", 1000000, 500, seq);
+ * \endcode
+ */
+class BankFastaIndexed : public BankFasta
+{
+public:
+
+    /** Returns the name of the bank format. */
+    static const char* name()  { return "fasta_indexed"; }
+
+    /** Constructor.
+     * \param[in] filename : uri of the FASTA file.
+     */
+    BankFastaIndexed (const std::string& filename);
+
+    /** Destructor. */
+    ~BankFastaIndexed ();
+
+    /** Entry of the index for one sequence (ie. one line of the .fai file). */
+    struct Entry
+    {
+        std::string name;       // name of the sequence (first word of the header)
+        u_int64_t   length;     // number of nucleotides
+        u_int64_t   offset;     // offset in the file of the first nucleotide
+        u_int64_t   lineBases;  // number of nucleotides per line
+        u_int64_t   lineWidth;  // number of bytes per line (including the end of line)
+    };
+
+    /** Get the number of sequences of the bank.
+     * \return the number of sequences. */
+    size_t getNbSequences () const  { return _entries.size(); }
+
+    /** Get the index entry of a sequence. An exception is thrown if the index is out of range.
+     * \param[in] id : index of the sequence in the file
+     * \return the entry. */
+    const Entry& getEntry (size_t id) const;
+
+    /** Get the index of a sequence in the file. An exception is thrown if the name is unknown.
+     * \param[in] name : name of the sequence
+     * \return the index of the sequence. */
+    size_t getId (const std::string& name) const;
+
+    /** Get a sequence of the bank. The comment of the sequence is its name. An exception is thrown
+     * if the index is out of range.
+     * \param[in] id : index of the sequence in the file
+     * \param[out] seq : the sequence */
+    void getSequence (size_t id, Sequence& seq);
+
+    /** Get a sequence of the bank.
+     * \param[in] name : name of the sequence
+     * \param[out] seq : the sequence */
+    void getSequence (const std::string& name, Sequence& seq)  {  getSequence (getId(name), seq);  }
+
+    /** Get a region of a sequence of the bank. The region is truncated at the end of the sequence. The
+     * comment of the sequence is 'name:begin-end' (1-based, as in samtools). An exception is thrown
+     * if the index is out of range.
+     * \param[in] id : index of the sequence in the file
+     * \param[in] start : position (0-based) of the first nucleotide of the region
+     * \param[in] length : number of nucleotides of the region
+     * \param[out] seq : the region */
+    void getRegion (size_t id, u_int64_t start, u_int64_t length, Sequence& seq);
+
+    /** Get a region of a sequence of the bank.
+     * \param[in] name : name of the sequence
+     * \param[in] start : position (0-based) of the first nucleotide of the region
+     * \param[in] length : number of nucleotides of the region
+     * \param[out] seq : the region */
+    void getRegion (const std::string& name, u_int64_t start, u_int64_t length, Sequence& seq)  {  getRegion (getId(name), start, length, seq);  }
+
+    /** \copydoc IBank::getNbItems */
+    int64_t getNbItems ()  { return _entries.size(); }
+
+    /** \copydoc IBank::estimate
+     * The index gives the exact values. */
+    void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
+
+    /** Get the uri of the index of a FASTA file.
+     * \param[in] filename : uri of the FASTA file
+     * \return the uri of the index. */
+    static std::string getIndexUri (const std::string& filename)  { return filename + ".fai"; }
+
+private:
+
+    /** Index of the sequences. */
+    std::vector<Entry>            _entries;
+    std::map<std::string,size_t>  _ids;
+
+    /** File descriptor used for reading the sequences. */
+    int _fd;
+
+    /** Read the .fai file.
+     * \return false if the index can't be read. */
+    bool loadIndex ();
+
+    /** Build the index by reading the FASTA file. */
+    void buildIndex ();
+
+    /** Write the .fai file (nothing is done if the file can't be written). */
+    void saveIndex ();
+
+    /** Read some bytes of the FASTA file. */
+    void read (u_int64_t offset, char* buffer, size_t size);
+
+    /** Tells whether a character is part of an end of line. */
+    static bool isEndOfLine (char c)  { return c=='\n' || c=='\r'; }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK_IMPL_BANK_FASTA_INDEXED_HPP_ */
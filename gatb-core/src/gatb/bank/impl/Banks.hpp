@@ -26,6 +26,7 @@
 /********************************************************************************/
 
 #include <gatb/bank/impl/BankFasta.hpp>
+#include <gatb/bank/impl/BankFastaIndexed.hpp>
 #include <gatb/bank/impl/BankBinary.hpp>
 #include <gatb/bank/impl/BankStrings.hpp>
 #include <gatb/bank/impl/BankSplitter.hpp>
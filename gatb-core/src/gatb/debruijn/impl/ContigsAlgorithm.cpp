@@ -0,0 +1,306 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/debruijn/impl/ContigsAlgorithm.hpp>
+#include <gatb/system/impl/System.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+
+// We use the required packages
+using namespace std;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+using namespace gatb::core::bank;
+using namespace gatb::core::kmer;
+
+using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::misc::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb  {  namespace core  {   namespace debruijn  {   namespace impl {
+/********************************************************************************/
+
+static const char* progressFormat1 = "Graph: build contigs                   ";
+static const char* progressFormat2 = "Graph: nb contigs found : %-9d    ";
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ContigsAlgorithm::ContigsAlgorithm (
+    const Graph&                graph,
+    bank::IBank*                output,
+    tools::misc::TraversalKind  kind,
+    size_t                      nb_cores,
+    size_t                      minLength,
+    tools::misc::IProperties*   options
+)
+    : Algorithm("contigs", nb_cores, options), _graph (graph), _output(0), _kind(kind), _minLength(minLength),
+      _nbContigs(0), _nbNucleotides(0), _nbRetries(0)
+{
+    setOutput (output);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ContigsAlgorithm::~ContigsAlgorithm ()
+{
+    setOutput (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ContigsAlgorithm::build (const Node& node, Traversal& traversal, Terminator& terminator, Contig& contig)
+{
+    contig.left.clear  ();
+    contig.right.clear ();
+
+    /** A starting node already marked means that it belongs to a previous contig. */
+    contig.skipped = terminator.is_marked_branching (node);
+    if (contig.skipped)  { return; }
+
+    /** We traverse the graph on both sides of the starting node. */
+    traversal.traverse (node,                 DIR_OUTCOMING, contig.right);
+    traversal.traverse (_graph.reverse(node), DIR_OUTCOMING, contig.left);
+
+    /** We mark the starting node. */
+    terminator.mark (node);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ContigsAlgorithm::output (const Node& node, const Contig& contig, Sequence& seq)
+{
+    if (contig.skipped)  { return; }
+
+    size_t length = contig.left.size() + _graph.getKmerSize() + contig.right.size();
+
+    if (length < _minLength)  { return; }
+
+    /** We build the sequence: reverse complement of the left path, starting node, right path. */
+    Data& data = seq.getData();
+    data.resize (length);
+
+    size_t idx = 0;
+
+    for (int i=contig.left.size()-1; i>=0; i--)  {  data[idx++] = ascii (reverse (contig.left[i]));  }
+
+    string nodeStr = _graph.toString (node);
+    for (size_t i=0; i<nodeStr.size(); i++)  { data[idx++] = nodeStr[i]; }
+
+    for (size_t i=0; i<contig.right.size(); i++)  { data[idx++] = contig.right.ascii(i); }
+
+    seq.setComment (Stringify::format ("%ld__len__%ld", _nbContigs, length));
+
+    _output->insert (seq);
+
+    _nbContigs     ++;
+    _nbNucleotides += length;
+}
+
+/********************************************************************************/
+
+/* Command that computes contigs for some starting nodes of a batch. The shared terminator
+ * is only read (through a SpeculativeTerminator) and the journal of marks of each contig
+ * is kept in order to be committed later. */
+class ContigsBatchCommand : public ICommand, public system::SmartPointer
+{
+public:
+
+    ContigsBatchCommand (
+        ContigsAlgorithm&                         algo,
+        const std::vector<Node>&                  nodes,
+        size_t                                    offset,
+        std::vector<ContigsAlgorithm::Contig>&    contigs,
+        size_t&                                   next,
+        SpeculativeTerminator&                    terminator,
+        Traversal&                                traversal
+    )
+        : _algo(algo), _nodes(nodes), _offset(offset), _contigs(contigs), _next(next),
+          _terminator(terminator), _traversal(traversal)  {}
+
+    void execute ()
+    {
+        for (size_t i = __sync_fetch_and_add (&_next, 1);  i < _contigs.size();  i = __sync_fetch_and_add (&_next, 1))
+        {
+            _terminator.reset ();
+
+            _algo.build (_nodes[_offset+i], _traversal, _terminator, _contigs[i]);
+
+            /** We keep the journal of this contig. */
+            _contigs[i].journal.swap (_terminator.getJournal());
+        }
+    }
+
+private:
+
+    ContigsAlgorithm&                       _algo;
+    const std::vector<Node>&                _nodes;
+    size_t                                  _offset;
+    std::vector<ContigsAlgorithm::Contig>&  _contigs;
+    size_t&                                 _next;
+    SpeculativeTerminator&                  _terminator;
+    Traversal&                              _traversal;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ContigsAlgorithm::execute ()
+{
+    _nbContigs = _nbNucleotides = _nbRetries = 0;
+
+    /** We get the starting nodes, ie. the branching nodes. */
+    vector<Node> nodes;
+
+    Graph::Iterator<BranchingNode> itBranching = _graph.iterator<BranchingNode>();
+    for (itBranching.first(); !itBranching.isDone(); itBranching.next())  {  nodes.push_back (itBranching.item());  }
+
+    /** We create the shared terminator and the traversal that uses it. */
+    BranchingTerminator terminator (_graph);
+
+    Traversal* traversal = Traversal::create (_kind, _graph, terminator);
+    LOCAL (traversal);
+
+    size_t nbCores = getDispatcher()->getExecutionUnitsNumber();
+
+    /** We create one speculative terminator and one traversal per thread. */
+    vector<SpeculativeTerminator*> terminators;
+    vector<Traversal*>             traversals;
+    for (size_t i=0; i<nbCores; i++)
+    {
+        terminators.push_back (new SpeculativeTerminator (terminator));
+        traversals.push_back  (Traversal::create (_kind, _graph, *terminators[i]));
+        traversals[i]->use();
+    }
+
+    /** We create a listener for progress information. */
+    IteratorListener* listener = createIteratorListener (nodes.size(), progressFormat1);
+    LOCAL (listener);
+    listener->init ();
+
+    Sequence seq (Data::ASCII);
+
+    if (nbCores <= 1)
+    {
+        /** Serial process. */
+        Contig contig;
+        for (size_t i=0; i<nodes.size(); i++)
+        {
+            build  (nodes[i], *traversal, terminator, contig);
+            output (nodes[i], contig, seq);
+
+            if ((i+1) % 1000 == 0)  { listener->inc (1000); }
+        }
+        listener->inc (nodes.size() % 1000);
+    }
+    else
+    {
+        size_t batchSize = batchSizePerCore * nbCores;
+
+        vector<Contig> contigs;
+
+        for (size_t offset=0; offset<nodes.size(); offset+=batchSize)
+        {
+            contigs.clear ();
+            contigs.resize (std::min (batchSize, nodes.size() - offset));
+
+            /** Step 1: the contigs of the batch are computed by N threads; the shared terminator is only read. */
+            size_t next = 0;
+
+            vector<ICommand*> cmds;
+            for (size_t i=0; i<nbCores; i++)
+            {
+                cmds.push_back (new ContigsBatchCommand (*this, nodes, offset, contigs, next, *terminators[i], *traversals[i]));
+            }
+            getDispatcher()->dispatchCommands (cmds);
+
+            /** Step 2: the contigs are committed in the order of the starting nodes. If a contig has read marks
+             * that have been modified by a previous commit, we compute it again with the shared terminator. */
+            for (size_t i=0; i<contigs.size(); i++)
+            {
+                if (terminators[0]->isValid (contigs[i].journal))
+                {
+                    terminators[0]->commit (contigs[i].journal);
+                }
+                else
+                {
+                    build (nodes[offset+i], *traversal, terminator, contigs[i]);
+                    _nbRetries ++;
+                }
+
+                output (nodes[offset+i], contigs[i], seq);
+            }
+
+            listener->inc (contigs.size());
+        }
+    }
+
+    for (size_t i=0; i<nbCores; i++)  {  traversals[i]->forget();  delete terminators[i];  }
+
+    /** We flush the output bank. */
+    _output->flush ();
+
+    listener->setMessage (Stringify::format (progressFormat2, _nbContigs));
+    listener->finish ();
+
+    /** We gather some statistics. */
+    getInfo()->add (1, "stats");
+    getInfo()->add (2, "nb_starting_nodes", "%ld", nodes.size());
+    getInfo()->add (2, "nb_contigs",        "%ld", _nbContigs);
+    getInfo()->add (2, "nb_nucleotides",    "%ld", _nbNucleotides);
+    getInfo()->add (2, "nb_retries",        "%ld", _nbRetries);
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
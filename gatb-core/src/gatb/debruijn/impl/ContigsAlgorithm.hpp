@@ -0,0 +1,146 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file ContigsAlgorithm.hpp
+ *  \brief Algorithm that computes the contigs of a Graph with a Traversal
+ */
+
+#ifndef _GATB_CORE_DEBRUIJN_IMPL_CONTIGS_ALGORITHM_HPP_
+#define _GATB_CORE_DEBRUIJN_IMPL_CONTIGS_ALGORITHM_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/impl/Algorithm.hpp>
+#include <gatb/debruijn/impl/Graph.hpp>
+#include <gatb/debruijn/impl/Terminator.hpp>
+#include <gatb/debruijn/impl/Traversal.hpp>
+#include <gatb/bank/api/IBank.hpp>
+
+#include <vector>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace debruijn  {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Computation of the contigs of a Graph
+ *
+ * This class implements the usual contigs generation: the branching nodes are iterated
+ * (in their storage order) and, for each branching node not marked yet, the graph is traversed
+ * on both sides of the node. The traversed nodes are marked with a BranchingTerminator, so they
+ * can't be used by other contigs. The contigs are dumped into an output bank.
+ *
+ * The result of such a process depends on the order of the starting nodes, because of the marks.
+ * In order to use several threads while keeping exactly the same contigs (and the same order)
+ * as the serial process, the starting nodes are processed by batches:
+ *  - each thread computes contigs for some starting nodes of the batch with a SpeculativeTerminator;
+ *    during this phase, the marks of the shared terminator are only read.
+ *  - then the contigs of the batch are committed in the order of the starting nodes. A contig whose
+ *    marks reads have been modified by a previous commit is computed again with the shared terminator.
+ *
+ * Example of use:
+ * \code
+ * BankFasta output ("contigs.fa");
+ * ContigsAlgorithm algo (graph, output, TRAVERSAL_CONTIG, 0);
+ * algo.execute ();
+ * \endcode
+ */
+class ContigsAlgorithm : public gatb::core::tools::misc::impl::Algorithm
+{
+public:
+
+    /** Constructor.
+     * \param[in] graph : graph from which we compute the contigs
+     * \param[in] output : bank where the contigs will be put
+     * \param[in] kind : kind of traversal
+     * \param[in] nb_cores : number of cores to be used; 0 means all available cores
+     * \param[in] minLength : contigs shorter than this length are not put in the output bank
+     * \param[in] options : extra options
+     */
+    ContigsAlgorithm (
+        const Graph&                graph,
+        bank::IBank*                output,
+        tools::misc::TraversalKind  kind      = tools::misc::TRAVERSAL_CONTIG,
+        size_t                      nb_cores  = 0,
+        size_t                      minLength = 0,
+        tools::misc::IProperties*   options   = 0
+    );
+
+    /** Destructor. */
+    ~ContigsAlgorithm ();
+
+    /** \copydoc tools::misc::impl::Algorithm::execute */
+    void execute ();
+
+    /** Get the number of contigs put in the output bank.
+     * \return the number of contigs. */
+    u_int64_t getNbContigs () const { return _nbContigs; }
+
+    /** Get the total number of nucleotides of the contigs put in the output bank.
+     * \return the number of nucleotides. */
+    u_int64_t getNbNucleotides () const { return _nbNucleotides; }
+
+    /** Number of starting nodes in a batch for each thread. */
+    static const size_t batchSizePerCore = 256;
+
+private:
+
+    const Graph& _graph;
+
+    bank::IBank* _output;
+    void setOutput (bank::IBank* output)  { SP_SETATTR(output); }
+
+    tools::misc::TraversalKind _kind;
+    size_t                     _minLength;
+
+    u_int64_t _nbContigs;
+    u_int64_t _nbNucleotides;
+    u_int64_t _nbRetries;
+
+    /** Result of the traversals from one starting node. */
+    struct Contig
+    {
+        Contig () : skipped(true)  {}
+        bool skipped;
+        Path left;
+        Path right;
+        SpeculativeTerminator::Journal journal;
+    };
+
+    /** Compute the contig starting from a branching node. The terminator is the one used by the
+     * traversal object.
+     * \param[in] node : starting node
+     * \param[in] traversal : traversal object
+     * \param[in] terminator : terminator of the traversal
+     * \param[out] contig : the result */
+    void build (const Node& node, Traversal& traversal, Terminator& terminator, Contig& contig);
+
+    /** Insert a contig in the output bank (if long enough). */
+    void output (const Node& node, const Contig& contig, bank::Sequence& seq);
+
+    friend class ContigsBatchCommand;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_DEBRUIJN_IMPL_CONTIGS_ALGORITHM_HPP_ */
@@ -46,12 +46,14 @@ Frontline::Frontline (
     Terminator&       terminator,
     const Node&       startingNode
 ) :
-    _direction(direction), _graph(graph), _terminator(terminator), _depth(0),
-    _all_involved_extensions(0)
+    _direction(direction), _graph(graph), _terminator(terminator),
+    _ownArena(new FrontlineArena()), _arena(_ownArena), _slot(_arena->acquire()),
+    _frontline(&_slot.current), _first(0), _depth(0),
+    _all_involved_extensions(0), _involved_extensions(0), _already_frontlined(_slot.frontlined)
 {
     _already_frontlined.insert (startingNode.kmer);
 
-    _frontline.push (NodeNt (startingNode, kmer::NUCL_UNKNOWN));
+    _frontline->push_back (NodeNt (startingNode, kmer::NUCL_UNKNOWN));
 }
 
 /*********************************************************************
@@ -71,13 +73,60 @@ Frontline::Frontline (
     const Node&       previousNode,
     std::set<Node>*   all_involved_extensions
 ) :
-    _direction(direction), _graph(graph), _terminator(terminator), _depth(0),
-    _all_involved_extensions(all_involved_extensions)
+    _direction(direction), _graph(graph), _terminator(terminator),
+    _ownArena(new FrontlineArena()), _arena(_ownArena), _slot(_arena->acquire()),
+    _frontline(&_slot.current), _first(0), _depth(0),
+    _all_involved_extensions(all_involved_extensions), _involved_extensions(0), _already_frontlined(_slot.frontlined)
 {
     _already_frontlined.insert (startingNode.kmer);
     _already_frontlined.insert (previousNode.kmer);
 
-    _frontline.push (NodeNt (startingNode, kmer::NUCL_UNKNOWN));
+    _frontline->push_back (NodeNt (startingNode, kmer::NUCL_UNKNOWN));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+// a frontline is a set of nodes having equal depth in the BFS
+Frontline::Frontline (
+    Direction           direction,
+    const Graph&        graph,
+    Terminator&         terminator,
+    const Node&         startingNode,
+    const Node&         previousNode,
+    FrontlineArena&     arena,
+    std::vector<Node>*  involved_extensions,
+    std::set<Node>*     all_involved_extensions
+) :
+    _direction(direction), _graph(graph), _terminator(terminator),
+    _ownArena(0), _arena(&arena), _slot(_arena->acquire()),
+    _frontline(&_slot.current), _first(0), _depth(0),
+    _all_involved_extensions(all_involved_extensions), _involved_extensions(involved_extensions), _already_frontlined(_slot.frontlined)
+{
+    _already_frontlined.insert (startingNode.kmer);
+    _already_frontlined.insert (previousNode.kmer);
+
+    _frontline->push_back (NodeNt (startingNode, kmer::NUCL_UNKNOWN));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+Frontline::~Frontline ()
+{
+    _arena->release ();
+
+    if (_ownArena != 0)  { delete _ownArena; }
 }
 
 /*********************************************************************
@@ -92,13 +141,14 @@ bool Frontline::go_next_depth()
 {
     // extend all nodes in this frontline simultaneously, creating a new frontline
     stopped_reason=NONE;
-    queue_nodes new_frontline;
 
-    while (!_frontline.empty())
+    std::vector<NodeNt>* new_frontline = (_frontline == &_slot.current ? &_slot.next : &_slot.current);
+    new_frontline->clear();
+
+    while (_first < _frontline->size())
     {
-        /** We get the first item of the queue and remove it from the queue. */
-        NodeNt current_node = _frontline.front();
-        _frontline.pop();
+        /** We get the first item of the frontline and remove it from the frontline. */
+        NodeNt current_node = (*_frontline)[_first++];
 
         /** We check whether we use this node or not. we always use the first node at depth 0 */
         if (_depth > 0 && check(current_node.node) == false)  { return false; }
@@ -113,7 +163,7 @@ bool Frontline::go_next_depth()
             const Node& neighbor = edge.to;
 
             // test if that node hasn't already been explored
-            if (_already_frontlined.find (neighbor.kmer) != _already_frontlined.end())  { continue; }
+            if (_already_frontlined.contains (neighbor.kmer))  { continue; }
 
             // if this bubble contains a marked (branching) kmer, stop everyone at once (to avoid redundancy)
             //if (_terminator.isEnabled() && _terminator.is_branching (neighbor) &&  _terminator.is_marked_branching(neighbor))   // legacy, before MPHFTerminator
@@ -127,17 +177,18 @@ bool Frontline::go_next_depth()
             kmer::Nucleotide from_nt = (current_node.nt == kmer::NUCL_UNKNOWN) ? edge.nt : current_node.nt;
 
             /** We add the new node to the new front line. */
-            new_frontline.push (NodeNt (neighbor, from_nt));
+            new_frontline->push_back (NodeNt (neighbor, from_nt));
 
             /** We memorize the new node. */
             _already_frontlined.insert (neighbor.kmer);
 
             // since this extension is validated, insert into the list of involved ones
-            if (_all_involved_extensions != 0)  {  _all_involved_extensions->insert (neighbor);  }
+            addInvolved (neighbor);
         }
     }
 
     _frontline = new_frontline;
+    _first     = 0;
     ++_depth;
 
     return true;
@@ -179,6 +230,26 @@ FrontlineBranching::FrontlineBranching (
 {
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FrontlineBranching::FrontlineBranching (
+    Direction           direction,
+    const Graph&        graph,
+    Terminator&         terminator,
+    const Node&         startingNode,
+    const Node&         previousNode,
+    FrontlineArena&     arena,
+    std::vector<Node>*  all_involved_extensions
+) : Frontline(direction,graph,terminator,startingNode,previousNode,arena,all_involved_extensions)
+{
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -204,10 +275,11 @@ bool FrontlineBranching::check (const Node& node)
         // only check in-branching from kmers not already frontlined
         // which, for the first extension, includes the previously traversed kmer (previous_kmer)
         // btw due to avance() invariant, previous_kmer is always within a simple path
-        if (_already_frontlined.find (neighbor.kmer) != _already_frontlined.end())  {   continue;  }
+        if (_already_frontlined.contains (neighbor.kmer))  {   continue;  }
 
         // create a new frontline inside this frontline to check for large in-branching (i know, we need to go deeper, etc..)
-        Frontline frontline (_direction, _graph, _terminator, neighbor, actual, _all_involved_extensions);
+        // (its containers are taken from the same arena)
+        Frontline frontline (_direction, _graph, _terminator, neighbor, actual, *_arena, _involved_extensions, _all_involved_extensions);
 
         do  {
             bool should_continue = frontline.go_next_depth();
@@ -260,12 +332,18 @@ FrontlineReachable::FrontlineReachable(
     const Node&       startingNode,
     const Node&       previousNode,
     std::set<Node>*   all_involved_extensions
-)  : Frontline (direction,graph,terminator,startingNode,previousNode,all_involved_extensions)
+)  : Frontline (direction,graph,terminator,startingNode,previousNode,all_involved_extensions), checkLater(_slot.others)
 {
 }
 
-
-
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
 bool FrontlineReachable::check (const Node& node)
 {
 	/** We reverse the node for the inbranching path. */
@@ -278,8 +356,8 @@ bool FrontlineReachable::check (const Node& node)
     {
         /** Shortcut. */
         Node& neighbor = neighbors[i];
-        if (_already_frontlined.find (neighbor.kmer) == _already_frontlined.end())  {
-            checkLater.insert(neighbor);
+        if (_already_frontlined.contains (neighbor.kmer) == false)  {
+            checkLater.push_back(neighbor);
            //return false;   // strict
         }
     }
@@ -288,9 +366,9 @@ bool FrontlineReachable::check (const Node& node)
 
 bool FrontlineReachable::isReachable()
 {
-   for (set<Node>::iterator itNode = checkLater.begin(); itNode != checkLater.end(); itNode++)
+   for (vector<Node>::iterator itNode = checkLater.begin(); itNode != checkLater.end(); itNode++)
    {
-        if (_already_frontlined.find((*itNode).kmer) == _already_frontlined.end())
+        if (_already_frontlined.contains((*itNode).kmer) == false)
             return false;
 
    }
@@ -24,7 +24,7 @@
 
 #include <gatb/debruijn/impl/Terminator.hpp>
 #include <set>
-#include <queue>
+#include <vector>
 
 /********************************************************************************/
 namespace gatb      {
@@ -52,6 +52,152 @@ struct NodeNt
 
 /********************************************************************************/
 
+/** \brief Flat set of kmers
+ *
+ * Open addressing hash table (linear probing) of kmers. Each slot holds a stamp; a slot is
+ * used only if its stamp is the current one, so 'reset' is done in constant time and keeps
+ * the memory for the next use.
+ */
+class NodeValueSet
+{
+public:
+
+    /** Constructor. */
+    NodeValueSet () : _stamp(1), _size(0), _mask(0)  {}
+
+    /** Remove all the kmers of the set, without releasing the memory. */
+    void reset ()
+    {
+        _size = 0;
+        if (++_stamp == 0)  {  _stamps.assign (_stamps.size(), 0);  _stamp = 1;  }
+    }
+
+    /** Get the number of kmers in the set.
+     * \return the number of kmers. */
+    size_t size () const  { return _size; }
+
+    /** Tells whether a kmer is in the set.
+     * \param[in] kmer : the kmer to be looked for
+     * \return true if the kmer is in the set. */
+    bool contains (const Node::Value& kmer) const
+    {
+        if (_stamps.empty())  { return false; }
+
+        for (size_t slot = oahash(kmer) & _mask;  _stamps[slot] == _stamp;  slot = (slot+1) & _mask)
+        {
+            if (_keys[slot] == kmer)  { return true; }
+        }
+        return false;
+    }
+
+    /** Insert a kmer in the set.
+     * \param[in] kmer : the kmer to be inserted
+     * \return true if the kmer was not in the set before the call. */
+    bool insert (const Node::Value& kmer)
+    {
+        /** We keep a load factor <= 0.75 */
+        if ((_size+1)*4 > _stamps.size()*3)  { grow (); }
+
+        size_t slot = oahash(kmer) & _mask;
+        for ( ;  _stamps[slot] == _stamp;  slot = (slot+1) & _mask)
+        {
+            if (_keys[slot] == kmer)  { return false; }
+        }
+
+        _keys  [slot] = kmer;
+        _stamps[slot] = _stamp;
+        _size ++;
+        return true;
+    }
+
+private:
+
+    void grow ()
+    {
+        std::vector<Node::Value> keys;
+        std::vector<u_int32_t>   stamps;
+        keys.swap   (_keys);
+        stamps.swap (_stamps);
+
+        size_t capacity = stamps.empty() ? 64 : 2*stamps.size();
+        _keys.resize   (capacity);
+        _stamps.assign (capacity, 0);
+        _mask = capacity - 1;
+
+        u_int32_t stamp = _stamp;
+        _size  = 0;
+        _stamp = 1;
+
+        for (size_t i=0; i<stamps.size(); i++)  {  if (stamps[i] == stamp)  { insert (keys[i]); }  }
+    }
+
+    std::vector<Node::Value> _keys;
+    std::vector<u_int32_t>   _stamps;
+    u_int32_t                _stamp;
+    size_t                   _size;
+    size_t                   _mask;
+};
+
+/********************************************************************************/
+
+/** \brief Memory used by Frontline objects
+ *
+ * A bubble exploration creates Frontline objects (and nested ones for in-branching checks) for
+ * each branching node. Instead of allocating containers for each of them, a Frontline takes its
+ * containers from an arena when it is built and gives them back when it is destroyed; these
+ * containers are only reset, so their memory is reused by the next Frontline.
+ *
+ * Frontline objects are created and destroyed in a LIFO way, so the arena is a simple stack.
+ * An arena must not be shared by several threads; MonumentTraversal has its own one.
+ */
+class FrontlineArena
+{
+public:
+
+    /** Containers used by one Frontline object. */
+    struct Slot
+    {
+        NodeValueSet        frontlined;
+        std::vector<NodeNt> current;
+        std::vector<NodeNt> next;
+        std::vector<Node>   others;
+    };
+
+    /** Constructor. */
+    FrontlineArena () : _nbUsed(0)  {}
+
+    /** Destructor. */
+    ~FrontlineArena ()  {  for (size_t i=0; i<_slots.size(); i++)  { delete _slots[i]; }  }
+
+    /** Get a slot with empty containers.
+     * \return the slot. */
+    Slot& acquire ()
+    {
+        if (_nbUsed == _slots.size())  { _slots.push_back (new Slot()); }
+
+        Slot& slot = *_slots[_nbUsed++];
+        slot.frontlined.reset();
+        slot.current.clear();
+        slot.next.clear();
+        slot.others.clear();
+        return slot;
+    }
+
+    /** Give back the last acquired slot. */
+    void release ()  { _nbUsed--; }
+
+private:
+
+    std::vector<Slot*> _slots;
+    size_t             _nbUsed;
+
+    /** Not copyable: the arena owns its slots. */
+    FrontlineArena (const FrontlineArena&);
+    FrontlineArena& operator= (const FrontlineArena&);
+};
+
+/********************************************************************************/
+
 // auxiliary class that is used by MonumentTraversal and deblooming
 class Frontline
 {
@@ -75,16 +221,31 @@ public:
         const Node&       startingNode
     );
 
+    /** Constructor with containers taken from an arena.
+     * \param[in] arena : arena providing the containers; it must live longer than the frontline.
+     * \param[in] involved_extensions : if not null, the extensions are appended to it (maybe several times).
+     * \param[in] all_involved_extensions : if not null, the extensions are inserted into it. */
+    Frontline (
+        Direction           direction,
+        const Graph&        graph,
+        Terminator&         terminator,
+        const Node&         startingNode,
+        const Node&         previousNode,
+        FrontlineArena&     arena,
+        std::vector<Node>*  involved_extensions,
+        std::set<Node>*     all_involved_extensions = 0
+    );
+
     /** */
-    virtual ~Frontline() {}
+    virtual ~Frontline();
 
     /** */
     bool go_next_depth();
 
-    size_t size  () const  {  return _frontline.size();  }
-    size_t depth () const  {  return _depth;             }
+    size_t size  () const  {  return _frontline->size() - _first;  }
+    size_t depth () const  {  return _depth;                        }
 
-    NodeNt front () { return _frontline.front(); }
+    NodeNt front () { return (*_frontline)[_first]; }
 
     enum reason
     {
@@ -107,14 +268,33 @@ protected:
 
     Terminator&  _terminator;
 
-    typedef std::queue<NodeNt> queue_nodes;
-    queue_nodes _frontline;
+    /** Arena owned by the frontline when none is provided. */
+    FrontlineArena* _ownArena;
+    FrontlineArena* _arena;
+    FrontlineArena::Slot& _slot;
+
+    /** The nodes of the current depth are the items of '_frontline' from index '_first'. */
+    std::vector<NodeNt>* _frontline;
+    size_t               _first;
 
     int  _depth;
 
-    std::set<Node>* _all_involved_extensions;
+    std::set<Node>*    _all_involved_extensions;
+    std::vector<Node>* _involved_extensions;
+
+    NodeValueSet& _already_frontlined;
+
+    void addInvolved (const Node& node)
+    {
+        if (_all_involved_extensions != 0)  {  _all_involved_extensions->insert (node);  }
+        if (_involved_extensions     != 0)  {  _involved_extensions->push_back  (node);  }
+    }
+
+private:
 
-    std::set<Node::Value> _already_frontlined; // making it simpler now
+    /** Not copyable: the frontline may own its arena and holds a slot of it. */
+    Frontline (const Frontline&);
+    Frontline& operator= (const Frontline&);
 };
 
 /********************************************************************************/
@@ -142,6 +322,17 @@ public:
         const Node&       startingNode
     );
 
+    /** Constructor with containers taken from an arena. */
+    FrontlineBranching (
+        Direction           direction,
+        const Graph&        graph,
+        Terminator&         terminator,
+        const Node&         startingNode,
+        const Node&         previousNode,
+        FrontlineArena&     arena,
+        std::vector<Node>*  all_involved_extensions
+    );
+
 private:
 
     bool check (const Node& node);
@@ -168,7 +359,7 @@ public:
 private:
 
     bool check (const Node& node);
-    std::set<Node> checkLater;
+    std::vector<Node>& checkLater;
 };
 
 
@@ -177,4 +368,3 @@ private:
 /********************************************************************************/
 
 #endif /* _GATB_TOOLS_FRONTLINE_HPP_ */
-
@@ -566,7 +566,8 @@ struct build_visitor_postsolid : public boost::static_visitor<>    {
                 "mphf",
                 solidCounts,
                 solidKmers,
-                true  /* build=true, load=false */
+                true,  /* build=true, load=false */
+                props
             );
             executeAlgorithm (mphf_algo, & graph.getStorage(), props, graph._info);
             data.setAbundance(mphf_algo.getAbundanceMap());
@@ -725,6 +726,8 @@ IOptionsParser* Graph::getOptionsParser (bool includeMandatory, bool enableMphf)
     {
         IOptionsParser* parserEmphf  = new OptionsParser ("emphf");
         parserEmphf->push_back (new tools::misc::impl::OptionOneParam (STR_MPHF_TYPE, "mphf type ('none' or 'emphf')", false,  enableMphf ? "emphf":"none"));
+        parserEmphf->push_back (new tools::misc::impl::OptionOneParam (STR_MPHF_ABUNDANCE_BITS, "number of bits per abundance in the mphf (in [1..8])", false, "8"));
+        parserEmphf->push_back (new tools::misc::impl::OptionNoParam  (STR_MPHF_ABUNDANCE_LOG,  "log scale quantization of the abundances (instead of overflow table)", false));
         parser->push_back  (parserEmphf);
     }
 
@@ -1221,30 +1224,53 @@ struct getItems_visitor : public boost::static_visitor<Graph::Vector<Item> >
     getItems_visitor (const Node& aSource, Direction aDirection, Functor aFct) : source(aSource), direction(aDirection), fct(aFct) {}
 
     template<size_t span>  Graph::Vector<Item> operator() (const GraphData<span>& data) const
+    {
+        Graph::Vector<Item> items;
+
+        /** The neighbors are computed with the kmer size as a constant if it is one of KSIZE_FIXED_LIST. */
+        Neighbors<span> neighbors (*this, data, items);
+        Kmer<span>::applyFixedSize (*data._model, neighbors);
+
+        /** We return the result. */
+        return items;
+    }
+
+    /** Functor called by Kmer<span>::applyFixedSize with the model or a Kmer<span>::FixedSize instance. */
+    template<size_t span>  struct Neighbors
+    {
+        const getItems_visitor& visitor;  const GraphData<span>& data;  Graph::Vector<Item>& items;
+
+        Neighbors (const getItems_visitor& visitor, const GraphData<span>& data, Graph::Vector<Item>& items)
+            : visitor(visitor), data(data), items(items) {}
+
+        template<class Model>  void operator() (const Model& model)  {  visitor.neighbors (data, model, items);  }
+    };
+
+    template<size_t span, class Model>  void neighbors (const GraphData<span>& data, const Model& model, Graph::Vector<Item>& items) const
     {
         /** Shortcut. */
         typedef typename Kmer<span>::Type Type;
 
-        Graph::Vector<Item> items;
-
         size_t idx = 0;
 
         /** We get the specific typed value from the generic typed value. */
         const Type& sourceVal = source.kmer.get<Type>();
 
-        /** Shortcuts. */
-        size_t      kmerSize = data._model->getKmerSize();
-        const Type& mask     = data._model->getKmerMax();
+        /** Shortcut. */
+        size_t      kmerSize = model.getKmerSize();
 
-        /* the kmer we're extending may be actually a revcomp sequence in the bidirected debruijn graph node */
-        Type graine = ((source.strand == STRAND_FORWARD) ?  sourceVal :  revcomp (sourceVal, kmerSize) );
+        /* the kmer we're extending may be actually a revcomp sequence in the bidirected debruijn graph node;
+         * we keep both strands of the source, so the neighbors are rolled from them without computing their revcomp. */
+        Type sourceRev = model.reverse (sourceVal);
+        const Type& graine    = (source.strand == STRAND_FORWARD) ?  sourceVal :  sourceRev;
+        const Type& graineRev = (source.strand == STRAND_FORWARD) ?  sourceRev :  sourceVal;
 
         if (direction & DIR_OUTCOMING)
         {
             for (u_int64_t nt=0; nt<4; nt++)
             {
-                Type forward = ( (graine << 2 )  + nt) & mask;
-                Type reverse = revcomp (forward, kmerSize);
+                Type forward = graine, reverse = graineRev;
+                model.rollRight (forward, reverse, nt);
 
                 if (forward < reverse)
                 {
@@ -1268,8 +1294,8 @@ struct getItems_visitor : public boost::static_visitor<Graph::Vector<Item> >
             /** IMPORTANT !!! Since we have hugely shift the nt value, we make sure to use a long enough integer. */
             for (u_int64_t nt=0; nt<4; nt++)
             {
-                Type forward = ((graine >> 2 )  + ( Type(nt) << ((kmerSize-1)*2)) ) & mask; /* previous kmer */
-                Type reverse = revcomp (forward, kmerSize);
+                Type forward = graine, reverse = graineRev;
+                model.rollLeft (forward, reverse, nt); /* previous kmer */
 
                 Nucleotide NT;
 
@@ -1295,9 +1321,6 @@ struct getItems_visitor : public boost::static_visitor<Graph::Vector<Item> >
 
         /** We update the size of the container according to the number of found items. */
         items.resize (idx);
-
-        /** We return the result. */
-        return items;
     }
 };
 
@@ -1367,26 +1390,30 @@ struct getItemsCouple_visitor : public boost::static_visitor<Graph::Vector<pair<
         Graph::Vector < pair<Item,Item> > items;
 
         /** Shortcuts. */
-        size_t      kmerSize = data._model->getKmerSize();
-        const Type& mask     = data._model->getKmerMax();
+        const typename GraphData<span>::Model& model = *data._model;
 
         /** We get the specific typed value from the generic typed value. */
         const Type& val1 = node1.kmer.get<Type>();
         const Type& val2 = node2.kmer.get<Type>();
 
-        /* the kmer we're extending may be actually a revcomp sequence in the bidirected debruijn graph node */
-        Type graine1 = ((node1.strand == STRAND_FORWARD) ?  val1 :  revcomp (val1, kmerSize) );
-        Type graine2 = ((node2.strand == STRAND_FORWARD) ?  val2 :  revcomp (val2, kmerSize) );
+        /* the kmer we're extending may be actually a revcomp sequence in the bidirected debruijn graph node;
+         * we keep both strands of the sources, so the neighbors are rolled from them without computing their revcomp. */
+        Type rev1 = model.reverse (val1);
+        Type rev2 = model.reverse (val2);
+        const Type& graine1    = (node1.strand == STRAND_FORWARD) ?  val1 :  rev1;
+        const Type& graine2    = (node2.strand == STRAND_FORWARD) ?  val2 :  rev2;
+        const Type& graineRev1 = (node1.strand == STRAND_FORWARD) ?  rev1 :  val1;
+        const Type& graineRev2 = (node2.strand == STRAND_FORWARD) ?  rev2 :  val2;
 
         if (direction & DIR_OUTCOMING)
         {
             for (u_int64_t nt=0; nt<4; nt++)
             {
-                Type forward1 = ( (graine1 << 2 )  + nt) & mask;
-                Type forward2 = ( (graine2 << 2 )  + nt) & mask;
+                Type forward1 = graine1, reverse1 = graineRev1;
+                Type forward2 = graine2, reverse2 = graineRev2;
 
-                Type reverse1 = revcomp (forward1, kmerSize);
-                Type reverse2 = revcomp (forward2, kmerSize);
+                model.rollRight (forward1, reverse1, nt);
+                model.rollRight (forward2, reverse2, nt);
 
                 bool isForwardMin1 = forward1 < reverse1;
                 bool isForwardMin2 = forward2 < reverse2;
@@ -1662,15 +1689,18 @@ struct getItem_visitor : public boost::static_visitor<Item>    {
 
         /** Shortcuts. */
         size_t      kmerSize = data._model->getKmerSize();
-        const Type& mask     = data._model->getKmerMax();
+        const typename GraphData<span>::Model& model = *data._model;
 
-        /* the kmer we're extending may be actually a revcomp sequence in the bidirected debruijn graph node */
-        Type graine = ((source.strand == STRAND_FORWARD) ?  sourceVal :  revcomp (sourceVal, kmerSize) );
+        /* the kmer we're extending may be actually a revcomp sequence in the bidirected debruijn graph node;
+         * we keep both strands of the source, so the neighbors are rolled from them without computing their revcomp. */
+        Type sourceRev = model.reverse (sourceVal);
+        const Type& graine    = (source.strand == STRAND_FORWARD) ?  sourceVal :  sourceRev;
+        const Type& graineRev = (source.strand == STRAND_FORWARD) ?  sourceRev :  sourceVal;
 
         if (direction & DIR_OUTCOMING)
         {
-            Type forward = ( (graine << 2 )  + nt) & mask;
-            Type reverse = revcomp (forward, kmerSize);
+            Type forward = graine, reverse = graineRev;
+            model.rollRight (forward, reverse, nt);
 
             if (forward < reverse)
             {
@@ -1700,8 +1730,8 @@ struct getItem_visitor : public boost::static_visitor<Item>    {
 
         if (direction & DIR_INCOMING)
         {
-            Type forward = ((graine >> 2 )  + ( Type(nt) << ((kmerSize-1)*2)) ) & mask; /* previous kmer */
-            Type reverse = revcomp (forward, kmerSize);
+            Type forward = graine, reverse = graineRev;
+            model.rollLeft (forward, reverse, nt); /* previous kmer */
 
             Nucleotide NT;
 
@@ -1889,84 +1919,87 @@ template<typename NodeType>  struct BranchingFilter
     bool operator () (const NodeType& item) { return graph.isBranching(item); }
 };
 
-template<typename NodeType>
-struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<NodeType>*>
+/** Iterator of nodes built over an iterator of Count objects (ie. a kmer and its abundance).
+ * It is used for iterating the whole solid kmers partition or only one of its collections. */
+template<typename NodeType, typename Count>
+class NodeIterator : public tools::dp::ISmartIterator<NodeType>
 {
-    const Graph& graph;
-    nodes_visitor (const Graph& graph) : graph(graph) {}
+public:
+    NodeIterator (tools::dp::Iterator<Count>* ref, u_int64_t nbItems)
+        : _ref(0),  _rank(0), _isDone(true), _nbItems(nbItems)   {  setRef(ref);  this->_item->strand = STRAND_FORWARD; }
 
-    template<size_t span>  tools::dp::ISmartIterator<NodeType>* operator() (const GraphData<span>& data) const
-    {
-        /** Shortcuts. */
-        typedef typename Kmer<span>::Count Count;
+    ~NodeIterator ()  { setRef(0);   }
 
-        // TODO document that: soo.. we're defining a class inside a function inside a struct (which is a visitor)? -r
-        class NodeIterator : public tools::dp::ISmartIterator<NodeType>
-        {
-        public:
-            NodeIterator (tools::dp::Iterator<Count>* ref, u_int64_t nbItems)
-                : _ref(0),  _rank(0), _isDone(true), _nbItems(nbItems)   {  setRef(ref);  this->_item->strand = STRAND_FORWARD; }
+    u_int64_t rank () const { return _rank; }
 
-            ~NodeIterator ()  { setRef(0);   }
+    /** \copydoc  Iterator::first */
+    void first()
+    {
+        _ref->first();
+        _rank   = 0;
+        _isDone = _ref->isDone();
 
-            u_int64_t rank () const { return _rank; }
+        if (!_isDone)
+        {
+            this->_rank ++;
+            this->_item->kmer      = _ref->item().value;
+            this->_item->abundance = _ref->item().abundance;
+        }
+    }
 
-            /** \copydoc  Iterator::first */
-            void first()
-            {
-                _ref->first();
-                _rank   = 0;
-                _isDone = _ref->isDone();
+    /** \copydoc  Iterator::next */
+    void next()
+    {
+        _ref->next();
+        _isDone = _ref->isDone();
+        if (!_isDone)
+        {
+            this->_rank ++;
+            this->_item->kmer      = _ref->item().value;
+            this->_item->abundance = _ref->item().abundance;
+        }
+    }
 
-                if (!_isDone)
-                {
-                    this->_rank ++;
-                    this->_item->kmer      = _ref->item().value;
-                    this->_item->abundance = _ref->item().abundance;
-                }
-            }
+    /** \copydoc  Iterator::isDone */
+    bool isDone() { return _isDone;  }
 
-            /** \copydoc  Iterator::next */
-            void next()
-            {
-                _ref->next();
-                _isDone = _ref->isDone();
-                if (!_isDone)
-                {
-                    this->_rank ++;
-                    this->_item->kmer      = _ref->item().value;
-                    this->_item->abundance = _ref->item().abundance;
-                }
-            }
+    /** \copydoc  Iterator::item */
+    NodeType& item ()  {  return *(this->_item);  }
 
-            /** \copydoc  Iterator::isDone */
-            bool isDone() { return _isDone;  }
+    /** */
+    void setItem (NodeType& i)
+    {
+        /** We set the node item to be set for the current iterator. */
+        this->_item = &i;
+        this->_item->strand = STRAND_FORWARD;
 
-            /** \copydoc  Iterator::item */
-            NodeType& item ()  {  return *(this->_item);  }
+        /** We set the kmer item to be set for the kmer iterator. */
+        // _ref->setItem (i.kmer.value.get<T>());
+    }
 
-            /** */
-            void setItem (NodeType& i)
-            {
-                /** We set the node item to be set for the current iterator. */
-                this->_item = &i;
-                this->_item->strand = STRAND_FORWARD;
+    /** */
+    u_int64_t size () const { return _nbItems; }
 
-                /** We set the kmer item to be set for the kmer iterator. */
-                // _ref->setItem (i.kmer.value.get<T>());
-            }
+private:
+    tools::dp::Iterator<Count>* _ref;
+    void setRef (tools::dp::Iterator<Count>* ref)  { SP_SETATTR(ref); }
 
-            /** */
-            u_int64_t size () const { return _nbItems; }
+    u_int64_t _rank;
+    bool      _isDone;
+    u_int64_t _nbItems;
+};
 
-        private:
-            tools::dp::Iterator<Count>* _ref;
-            void setRef (tools::dp::Iterator<Count>* ref)  { SP_SETATTR(ref); }
+/********************************************************************************/
+template<typename NodeType>
+struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<NodeType>*>
+{
+    const Graph& graph;
+    nodes_visitor (const Graph& graph) : graph(graph) {}
 
-            u_int64_t _rank;
-            bool      _isDone;
-            u_int64_t _nbItems;
-        };
+    template<size_t span>  tools::dp::ISmartIterator<NodeType>* operator() (const GraphData<span>& data) const
+    {
+        /** Shortcuts. */
+        typedef typename Kmer<span>::Count Count;
 
         // now this is the actual code for returning a node iterator, apparently
 
@@ -1974,7 +2007,7 @@ struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<No
         {
             if (data._solid != 0)
             {
-                return new NodeIterator (data._solid->iterator (), data._solid->getNbItems());
+                return new NodeIterator<NodeType,Count> (data._solid->iterator (), data._solid->getNbItems());
             }
             else
             {
@@ -1986,14 +2019,14 @@ struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<No
             if (data._branching != 0)
             {
                 /** We have a branching container*/
-                return new NodeIterator (data._branching->iterator (), data._branching->getNbItems());
+                return new NodeIterator<NodeType,Count> (data._branching->iterator (), data._branching->getNbItems());
             }
             else if (data._solid != 0)
             {
                 /** We don't have pre-computed branching nodes container. We have to compute them on the fly
                  * from the solid kmers. We can do that by filtering out all non branching nodes. */
                 return new FilterIterator<NodeType,BranchingFilter<NodeType> > (
-                    new NodeIterator (data._solid->iterator (), data._solid->getNbItems()),
+                    new NodeIterator<NodeType,Count> (data._solid->iterator (), data._solid->getNbItems()),
                     BranchingFilter<NodeType> (graph)
                 );
             }
@@ -2032,6 +2065,46 @@ Graph::Iterator<BranchingNode> Graph::getBranchingNodes () const
     return Graph::Iterator<BranchingNode> (boost::apply_visitor (nodes_visitor<BranchingNode>(*this),  *(GraphDataVariant*)_variant));
 }
 
+/********************************************************************************/
+struct nodesPartitioned_visitor : public boost::static_visitor<std::vector<Graph::Iterator<Node> > >
+{
+    template<size_t span>  std::vector<Graph::Iterator<Node> > operator() (const GraphData<span>& data) const
+    {
+        /** Shortcuts. */
+        typedef typename Kmer<span>::Count Count;
+
+        if (data._solid == 0)  { throw system::Exception("Iteration impossible (no solid nodes available)"); }
+
+        std::vector<Graph::Iterator<Node> > result;
+
+        /** We create one node iterator per collection of the solid kmers partition. Each iterator
+         * has its own underlying collection iterator, so they can be used concurrently. */
+        for (size_t i=0; i<data._solid->size(); i++)
+        {
+            Collection<Count>& collection = (*data._solid)[i];
+
+            result.push_back (Graph::Iterator<Node> (
+                new NodeIterator<Node,Count> (collection.iterator(), collection.getNbItems())
+            ));
+        }
+
+        return result;
+    }
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+std::vector<Graph::Iterator<Node> > Graph::getNodesPartitioned () const
+{
+    return boost::apply_visitor (nodesPartitioned_visitor(),  *(GraphDataVariant*)_variant);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -2670,7 +2743,7 @@ struct queryAbundance_visitor : public boost::static_visitor<int>    {
     template<size_t span>  int operator() (const GraphData<span>& data) const
     {
         typedef typename Kmer<span>::Type  Type;
-        unsigned char res = 0;
+        int res = 0;
 
         /** We get the specific typed value from the generic typed value. */
         res = (*(data._abundance))[node.kmer.get<Type>()];
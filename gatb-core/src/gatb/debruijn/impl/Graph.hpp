@@ -558,6 +558,13 @@ public:
     template<typename T>
     Graph::Iterator<T> iterator () const;
 
+    /** Creates one iterator over nodes for each collection of the solid kmers partition.
+     * The union of the iterated items is the same as the one of iterator<Node>, but each
+     * iterator streams its own part of the storage; they are independent and so can be
+     * used by different threads without synchronization (one thread per iterator).
+     * \return the vector of nodes iterators, one per partition. */
+    std::vector<Graph::Iterator<Node> > getNodesPartitioned () const;
+
 
     /**********************************************************************/
     /*                     ALL NEIGHBORS METHODS                          */
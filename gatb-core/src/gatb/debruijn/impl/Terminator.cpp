@@ -52,8 +52,8 @@ BranchingTerminator::BranchingTerminator (const Graph& graph)
         branching_kmers.insert (itBranching.item().kmer);
     }
 
-    /** We finalize the map. We don't sort because branching are already sorted in the graph file. */
-    branching_kmers.finalize (false);
+    /** We finalize the map. */
+    branching_kmers.finalize ();
 }
 
 /*********************************************************************
@@ -125,7 +125,7 @@ void BranchingTerminator::mark (const Edge& edge)
     if (!is_indexed (edge.from))  {   return;  }
 
     Value val=0;
-    branching_kmers.get (edge.from.kmer, val);
+    getValue (edge.from.kmer, val);
 
     int delta = getDelta (edge);
     if (delta >= 0)
@@ -133,7 +133,7 @@ void BranchingTerminator::mark (const Edge& edge)
         // set a 1 at the right NT & strand position
         val |= 1 << (edge.nt + delta);
 
-        branching_kmers.set (edge.from.kmer,val); //was insert for Hash16
+        setValue (edge.from.kmer,val); //was insert for Hash16
     }
 
     assert (is_marked(edge) == true);
@@ -150,7 +150,7 @@ void BranchingTerminator::mark (const Edge& edge)
 bool BranchingTerminator::is_marked (const Edge& edge)  const
 {
     Value val = 0;
-    int is_present = branching_kmers.get (edge.from.kmer, val);
+    int is_present = getValue (edge.from.kmer, val);
 
     if (!is_present)  {   return false;  }
 
@@ -182,8 +182,8 @@ void BranchingTerminator::mark (const Node& node)
     if (is_indexed(node))
     {
         Value val = 0;
-        branching_kmers.get (node.kmer, val);
-        branching_kmers.set (node.kmer, val|(1<<8));
+        getValue (node.kmer, val);
+        setValue (node.kmer, val|(1<<8));
         could_mark = true;
     }
 
@@ -247,7 +247,7 @@ bool BranchingTerminator::is_marked (const Node& node) const
 bool BranchingTerminator::is_marked_branching (const Node& node) const
 {
     Value val = 0;
-    branching_kmers.get (node.kmer, val);
+    getValue (node.kmer, val);
     return (val&(1<<8)) != 0;
 }
 
@@ -290,6 +290,88 @@ void BranchingTerminator::dump ()
 }
 
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+int SpeculativeTerminator::getValue (const Node::Value& kmer, Value& val) const
+{
+    Journal::iterator it = _journal.find (kmer);
+
+    if (it != _journal.end())  {  val = it->second.current;  return 1;  }
+
+    /** We read the reference and record the read value. */
+    int res = _ref.getValue (kmer, val);
+    if (res)  {  _journal.insert (std::make_pair (kmer, Entry(val)));  }
+
+    return res;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+int SpeculativeTerminator::setValue (const Node::Value& kmer, const Value& val)
+{
+    Journal::iterator it = _journal.find (kmer);
+
+    if (it == _journal.end())
+    {
+        Value initial = 0;
+        if (_ref.getValue (kmer, initial) == 0)  { return 0; }
+
+        it = _journal.insert (std::make_pair (kmer, Entry(initial))).first;
+    }
+
+    it->second.current = val;
+    it->second.written = true;
+
+    return 1;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool SpeculativeTerminator::isValid (const Journal& journal) const
+{
+    for (Journal::const_iterator it = journal.begin(); it != journal.end(); ++it)
+    {
+        Value val = 0;
+        _ref.getValue (it->first, val);
+        if (val != it->second.initial)  { return false; }
+    }
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void SpeculativeTerminator::commit (const Journal& journal)
+{
+    for (Journal::const_iterator it = journal.begin(); it != journal.end(); ++it)
+    {
+        if (it->second.written)  {  _ref.setValue (it->first, it->second.current);  }
+    }
+}
+
 /***********************/
 
 bool MPHFTerminator::is_marked (const Node& node) const
@@ -24,6 +24,7 @@
 
 #include <gatb/debruijn/impl/Graph.hpp>
 #include <vector>
+#include <map>
 
 /********************************************************************************/
 namespace gatb      {
@@ -201,72 +202,192 @@ public:
     /** \copydoc Terminator::dump */
     void dump ();
 
+protected:
+
+    /** Get the marks of a branching kmer. All the marks reads go through this method.
+     * \param[in] kmer : the branching kmer
+     * \param[out] val : the marks of the kmer
+     * \return 1 if the kmer is a branching one, 0 otherwise. */
+    virtual int getValue (const Node::Value& kmer, Value& val) const  { return branching_kmers.get (kmer, val); }
+
+    /** Set the marks of a branching kmer. All the marks writes go through this method.
+     * \param[in] kmer : the branching kmer
+     * \param[in] val : the marks of the kmer
+     * \return 1 if the kmer is a branching one, 0 otherwise. */
+    virtual int setValue (const Node::Value& kmer, const Value& val)  { return branching_kmers.set (kmer, val); }
+
+    /** Tells whether a node is a branching one, ie. has marks. */
+    bool is_indexed (const Node& node) const ;
+
 private:
 
-    /* Custom implementation of a map.
+    /* Custom implementation of a map, as an open addressing hash table (linear probing).
+     * Looking for a key needs most of the time only one access in the table, instead of
+     * a binary search in a sorted vector.
+     *
      * IMPORTANT : The keys set is supposed to be built only by one instance and is shared
-     * with other instances through the copy constructor.
+     * with other instances through the copy constructor. Each copy has only its own values
+     * array (one Value per slot), so copies for different threads are cheap.
+     *
+     * The highest bit of a value tells whether the slot is used or not; so a lookup reads
+     * first the (small) values array and compares the keys only for used slots.
      */
     template <typename Key, typename Value>  class AssocSet
     {
     public:
 
-        AssocSet () : isRef(false)  {  keys = new std::vector<Key>();  }
+        AssocSet () : isRef(false), mask(0)  {  keys = new std::vector<Key>();  initial = new std::vector<Value>();  }
 
-        AssocSet (const AssocSet& other) : isRef(true)
+        AssocSet (const AssocSet& other) : keys(other.keys), initial(other.initial), values(*other.initial), isRef(true), mask(other.mask)
         {
-        	keys = other.keys;
-            liste_value.assign(this->keys->size(),0);
         }
 
-        ~AssocSet ()  {  if (isRef==false)  { delete keys; }  }
+        ~AssocSet ()  {  if (isRef==false)  { delete keys;  delete initial; }  }
 
-    	void insert (const Key& elem) { keys->push_back(elem); }
+        /** Insert a key; 'finalize' must be called once all the keys are inserted. */
+        void insert (const Key& elem) { keys->push_back(elem); }
 
-        bool contains(const Key& elem)  const  {  return binary_search(keys->begin(), keys->end(), elem);  }
+        bool contains(const Key& elem)  const  {  return find (elem) != NOT_FOUND;  }
 
         int get (const Key& elem, Value& val) const
         {
-            typename std::vector<Key>::const_iterator it;
-            it = lower_bound(this->keys->begin(), this->keys->end(),elem);
-            if (it == this->keys->end() || elem != *it) return 0;
-            size_t rank = it - this->keys->begin();
-            val = liste_value[rank];
+            size_t slot = find (elem);
+            if (slot == NOT_FOUND)  { return 0; }
+            val = values[slot] & ~USED;
             return 1;
         }
 
         int set (const Key& elem, const Value& val)
         {
-            typename  std::vector<Key>::iterator it;
-            it = lower_bound(this->keys->begin(), this->keys->end(),elem);
-            if (it == this->keys->end() ||elem != *it) return 0;
-            size_t rank = it - this->keys->begin();
-            liste_value[rank]=val;
+            size_t slot = find (elem);
+            if (slot == NOT_FOUND)  { return 0; }
+            values[slot] = val | USED;
             return 1;
         }
 
-        void finalize (bool doSort=true)
+        void finalize ()
         {
-            if (doSort) {  sort(this->keys->begin(), this->keys->end());  }
-            liste_value.assign(this->keys->size(),0);
+            std::vector<Key> items;  items.swap (*keys);
+
+            /** We use a power of 2 for the table size, with a load factor <= 0.75 */
+            size_t capacity = 16;
+            while (capacity*3 < items.size()*4)  { capacity <<= 1; }
+            mask = capacity - 1;
+
+            keys->assign    (capacity, Key());
+            initial->assign (capacity, 0);
+
+            for (typename std::vector<Key>::iterator it = items.begin(); it != items.end(); ++it)
+            {
+                size_t slot = oahash(*it) & mask;
+                while ((*initial)[slot] & USED)  { slot = (slot+1) & mask; }
+
+                (*keys)   [slot] = *it;
+                (*initial)[slot] = USED;
+            }
+
+            values = *initial;
         }
 
-        void clear()  { liste_value.assign(liste_value.size(),0); }
+        void clear()  { values = *initial; }
 
     private:
-        std::vector<Key>*  keys;
-        std::vector<Value> liste_value;
-        bool isRef;
-    };
 
+        static const size_t NOT_FOUND = ~((size_t)0);
+        static const Value  USED      = (Value)1 << (sizeof(Value)*8 - 1);
+
+        size_t find (const Key& elem) const
+        {
+            if (values.empty())  { return NOT_FOUND; }
+
+            for (size_t slot = oahash(elem) & mask;  values[slot] & USED;  slot = (slot+1) & mask)
+            {
+                if ((*keys)[slot] == elem)  { return slot; }
+            }
+            return NOT_FOUND;
+        }
+
+        std::vector<Key>*   keys;
+        std::vector<Value>* initial;
+        std::vector<Value>  values;
+        bool   isRef;
+        size_t mask;
+    };
 
-    bool is_indexed (const Node& node) const ;
 
     AssocSet<Node::Value, Value> branching_kmers;
 
     int getDelta (const Edge& edge) const;
+
+    friend class SpeculativeTerminator;
 };
 
+/********************************************************************************/
+
+/** \brief Journal of marks done on top of a BranchingTerminator.
+ *
+ * This terminator reads the marks of a reference BranchingTerminator, but keeps its own
+ * marks in a journal instead of modifying the reference. It also records the reference marks
+ * that have been read, so one can check later whether the reference has changed in a way that
+ * would have modified the result of a traversal done with this terminator.
+ *
+ * It allows to run traversals in several threads on the same reference (which is only read
+ * during this phase), and then to commit the journals in a chosen order: a journal can be
+ * committed if it is still valid; otherwise the traversal has to be done again.
+ *
+ * Note that the reference must not be modified while other threads are using a
+ * SpeculativeTerminator built on it.
+ */
+class SpeculativeTerminator :  public BranchingTerminator
+{
+public:
+
+    /** Marks of one branching kmer in the journal. */
+    struct Entry
+    {
+        Entry (Value v=0) : initial(v), current(v), written(false)  {}
+        Value initial;
+        Value current;
+        bool  written;
+    };
+
+    /** Journal of the marks read and written, per branching kmer. */
+    typedef std::map<Node::Value,Entry> Journal;
+
+    /** Constructor
+     * \param[in] ref : the terminator holding the reference marks */
+    SpeculativeTerminator (BranchingTerminator& ref) : BranchingTerminator(ref), _ref(ref)  {}
+
+    /** Clear the journal (marks and recorded reads). */
+    void reset ()  { _journal.clear(); }
+
+    /** Get the current journal. It may be swapped with another one for later use.
+     * \return the journal */
+    Journal& getJournal ()  { return _journal; }
+
+    /** Tells whether the reference marks read in a journal are still the same.
+     * \param[in] journal : the journal to be checked
+     * \return true if the journal can be committed. */
+    bool isValid (const Journal& journal) const;
+
+    /** Write the marks of a journal into the reference terminator.
+     * \param[in] journal : the journal to be committed */
+    void commit (const Journal& journal);
+
+protected:
+
+    /** \copydoc BranchingTerminator::getValue */
+    int getValue (const Node::Value& kmer, Value& val) const;
+
+    /** \copydoc BranchingTerminator::setValue */
+    int setValue (const Node::Value& kmer, const Value& val);
+
+private:
+
+    BranchingTerminator& _ref;
+
+    mutable Journal _journal;
+};
 
 /** \brief MPHF implementation of Terminator.
  *
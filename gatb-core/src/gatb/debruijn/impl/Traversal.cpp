@@ -386,38 +386,20 @@ char MonumentTraversal::avance (
 ** REMARKS :
 *********************************************************************/
 bool MonumentTraversal::explore_branching (
-    const Node& node,
+    const Node& startNode,
     Direction dir,
     Path& consensus,
     const Node& previousNode
 )
 {
-    set<Node> all_involved_extensions;
+    /** We reuse the container of the previous bubble. */
+    _involved.clear();
 
-    return explore_branching (node, dir, consensus, previousNode, all_involved_extensions);
-}
-
-/*********************************************************************
-** METHOD  :
-** PURPOSE :
-** INPUT   :
-** OUTPUT  :
-** RETURN  :
-** REMARKS :
-*********************************************************************/
-bool MonumentTraversal::explore_branching (
-    const Node& startNode,
-    Direction dir,
-    Path& consensus,
-    const Node& previousNode,
-    std::set<Node>& all_involved_extensions
-)
-{
     Node endNode;
 
     // find end of branching, record all involved extensions (for future marking)
     // it returns false iff it's a complex bubble
-    int traversal_depth = find_end_of_branching (dir, startNode, endNode, previousNode, all_involved_extensions);
+    int traversal_depth = find_end_of_branching (dir, startNode, endNode, previousNode, _involved);
     if (!traversal_depth)  
     {
         stats.couldnt_find_all_consensuses++;
@@ -426,14 +408,14 @@ bool MonumentTraversal::explore_branching (
 
     // find all consensuses between start node and end node
     bool success;
-    set<Path> consensuses = all_consensuses_between (dir, startNode, endNode, traversal_depth+1, success);
+    all_consensuses_between (dir, startNode, endNode, traversal_depth+1, _consensuses, success);
 
     // if consensus phase failed, stop
     if (!success)  {  return false;  }
 
     consensus.resize (0);
     // validate paths, based on identity
-    bool validated = validate_consensuses (consensuses, consensus);
+    bool validated = validate_consensuses (_consensuses, consensus);
     if (!validated)   
     {  
         stats.couldnt_validate_consensuses++;
@@ -442,11 +424,34 @@ bool MonumentTraversal::explore_branching (
 
     // the consensuses agree, mark all the involved extensions
     // (corresponding to alternative paths we will never traverse again)
-    mark_extensions (all_involved_extensions);
+    mark_extensions (_involved);
 
     return true;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool MonumentTraversal::explore_branching (
+    const Node& startNode,
+    Direction dir,
+    Path& consensus,
+    const Node& previousNode,
+    std::set<Node>& all_involved_extensions
+)
+{
+    bool result = explore_branching (startNode, dir, consensus, previousNode);
+
+    all_involved_extensions.insert (_involved.begin(), _involved.end());
+
+    return result;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -461,11 +466,11 @@ int MonumentTraversal::find_end_of_branching (
     const Node&  startingNode,
     Node&        endNode,
     const Node&  previousNode,
-    std::set<Node>& all_involved_extensions
+    std::vector<Node>& all_involved_extensions
 )
 {
-    /** We need a branching frontline. */
-    FrontlineBranching frontline (dir, graph, terminator, startingNode, previousNode, &all_involved_extensions);
+    /** We need a branching frontline (its containers are taken from our arena). */
+    FrontlineBranching frontline (dir, graph, terminator, startingNode, previousNode, _arena, &all_involved_extensions);
 
     do  {
         bool should_continue = frontline.go_next_depth();
@@ -529,11 +534,11 @@ int MonumentTraversal::find_end_of_branching (
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void MonumentTraversal::mark_extensions (std::set<Node>& extensions_to_mark)
+void MonumentTraversal::mark_extensions (std::vector<Node>& extensions_to_mark)
 {
     if (terminator.isEnabled())
     {
-        for(set<Node>::iterator it = extensions_to_mark.begin(); it != extensions_to_mark.end() ; ++it)
+        for(vector<Node>::iterator it = extensions_to_mark.begin(); it != extensions_to_mark.end() ; ++it)
         {
             terminator.mark (*it);
         }
@@ -548,17 +553,21 @@ void MonumentTraversal::mark_extensions (std::set<Node>& extensions_to_mark)
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-set<Path> MonumentTraversal::all_consensuses_between (
+// REMARKS : 'usedNode' and 'current_consensus' are used as stacks (they are restored before
+// returning), and the paths are appended to 'consensuses'; only the paths appended by this call
+// are taken into account for the max breadth.
+void MonumentTraversal::all_consensuses_between (
     Direction    dir,
     const Node& startNode,
     const Node& endNode,
     int traversal_depth,
-    set<Node::Value> usedNode,
-    Path current_consensus,
+    std::vector<Node::Value>& usedNode,
+    Path& current_consensus,
+    Consensuses& consensuses,
     bool& success
 )
 {
-    set<Path> consensuses;
+    size_t nbConsensusesBefore = consensuses.size();
 
     // find_end_of_branching and all_consensues_between do not always agree on clean bubbles ends
     // until I can fix the problem, here is a fix
@@ -567,13 +576,13 @@ set<Path> MonumentTraversal::all_consensuses_between (
     {
         success = false;
         stats.couldnt_consensus_negative_depth++;
-        return consensuses;
+        return;
     }
 
     if (startNode.kmer == endNode.kmer)// not testing for end_strand anymore because find_end_of_branching doesn't care about strands
     {
-        consensuses.insert(current_consensus);
-        return consensuses;
+        consensuses.push_back (current_consensus);
+        return;
     }
 
     /** We retrieve the neighbors of the provided node. */
@@ -588,45 +597,73 @@ set<Path> MonumentTraversal::all_consensuses_between (
         // don't resolve bubbles containing loops
         // (tandem repeats make things more complicated)
         // that's a job for a gapfiller
-        if (usedNode.find(edge.to.kmer) != usedNode.end())
+        if (std::find (usedNode.begin(), usedNode.end(), edge.to.kmer) != usedNode.end())
         {
             success = false;
             stats.couldnt_consensus_loop++;
-            return consensuses;
+            return;
         }
 
-        // generate extended consensus sequence
-        Path extended_consensus(current_consensus);
-        extended_consensus.push_back (edge.nt);
-
-        // generate list of used kmers (to prevent loops)
-        set<Node::Value> extended_kmers (usedNode);
-        extended_kmers.insert (edge.to.kmer);
+        // generate extended consensus sequence and list of used kmers (to prevent loops)
+        current_consensus.push_back (edge.nt);
+        usedNode.push_back (edge.to.kmer);
 
         // recursive call to all_consensuses_between
-        set<Path> new_consensuses = all_consensuses_between (
+        all_consensuses_between (
             dir,
             edge.to,
             endNode,
             traversal_depth - 1,
-            extended_kmers,
-            extended_consensus,
+            usedNode,
+            current_consensus,
+            consensuses,
             success
         );
 
-        consensuses.insert (new_consensuses.begin(), new_consensuses.end());
+        current_consensus.resize (current_consensus.size() - 1);
+        usedNode.pop_back ();
 
         // mark to stop we end up with too many consensuses
-        if (consensuses.size() > (unsigned int )max_breadth)  {
+        if (consensuses.size() - nbConsensusesBefore > (unsigned int )max_breadth)  {
             stats.couldnt_consensus_amount++;
             success = false;  
         }
 
         // propagate the stop if too many consensuses reached
-        if (success == false)  {   return consensuses;  }
+        if (success == false)  {   return;  }
     }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void MonumentTraversal::all_consensuses_between (
+    Direction    dir,
+    const Node& startNode,
+    const Node& endNode,
+    int traversal_depth,
+    Consensuses& consensuses,
+    bool &success
+)
+{
+    _usedNodes.clear();
+    _usedNodes.push_back (startNode.kmer);
+
+    _currentConsensus.clear();
+    _currentConsensus.start = startNode;
+
+    consensuses.clear();
+    success = true;
+
+    all_consensuses_between (dir, startNode, endNode, traversal_depth, _usedNodes, _currentConsensus, consensuses, success);
 
-    return consensuses;
+    /** We sort the paths, as they would be in a std::set<Path>. */
+    consensuses.sort ();
 }
 
 /*********************************************************************
@@ -645,13 +682,12 @@ set<Path> MonumentTraversal::all_consensuses_between (
     bool &success
 )
 {
-    set<Node::Value> usedNode;
-    usedNode.insert(startNode.kmer);
-    Path current_consensus;
-    current_consensus.start = startNode;
-    success = true;
+    all_consensuses_between (dir, startNode, endNode, traversal_depth, _consensuses, success);
+
+    set<Path> result;
+    for (size_t i=0; i<_consensuses.size(); i++)  {  result.insert (_consensuses[i]);  }
 
-    return all_consensuses_between (dir, startNode, endNode, traversal_depth, usedNode, current_consensus, success);
+    return result;
 }
 
 /*********************************************************************
@@ -663,22 +699,37 @@ set<Path> MonumentTraversal::all_consensuses_between (
 ** REMARKS :
 *********************************************************************/
 bool MonumentTraversal::validate_consensuses (set<Path>& consensuses, Path& result)
+{
+    Consensuses items;
+    for (set<Path>::iterator it = consensuses.begin(); it != consensuses.end(); ++it)  {  items.push_back (*it);  }
+
+    return validate_consensuses (items, result);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool MonumentTraversal::validate_consensuses (Consensuses& consensuses, Path& result)
 {
     bool debug = false;
     // compute mean and stdev of consensuses
     int mean = 0;
     int path_number = 0;
-    for(set<Path>::iterator it = consensuses.begin(); it != consensuses.end() ; ++it)
+    for(size_t i=0; i<consensuses.size(); ++i)
     {
-        //if (debug)  printf("bubble path %d: %s (len=%lu)\n",path_number,(*it).c_str(),(*it).length());
-        mean+=(*it).size();
+        mean+=consensuses[i].size();
         path_number++;
     }
     mean/=consensuses.size();
     double stdev = 0;
-    for(set<Path>::iterator it = consensuses.begin(); it != consensuses.end() ; ++it)
+    for(size_t i=0; i<consensuses.size(); ++i)
     {
-        int consensus_length = (*it).size();
+        int consensus_length = consensuses[i].size();
         stdev += pow(fabs(consensus_length-mean),2);
     }
     stdev = sqrt(stdev/consensuses.size());
@@ -720,7 +771,7 @@ bool MonumentTraversal::validate_consensuses (set<Path>& consensuses, Path& resu
     if (has_mphf)
         chosen_consensus = most_abundant_consensus(consensuses);
     else
-        chosen_consensus = *consensuses.begin();
+        chosen_consensus = consensuses[0];
 
     int result_length = chosen_consensus.size();
     if  (result_length> max_depth) // it can happen that consensus is longer than max_depth, despite that we didn't explore that far (in a messy bubble with branchings inside)
@@ -742,21 +793,18 @@ bool MonumentTraversal::validate_consensuses (set<Path>& consensuses, Path& resu
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-bool MonumentTraversal::all_consensuses_almost_identical (set<Path>& consensuses)
+bool MonumentTraversal::all_consensuses_almost_identical (Consensuses& consensuses)
 {
-    for (set<Path>::iterator it_a = consensuses.begin(); it_a != consensuses.end(); it_a++)
+    for (size_t a=0; a<consensuses.size(); a++)
     {
-        set<Path>::iterator it_b = it_a;
-        advance(it_b,1);
-        while (it_b != consensuses.end())
+        for (size_t b=a+1; b<consensuses.size(); b++)
         {
-            int identity = needleman_wunch(*it_a,*it_b) * 100;
+            int identity = needleman_wunch(consensuses[a],consensuses[b]) * 100;
             if (identity < consensuses_identity)
             {
-                //cout << "couldn't pop bubble due to identity %:" << identity << " over length " << (*it_a).size() << " " << (*it_b).size() << endl;
+                //cout << "couldn't pop bubble due to identity %:" << identity << " over length " << consensuses[a].size() << " " << consensuses[b].size() << endl;
                 return false;
             }
-            advance(it_b,1);
         }
     }
     return true;
@@ -771,7 +819,7 @@ bool MonumentTraversal::all_consensuses_almost_identical (set<Path>& consensuses
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-Path MonumentTraversal::most_abundant_consensus(set<Path>& consensuses)
+Path MonumentTraversal::most_abundant_consensus(Consensuses& consensuses)
 {
     Path res;
     bool debug = false;
@@ -782,10 +830,10 @@ Path MonumentTraversal::most_abundant_consensus(set<Path>& consensuses)
     if (debug)
         cout << endl << "starting to decide which consensus to choose" << endl;
 
-    for (set<Path>::iterator it = consensuses.begin(); it != consensuses.end(); it++)
+    for (size_t c = 0; c < consensuses.size(); c++)
     {
         // iterate over all kmers in consensus and get mean abundance
-        Path p = *it;
+        const Path& p = consensuses[c];
 
         // FIXME: I think that code might be buggy!! (wrong p_str constructed in the bubble.fa example of Minia. see GraphSimplification.cpp for a potential fix)
         
@@ -21,8 +21,11 @@
 #define _GATB_TOOLS_TRAVERSAL_HPP_
 
 #include <gatb/debruijn/impl/Terminator.hpp>
+#include <gatb/debruijn/impl/Frontline.hpp>
 #include <gatb/tools/misc/api/Enums.hpp>
 #include <set>
+#include <vector>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb      {
@@ -268,7 +271,57 @@ private:
 
 /********************************************************************************/
 
+/** \brief Consensus paths of a bubble
+ *
+ * The paths found between the two ends of a bubble are all different (they start from the same
+ * node), so a vector is enough; it is sorted once all the paths are found in order to get the
+ * same order as a std::set<Path>. The Path objects are recycled: 'clear' doesn't release the
+ * memory of the paths, which is reused by the next bubble.
+ */
+class Consensuses
+{
+public:
+
+    /** Constructor. */
+    Consensuses () : _size(0)  {}
+
+    /** Remove all the paths (memory is kept). */
+    void clear ()  { _size = 0; }
+
+    /** Get the number of paths.
+     * \return the number of paths. */
+    size_t size () const  { return _size; }
+
+    /** Append a path.
+     * \param[in] path : the path to be appended. */
+    void push_back (const Path& path)
+    {
+        if (_size < _paths.size())  { _paths[_size] = path;    }
+        else                        { _paths.push_back (path); }
+        _size++;
+    }
+
+    /** Get the ith path.
+     * \param[in] i : index of the path
+     * \return the path. */
+    const Path& operator[] (size_t i) const  { return _paths[i]; }
+
+    /** Sort the paths (same order as std::set<Path>). */
+    void sort ()  { std::sort (_paths.begin(), _paths.begin() + _size); }
+
+private:
+
+    std::vector<Path> _paths;
+    size_t            _size;
+};
+
+/********************************************************************************/
+
 /** \brief Implementation of Traversal that produces contigs.
+ *
+ * The containers used for exploring the bubbles (frontlines, consensuses, involved extensions)
+ * are members of the object and are reset between two bubbles, so a MonumentTraversal object
+ * must not be used by several threads concurrently.
  */
 class MonumentTraversal: public Traversal
 {
@@ -331,27 +384,46 @@ private:
         const Node& startingNode,
         Node& endNode,
         const Node& previousNode,
-        std::set<Node>& all_involved_extensions
+        std::vector<Node>& all_involved_extensions
     );
- 
-    std::set<Path> all_consensuses_between (
+
+    void all_consensuses_between (
         Direction    dir,
         const Node& startNode,
         const Node& endNode,
         int traversal_depth,
-        std::set<Node::Value> usedNode,
-        Path current_consensus,
+        Consensuses& consensuses,
         bool& success
     );
-   
-    bool all_consensuses_almost_identical (std::set<Path>& consensuses);
 
-    void mark_extensions (std::set<Node>& extensions_to_mark);
+    void all_consensuses_between (
+        Direction    dir,
+        const Node& startNode,
+        const Node& endNode,
+        int traversal_depth,
+        std::vector<Node::Value>& usedNode,
+        Path& current_consensus,
+        Consensuses& consensuses,
+        bool& success
+    );
+
+    bool validate_consensuses (Consensuses& consensuses, Path& consensus);
 
-    Path most_abundant_consensus(std::set<Path>& consensuses);
+    bool all_consensuses_almost_identical (Consensuses& consensuses);
+
+    void mark_extensions (std::vector<Node>& extensions_to_mark);
+
+    Path most_abundant_consensus(Consensuses& consensuses);
 
     static const int consensuses_identity = 80; // traversing bubble if paths are all pair-wise identical by 80% 
     //(used to be > 90% in legacy minia) // by legacy minia i mean minia 1 and minia 2 up to the assembly algo rewrite in may 2015
+
+    /** Containers reused from one bubble to another. */
+    FrontlineArena           _arena;
+    std::vector<Node>        _involved;
+    Consensuses              _consensuses;
+    std::vector<Node::Value> _usedNodes;
+    Path                     _currentConsensus;
 };
 
 /********************************************************************************/
@@ -359,4 +431,3 @@ private:
 /********************************************************************************/
 
 #endif /* _GATB_TOOLS_TRAVERSAL_HPP_ */
-
@@ -0,0 +1,347 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/debruijn/impl/UnitigsAlgorithm.hpp>
+#include <gatb/system/impl/System.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+
+// We use the required packages
+using namespace std;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+using namespace gatb::core::bank;
+
+using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::misc::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb  {  namespace core  {   namespace debruijn  {   namespace impl {
+/********************************************************************************/
+
+static const char* progressFormat1 = "Graph: build unitigs                   ";
+static const char* progressFormat2 = "Graph: nb unitigs found : %-9d    ";
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+UnitigsAlgorithm::UnitigsAlgorithm (
+    const Graph&                graph,
+    bank::IBank*                output,
+    size_t                      nb_cores,
+    bool                        withAbundance,
+    tools::misc::IProperties*   options
+)
+    : Algorithm("unitigs", nb_cores, options), _graph (graph), _output(0), _withAbundance(withAbundance),
+      _nbUnitigs(0), _nbNucleotides(0), _nbCircular(0)
+{
+    setOutput (output);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+UnitigsAlgorithm::~UnitigsAlgorithm ()
+{
+    setOutput (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool UnitigsAlgorithm::claim (const Node& node)
+{
+    unsigned long idx  = _graph.nodeMPHFIndex (node);
+    u_int64_t     mask = (u_int64_t)1 << (idx & 63);
+
+    return (__sync_fetch_and_or (&_visited[idx >> 6], mask) & mask) == 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool UnitigsAlgorithm::isVisited (const Node& node) const
+{
+    unsigned long idx = _graph.nodeMPHFIndex (node);
+
+    return (_visited[idx >> 6] & ((u_int64_t)1 << (idx & 63))) != 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : we don't claim the nodes here: only the end nodes are claimed
+**           (by the caller) in order to decide which thread outputs the unitig.
+*********************************************************************/
+void UnitigsAlgorithm::extend (const Node& start, std::vector<Node>& nodes, Path& path)
+{
+    nodes.clear ();
+    path.clear  ();
+
+    nodes.push_back (start);
+    path.start = start;
+
+    Node current = start;
+    Edge edge;
+
+    while (_graph.simplePathAvance (current, DIR_OUTCOMING, edge) == 1)
+    {
+        /** We stop when we are back to the start node (circular unitig or hairpin). */
+        if (edge.to.kmer == start.kmer || edge.to.kmer == current.kmer)  { break; }
+
+        nodes.push_back (edge.to);
+        path.push_back  (edge.nt);
+
+        current = edge.to;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void UnitigsAlgorithm::output (const std::vector<Node>& nodes, const Path& path, Sequence& seq, ISynchronizer* synchro)
+{
+    /** We mark all the nodes of the unitig. */
+    for (size_t i=0; i<nodes.size(); i++)  {  claim (nodes[i]);  }
+
+    /** We compute the total size of the sequence. */
+    size_t length = _graph.getKmerSize() + path.size();
+
+    /** We build the sequence data. */
+    Data& data = seq.getData();
+    data.resize (length);
+
+    string nodeStr = _graph.toString (nodes[0]);
+
+    size_t idx = 0;
+    for (size_t i=0; i<nodeStr.size(); i++)  { data[idx++] = nodeStr[i];     }
+    for (size_t i=0; i<path.size();    i++)  { data[idx++] = path.ascii(i);  }
+
+    /** We get an identifier for the unitig. */
+    u_int64_t id = __sync_fetch_and_add (&_nbUnitigs, 1);
+    __sync_fetch_and_add (&_nbNucleotides, length);
+
+    /** We set the comment of the sequence, with the mean abundance if needed. */
+    if (_withAbundance)
+    {
+        u_int64_t sum = 0;
+        for (size_t i=0; i<nodes.size(); i++)  {  sum += _graph.queryAbundance (nodes[i]);  }
+
+        seq.setComment (Stringify::format ("%ld__len__%ld__abundance__%.2f", id, length, (float)sum / (float)nodes.size()));
+    }
+    else
+    {
+        seq.setComment (Stringify::format ("%ld__len__%ld", id, length));
+    }
+
+    /** We insert the sequence into the output bank. */
+    LocalSynchronizer localsynchro (synchro);
+    _output->insert (seq);
+}
+
+/********************************************************************************/
+
+/* Command that processes partitions of the solid kmers until there is no partition left.
+ * A unitig is started from a node only if this node is an end of the unitig. */
+class UnitigsPartitionCommand : public ICommand, public system::SmartPointer
+{
+public:
+
+    UnitigsPartitionCommand (
+        UnitigsAlgorithm&                    algo,
+        std::vector<Graph::Iterator<Node> >& partitions,
+        size_t&                              nextPartition,
+        ISynchronizer*                       synchro,
+        IteratorListener*                    progress
+    )
+        : _algo(algo), _graph(algo._graph), _partitions(partitions), _nextPartition(nextPartition),
+          _synchro(synchro), _progress(progress, synchro) {}
+
+    void execute ()
+    {
+        std::vector<Node> nodes;
+        Path              path;
+        Sequence          seq (Data::ASCII);
+
+        for (size_t p = __sync_fetch_and_add (&_nextPartition, 1);  p < _partitions.size();  p = __sync_fetch_and_add (&_nextPartition, 1))
+        {
+            Graph::Iterator<Node>& it = _partitions[p];
+
+            u_int64_t nbDone = 0;
+
+            for (it.first(); !it.isDone(); it.next())
+            {
+                process (it.item(), nodes, path, seq);
+
+                if (++nbDone % 10000 == 0)  {  _progress.inc (nbDone);  nbDone = 0;  }
+            }
+
+            _progress.inc (nbDone);
+        }
+    }
+
+private:
+
+    void process (const Node& node, std::vector<Node>& nodes, Path& path, Sequence& seq)
+    {
+        /** Quick check: the node may have already been output as a part of a unitig. */
+        if (_algo.isVisited (node))  { return; }
+
+        Node start;
+
+        /** We look whether the node is an end of its unitig (in one direction or the other). */
+        if      (_graph.simplePathAvance (node, DIR_INCOMING) != 1)  {  start = node;                  }
+        else if (_graph.simplePathAvance (node, DIR_OUTCOMING) != 1) {  start = _graph.reverse (node); }
+        else  { return; }
+
+        /** We try to claim the starting node; failure means that another thread already took this unitig. */
+        if (_algo.claim (start) == false)  { return; }
+
+        _algo.extend (start, nodes, path);
+
+        const Node& last = nodes.back();
+
+        /** The unitig may be started from its other end by another thread. If we can't claim the last node,
+         * both threads extended the unitig and only the one starting from the smallest kmer outputs it. */
+        bool isOwner = _algo.claim (last)  ||  !(last.kmer < start.kmer);
+
+        if (isOwner)  {  _algo.output (nodes, path, seq, _synchro);  }
+    }
+
+    UnitigsAlgorithm&                    _algo;
+    const Graph&                         _graph;
+    std::vector<Graph::Iterator<Node> >& _partitions;
+    size_t&                              _nextPartition;
+    ISynchronizer*                       _synchro;
+    ProgressSynchro                      _progress;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void UnitigsAlgorithm::execute ()
+{
+    if (_graph.checkState (Graph::STATE_MPHF_DONE) == false)
+    {
+        throw system::Exception ("Unitigs computation impossible (graph built without MPHF)");
+    }
+
+    /** We get one iterator per partition of the solid kmers. */
+    std::vector<Graph::Iterator<Node> > partitions = _graph.getNodesPartitioned ();
+
+    u_int64_t nbNodes = 0;
+    for (size_t i=0; i<partitions.size(); i++)  { nbNodes += partitions[i].size(); }
+
+    /** We allocate the bitmap of visited nodes. */
+    _visited.assign ((nbNodes + 63) / 64, 0);
+
+    _nbUnitigs = _nbNucleotides = _nbCircular = 0;
+
+    /** We create a listener for progress information. */
+    IteratorListener* listener = createIteratorListener (nbNodes, progressFormat1);
+    LOCAL (listener);
+
+    ISynchronizer* synchro = System::thread().newSynchronizer();
+    LOCAL (synchro);
+
+    listener->init ();
+
+    /** First pass: the partitions are processed by N threads. */
+    size_t nextPartition = 0;
+
+    vector<ICommand*> cmds;
+    for (size_t i=0; i<getDispatcher()->getExecutionUnitsNumber(); i++)
+    {
+        cmds.push_back (new UnitigsPartitionCommand (*this, partitions, nextPartition, synchro, listener));
+    }
+    getDispatcher()->dispatchCommands (cmds);
+
+    /** Second pass: the remaining nodes belong to circular unitigs (each node has a simple link
+     * in both directions), so we can start from any of them. */
+    std::vector<Node> nodes;
+    Path              path;
+    Sequence          seq (Data::ASCII);
+
+    Graph::Iterator<Node> itNodes = _graph.iterator<Node>();
+    for (itNodes.first(); !itNodes.isDone(); itNodes.next())
+    {
+        if (isVisited (itNodes.item()))  { continue; }
+
+        extend (itNodes.item(), nodes, path);
+        output (nodes, path, seq, synchro);
+
+        _nbCircular ++;
+    }
+
+    /** We flush the output bank. */
+    _output->flush ();
+
+    listener->setMessage (Stringify::format (progressFormat2, _nbUnitigs));
+    listener->finish ();
+
+    /** We gather some statistics. */
+    getInfo()->add (1, "stats");
+    getInfo()->add (2, "nb_unitigs",     "%ld", _nbUnitigs);
+    getInfo()->add (2, "nb_circular",    "%ld", _nbCircular);
+    getInfo()->add (2, "nb_nucleotides", "%ld", _nbNucleotides);
+    getInfo()->add (2, "mean_length",    "%.1f", (_nbUnitigs > 0 ? (float)_nbNucleotides / (float)_nbUnitigs : 0));
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file UnitigsAlgorithm.hpp
+ *  \brief Algorithm that computes the unitigs (ie. compacted de Bruijn graph) of a Graph
+ */
+
+#ifndef _GATB_CORE_DEBRUIJN_IMPL_UNITIGS_ALGORITHM_HPP_
+#define _GATB_CORE_DEBRUIJN_IMPL_UNITIGS_ALGORITHM_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/impl/Algorithm.hpp>
+#include <gatb/debruijn/impl/Graph.hpp>
+#include <gatb/bank/api/IBank.hpp>
+
+#include <vector>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace debruijn  {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Computation of the unitigs of a Graph
+ *
+ * This class implements an algorithm that extracts all the maximal unitigs (ie. maximal
+ * simple paths) of the provided graph. The result is the compacted de Bruijn graph, as a set
+ * of sequences dumped into an output bank (BankFasta or BankBinary for instance).
+ *
+ * The graph must have been built with its MPHF (see Graph::STATE_MPHF_DONE); the MPHF index of
+ * the nodes is used for a bitmap of visited nodes that is shared by all the threads.
+ *
+ * The extraction is done in two passes:
+ *  - each thread takes one partition of the solid kmers (see Graph::getNodesPartitioned) and starts
+ *    a unitig from each node that is an end of a unitig (ie. no simple link in one direction).
+ *    A unitig can be found from its two ends; the end nodes are atomically claimed in the bitmap
+ *    and only one of the two threads outputs the unitig.
+ *  - the nodes not visited after the first pass belong to circular unitigs; they are processed
+ *    in a second (serial) pass.
+ *
+ * The order of the output unitigs depends on the threads scheduling, but the set of unitigs
+ * doesn't.
+ *
+ * Example of use:
+ * \code
+ * BankFasta output ("unitigs.fa");
+ * UnitigsAlgorithm algo (graph, output, 0, true);
+ * algo.execute ();
+ * \endcode
+ */
+class UnitigsAlgorithm : public gatb::core::tools::misc::impl::Algorithm
+{
+public:
+
+    /** Constructor.
+     * \param[in] graph : graph from which we compute the unitigs
+     * \param[in] output : bank where the unitigs will be put
+     * \param[in] nb_cores : number of cores to be used; 0 means all available cores
+     * \param[in] withAbundance : if true, the mean abundance of the nodes of each unitig is put in the sequence comment
+     * \param[in] options : extra options
+     */
+    UnitigsAlgorithm (
+        const Graph&                graph,
+        bank::IBank*                output,
+        size_t                      nb_cores      = 0,
+        bool                        withAbundance = false,
+        tools::misc::IProperties*   options       = 0
+    );
+
+    /** Destructor. */
+    ~UnitigsAlgorithm ();
+
+    /** \copydoc tools::misc::impl::Algorithm::execute */
+    void execute ();
+
+    /** Get the number of unitigs found by the algorithm.
+     * \return the number of unitigs. */
+    u_int64_t getNbUnitigs () const { return _nbUnitigs; }
+
+    /** Get the total number of nucleotides of the unitigs found by the algorithm.
+     * \return the number of nucleotides. */
+    u_int64_t getNbNucleotides () const { return _nbNucleotides; }
+
+private:
+
+    const Graph& _graph;
+
+    bank::IBank* _output;
+    void setOutput (bank::IBank* output)  { SP_SETATTR(output); }
+
+    bool _withAbundance;
+
+    /** Bitmap of visited nodes, indexed by the MPHF index of the nodes. */
+    std::vector<u_int64_t> _visited;
+
+    /** Atomically set the visited bit of a node.
+     * \param[in] node : the node to be claimed
+     * \return true if the node was not visited before this call, false otherwise. */
+    bool claim (const Node& node);
+
+    /** Tells whether a node is visited.
+     * \param[in] node : the node to be checked
+     * \return true if the node is visited. */
+    bool isVisited (const Node& node) const;
+
+    /** Extends a unitig from a node in the outcoming direction. The extension stops when the
+     * next node is not simple or when the start node is reached again (circular unitig).
+     * \param[in] start : first node of the unitig
+     * \param[out] nodes : nodes of the unitig
+     * \param[out] path : nucleotides following the first node of the unitig */
+    void extend (const Node& start, std::vector<Node>& nodes, Path& path);
+
+    /** Marks the nodes of a unitig, builds its sequence and inserts it in the output bank.
+     * \param[in] nodes : nodes of the unitig
+     * \param[in] path : nucleotides following the first node of the unitig
+     * \param[in] seq : sequence object used for building the output sequence
+     * \param[in] synchro : synchronizer for accessing the output bank */
+    void output (const std::vector<Node>& nodes, const Path& path, bank::Sequence& seq, system::ISynchronizer* synchro);
+
+    u_int64_t _nbUnitigs;
+    u_int64_t _nbNucleotides;
+    u_int64_t _nbCircular;
+
+    friend class UnitigsPartitionCommand;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_DEBRUIJN_IMPL_UNITIGS_ALGORITHM_HPP_ */
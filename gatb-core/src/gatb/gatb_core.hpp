@@ -81,6 +81,8 @@
 #include <gatb/debruijn/impl/Frontline.hpp>
 #include <gatb/debruijn/impl/IterativeExtensions.hpp>
 #include <gatb/debruijn/impl/BranchingAlgorithm.hpp>
+#include <gatb/debruijn/impl/UnitigsAlgorithm.hpp>
+#include <gatb/debruijn/impl/ContigsAlgorithm.hpp>
 
 
 #include <gatb/tools/compression/RangeCoder.hpp>
@@ -61,6 +61,7 @@ Properties Configuration::getProperties() const
     result.add (1, "sequence_number",   "%ld", _estimateSeqNb);
     result.add (1, "sequence_volume",   "%ld", _estimateSeqTotalSize / system::MBYTE);
     result.add (1, "kmers_number",      "%ld", _kmersNb);
+    if (_distinctKmersNb > 0)  {  result.add (1, "kmers_number_distinct", "%ld", _distinctKmersNb);  }
     result.add (1, "kmers_volume",      "%ld", _volume);
     result.add (1, "max_disk_space",    "%ld", _max_disk_space);
     result.add (1, "max_memory",        "%ld", _max_memory);
@@ -68,7 +69,7 @@ Properties Configuration::getProperties() const
     result.add (1, "nb_partitions",     "%d",  _nb_partitions);
     result.add (1, "nb_bits_per_kmer",  "%d",  _nb_bits_per_kmer);
     result.add (1, "nb_cores",          "%d",  _nbCores);
-    result.add (1, "minimizer_type",    "%s",  (_minimizerType == 0) ? "lexicographic (kmc2 heuristic)" : "frequency");
+    result.add (1, "minimizer_type",    "%s",  (_minimizerType == 0) ? "lexicographic (kmc2 heuristic)" : (_minimizerType == 1 ? "frequency" : "hashed"));
     result.add (1, "repartition_type",  "%s",  (_repartitionType == 0) ? "unordered" : "ordered");
 
     result.add (1, "nb_cores_per_partition",     "%d",  _nbCores_per_partition);
@@ -47,7 +47,7 @@ public:
       _nbCores(0), _nb_partitions_in_parallel(0), _abundanceUserNb(0),
       _isComputed(false), _nbCores_per_partition(0),
       _estimateSeqNb(0), _estimateSeqTotalSize(0), _estimateSeqMaxSize(0),
-      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
+      _available_space(0), _volume(0), _kmersNb(0), _distinctKmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
 
     /****************************************/
     /**             PROVIDED                */
@@ -85,6 +85,9 @@ public:
     u_int64_t   _volume;
     u_int64_t   _kmersNb;
 
+    /** Estimated number of distinct kmers; 0 if not estimated (not saved with the configuration). */
+    u_int64_t   _distinctKmersNb;
+
     u_int32_t   _nb_passes;
     u_int32_t   _nb_partitions;
 
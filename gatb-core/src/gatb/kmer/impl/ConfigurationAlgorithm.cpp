@@ -22,7 +22,7 @@
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/misc/api/StringsRepository.hpp>
 #include <gatb/tools/misc/impl/Tokenizer.hpp>
-#include <gatb/kmer/impl/LinearCounter.hpp>
+#include <gatb/tools/collections/impl/HyperLogLog.hpp>
 
 #include <cmath>
 
@@ -42,6 +42,9 @@ using namespace gatb::core::bank;
 using namespace gatb::core::kmer;
 using namespace gatb::core::kmer::impl;
 
+using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::dp::impl;
+
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
 
@@ -61,117 +64,53 @@ using namespace gatb::core::tools::misc::impl;
 ** REMARKS :
 *********************************************************************/
 
-// estimated the number of distinct kmers in a dataset
-// wrapper around a Linear Counter. Adapted from Kmergenie code.
-// why not a hyperloglog? it seems that the transition from the 32bit-hash initial implementation to 64bits, and supporting billions of elements, is nontrivial, so i didn't bother
-// probably deserves to be in its own file
+/** Functor estimating the number of distinct kmers of sequences with a HyperLogLog.
+ * Each thread has its own copy of the functor, hence its own estimator, which is merged
+ * into the shared estimator when the copy is destroyed. */
 template<size_t span>
 class EstimateNbDistinctKmers
 {
 public:
 
     /** Shortcut. */
-    typedef typename Kmer<span>::Type  Type;
     typedef typename Kmer<span>::ModelCanonical  ModelCanonical;
-    typedef typename Kmer<span>::ModelDirect     ModelDirect;
-    typedef typename Kmer<span>::template ModelMinimizer <ModelCanonical>   Model;
-    typedef typename Model::Kmer                        KmerType;
-
-    /** */
-    void estimate()
-    {
-        nb_distinct_kmers =(unsigned long)( (float)(linearCounter->count( )) * ((float)nbKmersTotal / (float)nbProcessedKmers)); // dubious linear extrapolation, that's all I got
-
-        abs_error = abs((long)(nb_distinct_kmers-previous_nb_distinct_kmers));
-
-        previous_nb_distinct_kmers = nb_distinct_kmers;
-    }
+    typedef typename ModelCanonical::Kmer        KmerType;
 
     /** */
     void operator() (Sequence& sequence)
     {
         /** We build the kmers from the current sequence. */
-        if (model.build (sequence.getData(), kmers) == false)  {  throw "reached EOF"; return; }
+        if (_model.build (sequence.getData(), _kmers) == false)  {  return;  }
 
         /** We loop over the kmers. */
-        for (size_t i=0; i<kmers.size(); i++)
-        {
-            linearCounter->add((kmers[i].value()));
-
-
-            // heuristics to stop early, i found that it's inaccurate with low coverage (e.g. on dsk/test/FiftyK.fastq)
-            /*
-            if (nbProcessedReads % eval_every_N_reads == 0 )
-            {
-
-                // let's see if the estimation converges..
-                // the following stopping condition will grossly over-estimate the number of distinct kmers
-                // but I expect the correct result to be in the same order of magnitude
-                // and better to overestimate than underestimate (for both dsk and kmergenie)
-                   estimate();
-                   bool debug = true;
-                   if (debug)
-                       printf("linear estimator at %ld kmers, number of distinct kmers estimated now: %ld, abs error: %ld\n",nbProcessedKmers, nb_distinct_kmers, abs_error);
-                   if (abs_error < previous_nb_distinct_kmers/20) // 5% error
-                   {
-                       throw "LinearCounter converged"; // well, "converged" is a big word
-                       return;
-                   }
-                   if (!linearCounter->is_accurate())
-                   {
-                   printf("LinearCounter is inaccurate";
-                   return;
-                   }
-
-            }*/
-
-        }
-        nbProcessedKmers += kmers.size();
-        nbProcessedReads++;
-        //if (nbProcessedReads % 100000 == 0) printf("nb: %ld\n",nbProcessedReads);
-
-        // disabled progress
-        //if (nbCurProgressKmers > 500000)   {  _progress.inc (nbCurProgressKmers);  nbCurProgressKmers = 0;  }
+        for (size_t i=0; i<_kmers.size(); i++)  {  if (_kmers[i].isValid())  { _localEstimator.insert (_kmers[i].value());  }  }
     }
 
-    EstimateNbDistinctKmers (Model& model, u_int32_t max_memory, unsigned long nb_kmers_total, tools::dp::IteratorListener* progress)
-        : model(model),  eval_every_N_reads(10000000),   nbKmersTotal(nb_kmers_total),
-        nbProcessedKmers(0), nbCurProgressKmers(0), previous_nb_distinct_kmers(0), nbProcessedReads(0), abs_error(0)
-        //, _progress  (progress,System::thread().newSynchronizer())
-    {
-        unsigned long size_linearCounter; // (in bits)
-        /* let's set it to just use half of all memory available at most, ok? this isn't very robust for huge dataset, so to be tested*/
-        /* if it's a tiny dataset, let's set it to total number of kmers */
-        size_linearCounter = std::min( nb_kmers_total, (unsigned long) (max_memory*8*1024*1024/2) );
-        linearCounter =  new LinearCounter<span>(size_linearCounter);
-    }
+    /** Constructor. */
+    EstimateNbDistinctKmers (size_t kmerSize, HyperLogLog& estimator, ISynchronizer* synchro)
+        : _model(kmerSize), _estimator(estimator), _synchro(synchro), _localEstimator(estimator.getPrecision()) {}
 
-    unsigned long getEstimation()
+    /** Copy constructor (one copy per thread). */
+    EstimateNbDistinctKmers (const EstimateNbDistinctKmers& f)
+        : _model(f._model), _estimator(f._estimator), _synchro(f._synchro), _localEstimator(f._estimator.getPrecision()) {}
+
+    /** Destructor. */
+    ~EstimateNbDistinctKmers ()
     {
-        estimate();
-        // soo.. if it's not accurate, let's assume we have a hugeload of kmers, and let's be safe, we return the total number of kmers
-        if (!linearCounter->is_accurate())
-        {
-            cout << "Warning: linear counter was not accurate, returning worst-case estimation of number of distinct kmers";
-            return nbKmersTotal;
-        }
-        return nb_distinct_kmers;
+        LocalSynchronizer ls (_synchro);
+        _estimator.merge (_localEstimator);
     }
 
 private:
 
-    /** Local resources. */
-    Model&    model;
-    unsigned long nbProcessedReads, nbProcessedKmers;
-    unsigned long nbCurProgressKmers;
-    unsigned long nbKmersTotal;
-    unsigned long abs_error;
-    vector<KmerType> kmers;
-    LinearCounter<span> *linearCounter;
-    int eval_every_N_reads;
-    unsigned long previous_nb_distinct_kmers, nb_distinct_kmers;
-};
+    ModelCanonical    _model;
+    vector<KmerType>  _kmers;
+
+    HyperLogLog&      _estimator;
+    ISynchronizer*    _synchro;
 
+    HyperLogLog       _localEstimator;
+};
 
 /*********************************************************************
 ** METHOD  :
@@ -329,41 +268,29 @@ void ConfigurationAlgorithm<span>::execute ()
     //printf("_volume  %lli volume_minim %lli _max_disk_space %lli  _nb_passes init %i  \n", _volume,volume_minim,_max_disk_space,_nb_passes);
     size_t max_open_files = System::file().getMaxFilesNumber() / 2;
     u_int64_t volume_per_pass;
-    float est_volume_distinct_ratio;
 
-#if 0
-    /* disabled by default; this was an experiment */
-    if (_flagEstimateNbDistinctKmers)
+    /** On demand, we estimate the number of distinct kmers of the bank with a HyperLogLog.
+     * Note that it is only reported: the partitions hold every kmer occurrence, so the
+     * passes and partitions are computed from the total number of kmers. */
+    if (_input->get(STR_DISTINCT_ESTIMATE) && _input->getInt(STR_DISTINCT_ESTIMATE))
     {
-        /* we estimate the volume of distinct kmers vs total number of kmers.
-         * we store it in the variable "est_volume_distinct_ratio"
-         * to compute it, we need a linear counter, let's call it now */
-
         TIME_INFO (getTimeInfo(), "estimate_distinct_kmers");
-        Iterator<Sequence>* itSeq = _bank->iterator();
-        LOCAL (itSeq);
 
-        //_progress->setMessage (progressFormat0); // not touching progress here anymore
-        Model model (_kmerSize, _minim_size);
-        EstimateNbDistinctKmers<span> estimate_nb_distinct_kmers_function(model, _max_memory, kmersNb, _progress);
+        /** We read the whole bank: the number of distinct kmers of a sample doesn't tell how many
+         * new kmers the other sequences bring, so it can't be extrapolated (a linear extrapolation
+         * counts the kmers of the sample again for each sample-sized part of the bank). */
+        Iterator<Sequence>* it = _bank->iterator();
+        LOCAL (it);
 
-        /** We launch the iteration of the sequences iterator with the created functors. */
-        try {
-            itSeq->iterate (estimate_nb_distinct_kmers_function);
-        }
-        catch (const char* except)
-        {
+        ISynchronizer* synchro = System::thread().newSynchronizer();
+        LOCAL (synchro);
 
-        }
-        _estimatedDistinctKmerNb = estimate_nb_distinct_kmers_function.getEstimation();
-        est_volume_distinct_ratio = (float) _estimatedDistinctKmerNb / (float)kmersNb;
-        //est_volume_distinct_ratio = 1; // for debug
-        /* est_volume_distinct_ratio == 1 mean that we guarantee worst case the memory usage,
-           the value mean that, on average, a k-mer will be seen 'est_volume_distinct_ratio' times */
-        // if wrongly estimated, the error 'OAHash: max rehashes..' can happen
-        printf ("LinearCounter done, estimated %ld number of distinct kmers, ratio to total number of kmers: %.2f\n", (long)_estimatedDistinctKmerNb, est_volume_distinct_ratio);
+        HyperLogLog estimator;
+
+        getDispatcher()->iterate (it, EstimateNbDistinctKmers<span> (_config._kmerSize, estimator, synchro));
+
+        _config._distinctKmersNb = estimator.count();
     }
-#endif
 
     do  {
 
@@ -82,6 +82,22 @@ public:
         return new CountProcessorCutoff (clones);
     }
 
+    /** \copydoc ICountProcessor<span>::finishClones */
+    void finishClones (std::vector<ICountProcessor<span>*>& clones)
+    {
+        /** We notify each histogram processor with the matching histogram processors of the clones. */
+        for (size_t i=0; i<_histogramProcessors.size(); i++)
+        {
+            std::vector<ICountProcessor<span>*> notifyClones;
+            for (size_t j=0; j<clones.size(); j++)
+            {
+                if (CountProcessorCutoff* c = dynamic_cast<CountProcessorCutoff*>(clones[j]))  {  notifyClones.push_back (c->_histogramProcessors[i]);  }
+            }
+
+            _histogramProcessors[i]->finishClones (notifyClones);
+        }
+    }
+
     /** \copydoc ICountProcessor<span>::end */
     void endPass (size_t passId)
     {
@@ -108,10 +108,28 @@ public:
     /** \copydoc ICountProcessor<span>::clone */
     CountProcessorAbstract<span>* clone ()
     {
-        /** We encapsulate the histogram with a cache. */
+        /** We encapsulate the histogram with a cache: each clone counts in its own local histogram. */
         return new CountProcessorHistogram (_group, new gatb::core::tools::misc::impl::HistogramCache (_histogram),  _min_auto_threshold);
     }
 
+    /** \copydoc ICountProcessor<span>::finishClones */
+    void finishClones (std::vector<ICountProcessor<span>*>& clones)
+    {
+        /** We merge the local histograms of the clones into our histogram, here in the main thread,
+         * so the histogram is up to date at the end of the pass. */
+        for (size_t i=0; i<clones.size(); i++)
+        {
+            /** We have to recover type information. */
+            if (CountProcessorHistogram* clone = dynamic_cast<CountProcessorHistogram*> (clones[i]))
+            {
+                if (gatb::core::tools::misc::impl::HistogramCache* cache = dynamic_cast<gatb::core::tools::misc::impl::HistogramCache*> (clone->_histogram))
+                {
+                    cache->flush();
+                }
+            }
+        }
+    }
+
     /********************************************************************/
     /*   METHODS CALLED ON ONE CLONED INSTANCE (in a separate thread).  */
     /********************************************************************/
@@ -21,6 +21,7 @@
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/tools/misc/impl/TimeInfo.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
 
 #include <iostream>
 #include <limits>
@@ -100,6 +101,9 @@ MPHFAlgorithm<span,Abundance_t,NodeState_t>::MPHFAlgorithm (
     setAbundanceMap (new AbundanceMap());
     setNodeStateMap (new NodeStateMap());
 
+    /** We configure the encoding of the abundance values. */
+    configureAbundanceMap ();
+
     /** We gather some statistics. */
     getInfo()->add (1, "enabled", "%d", AbundanceMap::enabled);
 
@@ -185,10 +189,48 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::execute ()
 template<size_t span,typename Abundance_t, typename NodeState_t>
 float MPHFAlgorithm<span,Abundance_t,NodeState_t>::getNbBitsPerKmer () const
 {
-    float nbitsPerKmer = sizeof(Abundance_t)*8 + sizeof(NodeState_t) * 4;
+    float nbitsPerKmer = _abundanceMap->getNbBits() + sizeof(NodeState_t) * 4;
     return nbitsPerKmer;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : in build mode, the encoding comes from the options and is saved
+**           in the group; in load mode, it is read back from the group.
+*********************************************************************/
+template<size_t span,typename Abundance_t, typename NodeState_t>
+void MPHFAlgorithm<span,Abundance_t,NodeState_t>::configureAbundanceMap ()
+{
+    size_t nbBits   = sizeof(Abundance_t)*8;
+    bool   logScale = false;
+
+    if (_buildOrLoad == true)
+    {
+        if (getInput()->get(STR_MPHF_ABUNDANCE_BITS))  {  nbBits   = getInput()->getInt (STR_MPHF_ABUNDANCE_BITS);  }
+        if (getInput()->get(STR_MPHF_ABUNDANCE_LOG))   {  logScale = true;  }
+
+        _group.setProperty ("abundance_bits", Stringify::format ("%d", nbBits));
+        _group.setProperty ("abundance_log",  Stringify::format ("%d", logScale));
+    }
+    else
+    {
+        /** Graphs built before this option existed have no such properties => default values. */
+        int bits = atoi (_group.getProperty ("abundance_bits").c_str());
+        if (bits > 0)  {  nbBits = bits;  }
+
+        logScale = atoi (_group.getProperty ("abundance_log").c_str()) == 1;
+    }
+
+    /** We can't use more bits than the abundance type. */
+    if (nbBits > sizeof(Abundance_t)*8)  {  nbBits = sizeof(Abundance_t)*8;  }
+
+    _abundanceMap->configure (nbBits, MAX_ABUNDANCE, logScale);
+}
+
 /********************************************************************/
 
 template<size_t span,typename Abundance_t,typename NodeState_t>
@@ -243,11 +285,14 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::populate ()
         }
 
         /** We set the abundance of the current kmer. */
-        _abundanceMap->at (h) = abundance;
+        _abundanceMap->set (h, abundance);
 
         nb_iterated ++;
     }
 
+    /** We sort the overflow table of the abundances that don't fit the packed values. */
+    _abundanceMap->flush ();
+
     if (nb_iterated != n && n > 3)
     {
         throw Exception ("ERROR during abundance population: itKmers iterated over %d/%d kmers only", nb_iterated, n);
@@ -265,6 +310,10 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::populate ()
     getInfo()->add (2, "bits_per_key",          "%.3f", (float)(_dataSize*8)/(float)_abundanceMap->size());
     getInfo()->add (2, "prec",                  "%d",   MAX_ABUNDANCE);
     getInfo()->add (2, "nb_abund_above_prec",   "%d",   _nb_abundances_above_precision);
+    getInfo()->add (2, "abundance_bits",        "%d",   _abundanceMap->getNbBits());
+    getInfo()->add (2, "abundance_log",         "%d",   _abundanceMap->isLogScale());
+    getInfo()->add (2, "abundance_overflow",    "%ld",  _abundanceMap->getNbOverflow());
+    getInfo()->add (2, "abundance_mem",         "%ld",  _abundanceMap->getMemorySize());
     getInfo()->add (1, getTimeInfo().getProperties("time"));
 }
 
@@ -290,7 +339,9 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::check ()
         /** We get the current abundance. */
         Abundance_t abundance = (*_abundanceMap)[count.value];
 
-        if (abundance!=count.abundance && abundance<MAX_ABUNDANCE)  {  throw Exception ("ERROR: MPHF isn't injective (abundance population failed)");  }
+        /** Quantized abundances can't be checked for equality. */
+        if (_abundanceMap->isLogScale()==false && abundance!=count.abundance && abundance<MAX_ABUNDANCE)
+        {  throw Exception ("ERROR: MPHF isn't injective (abundance population failed)");  }
 
         nb_iterated ++;
     }
@@ -64,6 +64,12 @@ namespace impl      {
  * in order not to exceed the Abundance_t type capacity (provided as a template of the
  * MPHFAlgorithm class). The maximum value is computed through the std::numeric_limits traits.
  *
+ * The abundances are stored in a bit-packed array (see MapMPHFPacked). By default, each abundance
+ * uses the number of bits of Abundance_t, but fewer bits can be used through the options
+ * STR_MPHF_ABUNDANCE_BITS and STR_MPHF_ABUNDANCE_LOG: either exact values with an overflow side
+ * table for high abundances, or log scale quantized values. This configuration is saved as
+ * properties of the storage group, so a loaded graph uses the same encoding as the built one.
+ *
  * Once the abundance map is built and populated, it is available through the 'getAbundanceMap' method. It may
  * be used for instance by the Graph class in order to get the abundance of any node (ie. kmer)
  * of the de Bruijn graph.
@@ -87,7 +93,7 @@ public:
     static const Abundance_t MAX_ABUNDANCE;
 
     /** We define the type of the hash table of couples [kmer/abundance]. */
-    typedef tools::collections::impl::MapMPHF<Type,Abundance_t>  AbundanceMap;
+    typedef tools::collections::impl::MapMPHFPacked<Type>  AbundanceMap;
     
     /** We define the type of the hash table of couples [kmer/node state]. */
     typedef tools::collections::impl::MapMPHF<Type,NodeState_t>  NodeStateMap;
@@ -156,6 +162,9 @@ private:
     /** Check the content of the map once built. */
     void check ();
 
+    /** Configure the abundance values encoding, from the options (build) or the group (load). */
+    void configureAbundanceMap ();
+
     /** We define a specific Progress class for progress feedback during hash function building.
      * We need a special implementation here because of emphf (we can't modify too much code in
      * emphf, so we have to hack it some stuff here). */
@@ -104,6 +104,7 @@ struct Kmer
     /************************************************************/
 
     /** Forward declarations. */
+    template <class ModelImpl, typename T> class ModelAbstract;
     class ModelDirect;
     class ModelCanonical;
     template<class Model, class Comparator> class ModelMinimizer;
@@ -167,6 +168,7 @@ struct Kmer
         Type _value;
         bool _isValid;
         friend class ModelDirect;
+        template <class ModelImpl, typename T> friend class ModelAbstract;
 
         /** Extract a mmer from a kmer. This is done by using a mask on the kmer.
          * \param[in] mask : mask to be applied to the current kmer
@@ -174,7 +176,7 @@ struct Kmer
          * \param[in] mmer_lut : lookup table of minimizers
          * \return the extracted kmer.
          */
-        KmerDirect extract      (const Type& mask, size_t size, Type * mmer_lut)  {  KmerDirect output;  output.set (this->value() & mask);  return output;  }
+        KmerDirect extract      (const Type& mask, size_t size, Type * mmer_lut)  {  KmerDirect output;  output.set (mmer_lut[this->value().getVal() & mask.getVal()]);  return output;  }
         KmerDirect extractShift (const Type& mask, size_t size, Type * mmer_lut)  {  KmerDirect output = extract(mask,size,mmer_lut);  _value = _value >> 2;  return output;  }
     };
 
@@ -264,6 +266,7 @@ struct Kmer
         bool _isValid;
         void updateChoice () { choice = (table[0] < table[1]) ? 0 : 1; }
         friend class ModelCanonical;
+        template <class ModelImpl, typename T> friend class ModelAbstract;
 
         /** Extract a mmer from a kmer. This is done by using a mask on the kmer.
          * \param[in] mask : mask to be applied to the current kmer
@@ -276,7 +279,7 @@ struct Kmer
 
             KmerCanonical output;
 			
-			output.set(mmer_lut[(this->table[0] & mask).getVal()]); //no need to recomp updateChoice with this
+			output.set(mmer_lut[this->table[0].getVal() & mask.getVal()]); //no need to recomp updateChoice with this
 			//mmer_lut takes care of revcomp and forbidden mmers
 			//output.set (this->table[0] & mask, (this->table[1] >> size) & mask);
             //output.updateChoice();
@@ -412,6 +415,30 @@ struct Kmer
          * \return the reverse complement. */
         Type reverse (const Type& kmer)  const  { return revcomp (kmer, this->_kmerSize); }
 
+        /** Move a kmer and its reverse complement one nucleotide forward: 'nt' is appended to the
+         * forward kmer and its complement is prepended to the reverse complement. This is cheaper than
+         * computing the reverse complement of the new kmer.
+         * \param[in,out] forward : the forward kmer
+         * \param[in,out] reverse : the reverse complement of the forward kmer
+         * \param[in] nt : the appended nucleotide (A=0, C=1, T=2, G=3) */
+        void rollRight (Type& forward, Type& reverse, size_t nt)  const
+        {
+            forward = ( (forward << 2) + nt ) & _kmerMask;
+            reverse = (reverse >> 2) + _revcompTable[nt];
+        }
+
+        /** Move a kmer and its reverse complement one nucleotide backward: 'nt' is prepended to the
+         * forward kmer and its complement is appended to the reverse complement.
+         * \param[in,out] forward : the forward kmer
+         * \param[in,out] reverse : the reverse complement of the forward kmer
+         * \param[in] nt : the prepended nucleotide (A=0, C=1, T=2, G=3) */
+        void rollLeft (Type& forward, Type& reverse, size_t nt)  const
+        {
+            /** _revcompTable holds the complement of a nucleotide at the first position, and the complement of nt is nt^2. */
+            forward = (forward >> 2) + _revcompTable[nt^2];
+            reverse = ( (reverse << 2) + (nt^2) ) & _kmerMask;
+        }
+
         /** Build a kmer from a Data object (ie a sequence of nucleotides), starting at an index in the nucleotides sequence.
          * The result is a pair holding the built kmer and a boolean set to yes if the built kmer has to be understood in
          * the forward sense, false otherwise.
@@ -421,7 +448,11 @@ struct Kmer
          */
         Kmer getKmer (const tools::misc::Data& data, size_t startIndex=0)  const
         {
-            return codeSeed (data.getBuffer(), data.getEncoding(), startIndex);
+            /** The invalid nucleotides of binary data are given by a mask. */
+            const tools::misc::Data::InvalidMask* mask = 0;
+            if (data.getEncoding()==tools::misc::Data::BINARY && data.getInvalidMask().empty()==false)  { mask = &data.getInvalidMask(); }
+
+            return execute<Functor_codeSeed> (data.getEncoding(), Functor_codeSeed(data.getBuffer(), startIndex, mask));
         }
 
         /** Iteration of the kmers from a data object through a functor (so lambda expressions can be used).
@@ -475,11 +506,39 @@ struct Kmer
             kmersBuffer.resize (nbKmers);
 
             /** We fill the vector through a functor. */
-            this->iterate (data, BuildFunctor<Kmer>(kmersBuffer));
+            static_cast<const ModelImpl*>(this)->iterate (data, BuildFunctor<Kmer>(kmersBuffer));
 
             return true;
         }
 
+        /** Build the successive kmers of a block of sequences into a single vector (rather than one vector
+         * per sequence). The kmers of the i-th sequence are kmersBuffer[offsets[i]] to kmersBuffer[offsets[i+1]-1];
+         * a sequence shorter than the kmer size has no kmer.
+         * \param[in] data : the sequences of nucleotides.
+         * \param[out] kmersBuffer : the kmers of all the sequences.
+         * \param[out] offsets : index of the first kmer of each sequence (data.size()+1 items).
+         * \return the number of kmers. */
+        size_t build (const std::vector<tools::misc::Data*>& data, std::vector<Kmer>& kmersBuffer, std::vector<size_t>& offsets)  const
+        {
+            /** We compute the offsets, so the kmers vector is resized only once. */
+            offsets.resize (data.size()+1);
+            offsets[0] = 0;
+            for (size_t i=0; i<data.size(); i++)
+            {
+                size_t length = data[i]->size();
+                offsets[i+1] = offsets[i] + (length >= this->getKmerSize() ? length - this->getKmerSize() + 1 : 0);
+            }
+
+            kmersBuffer.resize (offsets.back());
+
+            for (size_t i=0; i<data.size(); i++)
+            {
+                if (offsets[i+1] > offsets[i])  {  static_cast<const ModelImpl*>(this)->iterate (*data[i], BuildFunctor<Kmer>(kmersBuffer, offsets[i]));  }
+            }
+
+            return offsets.back();
+        }
+
         /** Iterate the neighbors of a given kmer; these neighbors are:
          *  - 4 outgoing neighbors (with nt A,C,T,G)
          *  - 4 incoming neighbors (with nt A,C,T,G)
@@ -491,9 +550,12 @@ struct Kmer
         template<typename Functor>
         void iterateNeighbors (const Type& source, const Functor& fct, const std::bitset<8>& mask = 0xFF)  const
         {
+            /** The reverse complement of the source is computed once for the 8 neighbors. */
+            Type sourceRev = reverse (source);
+
             // hacky to cast Functor& instead of const Functor&, but don't wanna break API yet want non-const functor
-            iterateOutgoingNeighbors(source, (Functor&) fct, std::bitset<4> ( (mask.to_ulong() >> 0) & 15));
-            iterateIncomingNeighbors(source, (Functor&) fct, std::bitset<4> ( (mask.to_ulong() >> 4) & 15));
+            iterateOutgoingNeighbors(source, sourceRev, (Functor&) fct, std::bitset<4> ( (mask.to_ulong() >> 0) & 15));
+            iterateIncomingNeighbors(source, sourceRev, (Functor&) fct, std::bitset<4> ( (mask.to_ulong() >> 4) & 15));
         }
 
         /** Iterate the neighbors of a given kmer; these neighbors are:
@@ -505,14 +567,27 @@ struct Kmer
          */
         template<typename Functor>
         void iterateOutgoingNeighbors (const Type& source, Functor& fct, const std::bitset<4>& mask = 0x0F)  const
+        {
+            iterateOutgoingNeighbors (source, reverse (source), fct, mask);
+        }
+
+        /** Same as iterateOutgoingNeighbors, when the reverse complement of the source kmer is already known;
+         * the neighbors and their reverse complements are then computed by rolling the couple.
+         *  \param[in] source : the kmer from which we want neighbors.
+         *  \param[in] sourceRev : the reverse complement of the source kmer.
+         *  \param[in] fct : a functor called for each neighbor.
+         *  \param[in] mask : mask of the neighbors to be used
+         */
+        template<typename Functor>
+        void iterateOutgoingNeighbors (const Type& source, const Type& sourceRev, Functor& fct, const std::bitset<4>& mask = 0x0F)  const
         {
             /** We compute the 4 possible neighbors. */
             for (size_t nt=0; nt<4; nt++)
             {
                 if (mask[nt] == true)
                 {
-                    Type next1 = (((source) * 4 )  + nt) & getKmerMax();
-                    Type next2 = revcomp (next1, getKmerSize());
+                    Type next1 = source, next2 = sourceRev;
+                    rollRight (next1, next2, nt);
                     fct (std::min (next1, next2));
                 }
             }
@@ -528,8 +603,18 @@ struct Kmer
         template<typename Functor>
         void iterateIncomingNeighbors (const Type& source, Functor& fct, const std::bitset<4>& mask = 0x0F)  const
         {
-            Type rev = core::tools::math::revcomp (source, getKmerSize());
+            iterateIncomingNeighbors (source, reverse (source), fct, mask);
+        }
 
+        /** Same as iterateIncomingNeighbors, when the reverse complement of the source kmer is already known.
+         *  \param[in] source : the kmer from which we want neighbors.
+         *  \param[in] sourceRev : the reverse complement of the source kmer.
+         *  \param[in] fct : a functor called for each neighbor.
+         *  \param[in] mask : mask of the neighbors to be used
+         */
+        template<typename Functor>
+        void iterateIncomingNeighbors (const Type& source, const Type& sourceRev, Functor& fct, const std::bitset<4>& mask = 0x0F)  const
+        {
             /** We compute the 4 possible neighbors. */
             for (size_t nt=0; nt<4; nt++)
             {
@@ -540,8 +625,8 @@ struct Kmer
 
                 if (mask[nt] == true)
                 {
-                    Type next1 = (((rev) * 4 )  + (nt^2)) & getKmerMax();
-                    Type next2 = revcomp (next1, getKmerSize());
+                    Type next1 = sourceRev, next2 = source;
+                    rollRight (next1, next2, nt^2);
                     fct (std::min (next1, next2));
                 }
             }
@@ -646,11 +731,24 @@ struct Kmer
             typedef typename ModelImpl::Kmer Result;
             const char* buffer;
             size_t startIndex;
-            Functor_codeSeed (const char* buffer, size_t startIndex) : buffer(buffer), startIndex(startIndex) {}
+            const tools::misc::Data::InvalidMask* mask;
+            Functor_codeSeed (const char* buffer, size_t startIndex, const tools::misc::Data::InvalidMask* mask=0)
+                : buffer(buffer), startIndex(startIndex), mask(mask) {}
             template<class Convert>  Result operator() (const ModelAbstract* model)
             {
                 Result result;
                 static_cast<const ModelImpl*>(model)->template first <Convert> (buffer, result, startIndex);
+
+                /** The kmer is invalid if one of the masked runs overlaps it. */
+                if (mask != 0)
+                {
+                    size_t endIndex = startIndex + model->getKmerSize();
+                    for (size_t run=0; run+1<mask->size(); run+=2)
+                    {
+                        if ((*mask)[run] >= endIndex)  { break; }
+                        if ((size_t)(*mask)[run] + (*mask)[run+1] > startIndex)  {  result._isValid = false;  break;  }
+                    }
+                }
                 return result;
             }
         };
@@ -679,19 +777,63 @@ struct Kmer
             Functor_iterate (tools::misc::Data& data, Callback callback) : data(data), callback(callback) {}
             template<class Convert>  Result operator() (const ModelAbstract* model)
             {
-                return static_cast<const ModelImpl*>(model)->template iterate<Callback, Convert> (data.getBuffer(), data.size(), callback);
+                /** The invalid nucleotides of binary data are given by a mask. */
+                const tools::misc::Data::InvalidMask* mask = 0;
+                if (data.getEncoding()==tools::misc::Data::BINARY && data.getInvalidMask().empty()==false)  { mask = &data.getInvalidMask(); }
+
+                return static_cast<const ModelImpl*>(model)->template iterate<Callback, Convert> (data.getBuffer(), data.size(), callback, mask);
             }
         };
 
+        /* Cursor on a mask of invalid nucleotides, queried with increasing positions. */
+        struct InvalidMaskCursor
+        {
+            InvalidMaskCursor (const tools::misc::Data::InvalidMask* mask) : mask(mask), run(0), begin(~0), end(~0)  {  update();  }
+
+            /* Tells whether the nucleotide at the given position is invalid. */
+            bool operator() (size_t idx)
+            {
+                while (idx >= end)  { run += 2;  update(); }
+                return idx >= begin;
+            }
+
+            void update ()
+            {
+                if (mask != 0 && run+1 < mask->size())  {  begin = (*mask)[run];  end = begin + (*mask)[run+1];  }
+                else                                    {  begin = end = ~0;  }
+            }
+
+            const tools::misc::Data::InvalidMask* mask;
+            size_t run;
+            size_t begin;
+            size_t end;
+        };
+
         /** Template method that iterates the kmer of a given sequence (provided as a buffer and its length).
          *  Note : we use static polymorphism here (http://en.wikipedia.org/wiki/Template_metaprogramming)
          *  \param[in] seq : the sequence to be iterated
          *  \param[in] length : length of the sequence
          *  \param[in] callback : functor called on each found kmer in the sequence
+         *  \param[in] mask : invalid nucleotides in addition to the ones found by the Convert class (may be null)
          *  \return true if kmers have been found, false otherwise.
          */
         template<typename Callback, typename Convert>
-        bool iterate (const char* seq, size_t length, Callback callback) const
+        bool iterate (const char* seq, size_t length, Callback callback, const tools::misc::Data::InvalidMask* mask=0) const
+        {
+            return iterate<Callback, Convert> (*static_cast<const ModelImpl*>(this), seq, length, callback, mask);
+        }
+
+        /** Same as above, the kmers being computed by the 'first' and 'next' methods of the provided
+         *  instance instead of the ones of the model.
+         *  \param[in] step : computes the kmers, the same way as the model does
+         *  \param[in] seq : the sequence to be iterated
+         *  \param[in] length : length of the sequence
+         *  \param[in] callback : functor called on each found kmer in the sequence
+         *  \param[in] mask : invalid nucleotides in addition to the ones found by the Convert class (may be null)
+         *  \return true if kmers have been found, false otherwise.
+         */
+        template<typename Callback, typename Convert, typename Step>
+        bool iterate (const Step& step, const char* seq, size_t length, Callback callback, const tools::misc::Data::InvalidMask* mask) const
         {
             /** We compute the number of kmers for the provided data. Note that we have to check that we have
              * enough nucleotides according to the current kmer size. */
@@ -699,10 +841,18 @@ struct Kmer
             if (nbKmers <= 0)  { return false; }
 
             /** We create a result instance. */
-            typename ModelImpl::Kmer result;
+            typename Step::Kmer result;
 
             /** We compute the initial seed from the provided buffer. */
-            int indexBadChar = static_cast<const ModelImpl*>(this)->template first<Convert> (seq, result, 0);
+            int indexBadChar = step.template first<Convert> (seq, result, 0);
+
+            /** We take into account the invalid nucleotides of the mask for the first kmer. */
+            InvalidMaskCursor isMasked (mask);
+            if (mask != 0)
+            {
+                for (size_t idx=0; idx<_kmerSize; idx++)  {  if (isMasked(idx))  { indexBadChar = std::max (indexBadChar, (int)idx); }  }
+                if (indexBadChar >= 0)  {  result._isValid = false;  }
+            }
 
             /** We need to keep track of the computed kmers. */
             size_t idxComputed = 0;
@@ -713,25 +863,41 @@ struct Kmer
             /** We compute the following kmers from the first one.
              * We have consumed 'kmerSize' nucleotides so far for computing the first kmer,
              * so we start the loop with idx=_kmerSize.
+             * The nucleotides are converted by chunks (see Data::convert), which lets the conversion
+             * work on several nucleotides at once and keeps it out of the kmers loop.
              */
-            for (size_t idx=_kmerSize; idx<length; idx++)
+            u_int8_t codes[CONVERT_CHUNK_SIZE];
+
+            for (size_t chunk=_kmerSize; chunk<length; chunk+=CONVERT_CHUNK_SIZE)
             {
-                /** We get the current nucleotide. */
-                ConvertChar c = Convert::get (seq, idx);
+                size_t nb = std::min (length-chunk, (size_t)CONVERT_CHUNK_SIZE);
 
-                if (c.second)  { indexBadChar = _kmerSize-1; }
-                else           { indexBadChar--;     }
+                tools::misc::Data::template convert<Convert> (seq, chunk, nb, codes);
 
-                /** We compute the next kmer from the previous one. */
-                static_cast<const ModelImpl*>(this)->template next<Convert> (c.first, result, indexBadChar<0);
+                if (mask != 0)  {  for (size_t i=0; i<nb; i++)  {  if (isMasked(chunk+i))  { codes[i] |= 4; }  }  }
 
-                /** We notify the result. */
-                this->notification<Callback> (result, ++idxComputed, callback);
+                for (size_t i=0; i<nb; i++)
+                {
+                    /** We get the current nucleotide. */
+                    u_int8_t c = codes[i];
+
+                    if (c & 4)  { indexBadChar = _kmerSize-1; }
+                    else        { indexBadChar--;     }
+
+                    /** We compute the next kmer from the previous one. */
+                    step.template next<Convert> (c & 3, result, indexBadChar<0);
+
+                    /** We notify the result. */
+                    this->notification<Callback> (result, ++idxComputed, callback);
+                }
             }
 
             return true;
         }
 
+        /* Number of nucleotides converted at once by 'iterate'. */
+        static const size_t CONVERT_CHUNK_SIZE = 256;
+
         template <class Callcack>
         void  notification (const Kmer& value, size_t idx, Callcack callback) const {  callback (value, idx);  }
 
@@ -740,8 +906,9 @@ struct Kmer
         struct BuildFunctor
         {
             std::vector<Type>& kmersBuffer;
-            BuildFunctor (std::vector<Type>& kmersBuffer) : kmersBuffer(kmersBuffer) {}
-            void operator() (const Type& kmer, size_t idx)  {  kmersBuffer[idx] = kmer;  }
+            size_t offset;
+            BuildFunctor (std::vector<Type>& kmersBuffer, size_t offset=0) : kmersBuffer(kmersBuffer), offset(offset) {}
+            void operator() (const Type& kmer, size_t idx)  {  kmersBuffer[offset+idx] = kmer;  }
         };
 		
     };
@@ -844,8 +1011,7 @@ struct Kmer
         template <class Convert>
         void  next (char c, Kmer& value, bool isValid)   const
         {
-            value.table[0] = ( (value.table[0] << 2) +  c                          ) & this->_kmerMask;
-            value.table[1] = ( (value.table[1] >> 2) +  this->_revcompTable[(int)c]) & this->_kmerMask;
+            this->rollRight (value.table[0], value.table[1], c);
             value._isValid = isValid;
 
             value.updateChoice();
@@ -945,12 +1111,17 @@ struct Kmer
             _mask  = ((u_int64_t)1 << (2*_minimizerSize)) - 1;
             _shift = 2*(_nbMinimizers-1);
 
+            /** We need a mask for finding forbidden mmers (see is_allowed; every mmer is allowed in freq order). */
+            _maskAllowed = (_minimizerSize < 2 || freq_order != NULL) ? 0 : 0x5555555555555555 & (((u_int64_t)1 << (2*(_minimizerSize-2))) - 1);
+
             /** We initialize the default value of the minimizer.
              * The value is actually set by the Comparator instance provided as a template of the class. */
             Type tmp;
             _cmp.template init<ModelType> (getMmersModel(), tmp);
             _minimizerDefault.set (tmp);
 			
+            _isCanonical = dynamic_cast<ModelCanonical*>(&_kmerModel) != NULL;
+
 			u_int64_t nbminims_total = ((u_int64_t)1 << (2*_minimizerSize));
 			_mmer_lut = (Type *) MALLOC(sizeof(Type) * nbminims_total ); //free that in destructor
 
@@ -962,8 +1133,7 @@ struct Kmer
                 // if(!is_allowed(rev_mmer.getVal(),minimizerSize)) rev_mmer = _mask;
 
                 /* if it's ModelDirect, don't do a revcomp */
-                ModelCanonical* isModelCanonical = dynamic_cast<ModelCanonical*>(&_kmerModel);
-                if ( isModelCanonical != NULL)
+                if (_isCanonical)
                 {
     				Type rev_mmer = revcomp(mmer, minimizerSize);
     				if(rev_mmer < mmer) mmer = rev_mmer;
@@ -975,6 +1145,9 @@ struct Kmer
 				_mmer_lut[ii] = mmer;
 			}
 
+            /** The sliding window is used only when the lookup table is too big for the cache. */
+            _useWindow = nbminims_total * sizeof(Type) >= WINDOW_MIN_LUT_SIZE;
+
             if (freq_order)
                 setMinimizersFrequency(freq_order);
         }
@@ -1048,6 +1221,30 @@ struct Kmer
             }
         }
 
+        /* The 'iterate' methods of the parent class remain available. */
+        using ModelAbstract <ModelMinimizer<ModelType,Comparator>, Kmer>::iterate;
+
+        /** Iterates the kmers of a data object with their minimizers. When the lookup table of the mmers is too
+         * big for the cache, the kmers are computed by the kmer model while the minimizers are maintained by a
+         * sliding window on the mmers of the sequence (see MinimizerWindow), so the mmers of a kmer are not
+         * extracted again when its minimizer gets out of it. Otherwise, 'next' is faster and the parent method
+         * is used. The choice is made once per data object, out of the encoding switch, so the kmers loop of
+         * the default configuration is the one of the parent class.
+         * \param[in] data : the sequence of nucleotides as a Data object.
+         * \param[in] callback  : functor that handles one kmer
+         * \return true if kmers have been found, false otherwise.
+         */
+        template<typename Callback>
+        bool iterate (tools::misc::Data& data, Callback callback) const
+        {
+            if (_useWindow)
+            {
+                return this->template execute<Functor_iterateWindow<Callback> > (data.getEncoding(), Functor_iterateWindow<Callback>(data,callback));
+            }
+
+            return ModelAbstract <ModelMinimizer<ModelType,Comparator>, Kmer>::iterate (data, callback);
+        }
+
         /** Get the minimizer value of the provided kmer. Note that minimizers are supposed to be
          * of small sizes, so their values can fit a u_int64_t type.
          * \return the miminizer value as an integer. */
@@ -1100,6 +1297,7 @@ struct Kmer
 
         void setMinimizersFrequency (uint32_t *freq_order)
         {
+            _freq_order = freq_order;
             _cmp.include_frequency(freq_order);
         }
 
@@ -1122,10 +1320,146 @@ struct Kmer
 
 		Type * _mmer_lut;
         size_t     _shift;
+        bool       _isCanonical;
+        bool       _useWindow;
+        u_int64_t  _maskAllowed;
         typename ModelType::Kmer _minimizerDefault;
 
         uint32_t *_freq_order;
 
+        /* Size (in bytes) of the mmers lookup table from which the sliding window is used by 'iterate'. */
+        static const u_int64_t WINDOW_MIN_LUT_SIZE = 1 << 23;
+
+        /* Sliding window on the mmers of the iterated kmers. It keeps in a ring the values of the mmers
+         * of the current kmer (ie. after the lookup table), so the minimizer of a kmer can be found again
+         * without extracting its mmers when the previous minimizer gets out of the window. */
+        struct MinimizerWindow
+        {
+            Type   values[span];
+            size_t last;
+        };
+
+        /* Adaptor between the 'execute' method and the 'iterate' method with a sliding window. */
+        template<class Callback>
+        struct Functor_iterateWindow
+        {
+            typedef bool Result;
+            tools::misc::Data& data; Callback callback;
+            Functor_iterateWindow (tools::misc::Data& data, Callback callback) : data(data), callback(callback) {}
+            template<class Convert>  Result operator() (const ModelAbstract <ModelMinimizer<ModelType,Comparator>, Kmer>* model)
+            {
+                /** The invalid nucleotides of binary data are given by a mask. */
+                const tools::misc::Data::InvalidMask* mask = 0;
+                if (data.getEncoding()==tools::misc::Data::BINARY && data.getInvalidMask().empty()==false)  { mask = &data.getInvalidMask(); }
+
+                const ModelMinimizer& self = *static_cast<const ModelMinimizer*>(model);
+                MinimizerWindow window;
+                return self.template iterate<Callback, Convert> (WindowStep (self, window), data.getBuffer(), data.size(), callback, mask);
+            }
+        };
+
+        /* Computes the kmers with the kmer model and their minimizers with the window; used by 'iterate'
+         * instead of the 'first' and 'next' methods of the model. */
+        struct WindowStep
+        {
+            typedef KmerMinimizer<ModelType,Comparator> Kmer;
+            const ModelMinimizer& model;  MinimizerWindow& window;
+            WindowStep (const ModelMinimizer& model, MinimizerWindow& window) : model(model), window(window) {}
+
+            template <class Convert>
+            int first (const char* seq, Kmer& kmer, size_t startIndex) const
+            {
+                int result = model._kmerModel.template first<Convert> (seq, kmer, startIndex);
+                model.fill (window, kmer);
+                return result;
+            }
+
+            template <class Convert>
+            void next (char c, Kmer& kmer, bool isValid) const
+            {
+                model._kmerModel.template next<Convert> (c, kmer, isValid);
+                model.slide (window, kmer);
+            }
+        };
+
+        /** Computes the minimizer of a kmer from the minimizer of the previous one, the same way as the 'next' method does. */
+        void slide (MinimizerWindow& window, Kmer& kmer) const
+        {
+            /** The new mmer is the most right one; it replaces the most left mmer of the previous kmer in the ring. */
+            Type mmer = lookup (kmer.value(0).getVal() & _mask.getVal());
+            if (++window.last == _nbMinimizers)  { window.last = 0; }
+            window.values[window.last] = mmer;
+
+            kmer._position--;
+            kmer._changed = false;
+
+            if (_cmp (mmer, kmer._minimizer.value()) == true)
+            {
+                kmer._minimizer.set (mmer);
+                kmer._position = _nbMinimizers - 1;
+                kmer._changed  = true;
+            }
+            else if (kmer._position < 0)
+            {
+                computeNewMinimizer (window, kmer);
+            }
+        }
+
+        /** Returns the same value as _mmer_lut[mmer], but without a memory access: the lookup table
+         * hardly fits the cache (4^m entries), whereas a mmer revcomp is a few operations. */
+        Type lookup (u_int64_t mmer) const
+        {
+            if (_isCanonical)
+            {
+                u_int64_t rev = tools::math::NativeInt64::revcomp64 (mmer, _minimizerSize);
+                mmer = rev < mmer ? rev : mmer;
+            }
+
+            /** Same check as 'is_allowed' (no AA except at the beginning of the mmer); a forbidden
+             * mmer is replaced by the mask. No branch here, the check is hard to predict. */
+            u_int64_t a1 = ~(mmer | (mmer >> 2));
+            a1 = ((a1 >> 1) & a1) & _maskAllowed;
+
+            return mmer | (-(u_int64_t)(a1 != 0) & _mask.getVal());
+        }
+
+        /** Fills the window with the mmers of the first kmer, from left to right. */
+        void fill (MinimizerWindow& window, Kmer& kmer) const
+        {
+            Type val = kmer.value(0);
+            for (size_t i=0; i<_nbMinimizers; i++)
+            {
+                window.values[i] = lookup ((val >> (2*(_nbMinimizers-1-i))).getVal() & _mask.getVal());
+            }
+            window.last = _nbMinimizers-1;
+
+            computeNewMinimizer (window, kmer);
+        }
+
+        /** Returns the minimizer of the mmers of the window; same result as 'computeNewMinimizerOriginal'. */
+        void computeNewMinimizer (const MinimizerWindow& window, Kmer& kmer) const
+        {
+            kmer._minimizer = this->_minimizerDefault;
+            kmer._position  = -1;
+            kmer._changed   = true;
+
+            Type    best     = kmer._minimizer.value();
+            int16_t position = -1;
+
+            /** We look at the mmers from right to left, as 'computeNewMinimizerOriginal' does. */
+            size_t slot = window.last;
+            for (int16_t idx=_nbMinimizers-1; idx>=0; idx--)
+            {
+                /* no branch here, the result of the comparison is hard to predict */
+                bool better = _cmp (window.values[slot], best);
+                best     = better ? window.values[slot] : best;
+                position = better ? idx : position;
+                slot = (slot == 0 ? _nbMinimizers : slot) - 1;
+            }
+
+            if (position >= 0)  {  kmer._minimizer.set (best);  kmer._position = position;  }
+        }
+
         /** Tells whether a minimizer is valid or not, in order to skip minimizers
          *  that are too frequent. */
         bool is_allowed (uint32_t mmer, uint32_t len)
@@ -1184,7 +1518,7 @@ struct Kmer
             for (int16_t idx=_nbMinimizers-1; idx>=0; idx--)
             {
                 /** We extract the most left mmer in the kmer. */
-                Type candidate_minim = _mmer_lut[(val & _mask).getVal()];
+                Type candidate_minim = _mmer_lut[val.getVal() & _mask.getVal()];
             
                 /** We check whether this mmer is the new minimizer. */
                 if (_cmp (candidate_minim, kmer_minimizer_value ) == true)  
@@ -1200,10 +1534,10 @@ struct Kmer
         }
    
         /** Returns the minimizer of the provided vector of mmers, fast method (may fallback to normal method)
-         * Note: only used for KmerCanonicals */
+         * Note: only used for KmerCanonicals; the fast method only knows the lexicographic order. */
         void computeNewMinimizer(KmerMinimizer<ModelCanonical, Comparator>& kmer, bool fastMethod = true) const 
         {
-            if (!fastMethod)
+            if (!fastMethod || _freq_order != 0)
             {
                 computeNewMinimizerOriginal(kmer);
                 return;
@@ -1239,6 +1573,115 @@ struct Kmer
 
     };
 
+    /********************************************************************************/
+
+    /** \brief Kmer size known at compilation time
+     *
+     * This class provides the methods of ModelAbstract that depend on the kmer size (reverse
+     * complement, rolls of a kmer and its reverse complement), the kmer size being the template
+     * argument K instead of a runtime value. All the shifts of these methods then have constant
+     * amounts, whereas a shift of a runtime amount on a multi-word LargeInt loops over the words.
+     *
+     * Hot loops use this class through 'applyFixedSize' for the kmer sizes chosen when the library
+     * is built (none by default), for instance:  cmake -DKSIZE_FIXED_LIST="21 31 51 63" ..
+     */
+    template<size_t K>
+    class FixedSize
+    {
+    public:
+
+        /** Constructor. */
+        FixedSize ()
+        {
+            Type un = 1;
+            _kmerMask = (un << (K*2)) - un;
+        }
+
+        /** \copydoc ModelAbstract::getKmerSize */
+        size_t getKmerSize () const { return K; }
+
+        /** \copydoc ModelAbstract::getKmerMax */
+        const Type& getKmerMax () const { return _kmerMask; }
+
+        /** \copydoc ModelAbstract::reverse */
+        Type reverse (const Type& kmer)  const  { return revcomp (kmer, K); }
+
+        /** \copydoc ModelAbstract::rollRight */
+        void rollRight (Type& forward, Type& reverse, size_t nt)  const
+        {
+            forward = ( (forward << 2) + nt ) & _kmerMask;
+            reverse = (reverse >> 2) + (Type(nt^2) << (2*(K-1)));
+        }
+
+        /** \copydoc ModelAbstract::rollLeft */
+        void rollLeft (Type& forward, Type& reverse, size_t nt)  const
+        {
+            forward = (forward >> 2) + (Type(nt) << (2*(K-1)));
+            reverse = ( (reverse << 2) + (nt^2) ) & _kmerMask;
+        }
+
+    private:
+
+        Type _kmerMask;
+    };
+
+    /** Calls a functor with a FixedSize<K> object if the kmer size of the model is one of the sizes
+     * of KSIZE_FIXED_LIST handled by the span, and with the model itself otherwise. The functor has
+     * a template operator() accepting both, so the same code is used with both kinds of kmer size.
+     * \param[in] model : model whose kmer size is looked for in the list
+     * \param[in] functor : functor to be called
+     */
+    template<typename Model, typename Functor>
+    static void applyFixedSize (const Model& model, Functor& functor)
+    {
+        typedef boost::mpl::vector<KSIZE_FIXED_LIST_TYPE>::type  FixedSizeList;
+
+        ApplyFixedSize<FixedSizeList, boost::mpl::empty<FixedSizeList>::value>::execute (model, functor);
+    }
+
+    /** Calls the functor with FixedSize<K> if the model has this kmer size and K fits the span. */
+    template<size_t K, bool fitsSpan>
+    struct CallFixedSize
+    {
+        template<typename Model, typename Functor>
+        static bool execute (const Model& model, Functor& functor)  {  return false;  }
+    };
+
+    template<size_t K>
+    struct CallFixedSize<K,true>
+    {
+        template<typename Model, typename Functor>
+        static bool execute (const Model& model, Functor& functor)
+        {
+            if (model.getKmerSize() != K)  {  return false;  }
+            functor (FixedSize<K>());
+            return true;
+        }
+    };
+
+    /** Looks for the kmer size of the model in a list of kmer sizes (see Integer::Apply). */
+    template<class T, bool empty>
+    struct ApplyFixedSize
+    {
+        template<typename Model, typename Functor>
+        static void execute (const Model& model, Functor& functor)
+        {
+            static const size_t K = boost::mpl::front<T>::type::value;
+
+            if (CallFixedSize<K, (K<span)>::execute (model, functor))  {  return;  }
+
+            typedef typename boost::mpl::pop_front<T>::type tail;
+            ApplyFixedSize<tail, boost::mpl::empty<tail>::value>::execute (model, functor);
+        }
+    };
+
+    /** Template specialization for an empty list: the kmer size is not a fixed one. */
+    template<class T>
+    struct ApplyFixedSize<T,true>
+    {
+        template<typename Model, typename Functor>
+        static void execute (const Model& model, Functor& functor)  {  functor (model);  }
+    };
 
     /************************************************************/
     /*********************  SUPER KMER    ***********************/
@@ -1291,15 +1734,16 @@ struct Kmer
             size_t superKmerLen = size();
 
             int64_t zero = 0;
-            Type masknt ((int64_t) 3);
             Type radix, radix_kxmer_forward ,radix_kxmer ;
             Type nbK ((int64_t) size());
             Type compactedK(zero);
 
+            /** We only need the last nucleotide of each kmer, read with operator[] rather than
+             * with a mask as large as the kmer. */
             for (size_t ii=1 ; ii < superKmerLen; ii++)
             {
                 compactedK = compactedK << 2  ;
-                compactedK = compactedK | ( ((*this)[ii].forward()) & masknt) ;
+                compactedK = compactedK | Type ((*this)[ii].forward()[0]) ;
             }
 
             int maxs = (compactedK.getSize() - 8 ) ;
@@ -1342,7 +1786,7 @@ struct Kmer
                 kmers[ii].set (rev_temp, temp);
 
                 if(rem < 2) break;
-                newnt =  ( superk >> ( 2*(rem-2)) ) & 3 ;
+                newnt =  Type (superk[rem-2]) ;
 
                 temp = ((temp << 2 ) |  newnt   ) & kmerMask;
                 newnt =  Type(comp_NT[newnt.getVal()]) ;
@@ -218,7 +218,7 @@ void PartitionsByHashCommand<span>:: execute ()
 			hash.increment (mink);
 							
 			if(rem < 2) break;
-			newnt =  ( superk >> ( 2*(rem-2)) ) & 3 ;
+			newnt =  Type (superk[rem-2]) ;
 			
 			temp = ((temp << 2 ) |  newnt   ) & kmerMask;
 			newnt =  Type(comp_NT[newnt.getVal()]) ;
@@ -258,7 +258,8 @@ void PartitionsByHashCommand<span>:: execute ()
            #     #######   #####      #     #######  #     #
 *********************************************************************/
 
-template<size_t span>
+/* Model is the kmer model or a Kmer<span>::FixedSize instance (see Kmer<span>::applyFixedSize). */
+template<size_t span, class Model>
 class SuperKReader
 {
 	typedef typename Kmer<span>::Type  Type;
@@ -283,8 +284,7 @@ public:
 			u_int8_t rem = nbK;
 			
 			Type temp = _seedk;
-			Type rev_temp = revcomp(temp,_kmerSize);
-			Type newnt ;
+			Type rev_temp = _model.reverse (temp);
 			Type mink, prev_mink;
 			uint64_t idx;
 			
@@ -341,11 +341,7 @@ public:
 				prev_mink = mink;
 				
 				if(rem < 2) break; //no more kmers in this superkmer, the last one has just been eaten
-				newnt =  ( _superk >> ( 2*(rem-2)) ) & 3 ;
-				
-				temp = ((temp << 2 ) |  newnt   ) & _kmerMask;
-				newnt =  Type(comp_NT[newnt.getVal()]) ;
-				rev_temp = ((rev_temp >> 2 ) |  (newnt << _shift) ) & _kmerMask;
+				_model.rollRight (temp, rev_temp, _superk[rem-2]);
 			}
 			
 			//record last kxmer prev_mink et monk ?
@@ -381,22 +377,20 @@ public:
 		}
 	}
 	
-	SuperKReader (size_t kmerSize,  uint64_t * r_idx, Type** radix_kmers, uint64_t* radix_sizes, bank::BankIdType** bankIdMatrix, size_t bankId=0)
-	: _kmerSize (kmerSize), _kx(4), _radix_kmers(radix_kmers), _radix_sizes(radix_sizes), _bankIdMatrix(bankIdMatrix), _r_idx (r_idx), _first(true), _bankId(bankId)
+	SuperKReader (const Model& model,  uint64_t * r_idx, Type** radix_kmers, uint64_t* radix_sizes, bank::BankIdType** bankIdMatrix, size_t bankId=0)
+	: _model (model), _kmerSize (model.getKmerSize()), _kx(4), _radix_kmers(radix_kmers), _radix_sizes(radix_sizes), _bankIdMatrix(bankIdMatrix), _r_idx (r_idx), _first(true), _bankId(bankId)
 	 {
 		 Type un = 1;
-		 _kmerMask    = (un << (kmerSize*2)) - un;
 		 _mask_radix  = Type((int64_t) 255);
 		 _mask_radix  = _mask_radix << ((_kmerSize - 4)*2);
-		 _shift       = 2*(kmerSize-1);
 		 _shift_val   = un.getSize() -8;
-		 _shift_radix = ((kmerSize - 4)*2); // radix is 4 nt long
+		 _shift_radix = ((_kmerSize - 4)*2); // radix is 4 nt long
 	}
 	
 private :
 
+	const Model& _model;
 	size_t _kmerSize;
-	size_t _shift ;
 	size_t _shift_val ;
 	size_t _shift_radix ;
 	int    _kx;
@@ -408,7 +402,6 @@ private :
 	bool _first;
 	Type _superk, _seedk;
 	Type _radix, _mask_radix ;
-	Type _kmerMask;
 	size_t _bankId;
 };
 
@@ -573,8 +566,26 @@ void PartitionsByVectorCommand<span>::executeRead ()
      * Now, we are going to read the temporary partition built during the previous phase and fill
      * the _radix_kmers attribute. We also need to know in _radix_kmers what is the contribution of
      * each bank. We therefore need to iterate the current partition by bank (using the information
-     * of _offsets). */
+     * of _offsets).
+     * The superkmers are read with the kmer size as a constant if it is one of KSIZE_FIXED_LIST. */
+    typename Kmer<span>::ModelCanonical model (this->_kmerSize);
+
+    ReadSuperKmers readSuperKmers (this);
+    Kmer<span>::applyFixedSize (model, readSuperKmers);
+}
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+template<class Model>
+void PartitionsByVectorCommand<span>::readSuperKmers (const Model& model)
+{
     if (_bankIdMatrix)
     {
         /** We create an iterator over all the items. */
@@ -590,7 +601,7 @@ void PartitionsByVectorCommand<span>::executeRead ()
             LOCAL (itLocal);
 
             /** We iterate this local iterator. */
-            _dispatcher->iterate (itLocal, SuperKReader<span>  (this->_kmerSize, _r_idx, _radix_kmers, _radix_sizes, _bankIdMatrix, b), 10000); //must be even , reading by pairs
+            _dispatcher->iterate (itLocal, SuperKReader<span,Model>  (model, _r_idx, _radix_kmers, _radix_sizes, _bankIdMatrix, b), 10000); //must be even , reading by pairs
         }
 
         /** We check that the global iterator is finished. */
@@ -599,7 +610,7 @@ void PartitionsByVectorCommand<span>::executeRead ()
     else
     {
         /** We iterate the superkmers. */
-        _dispatcher->iterate (this->_partition.iterator(), SuperKReader<span>  (this->_kmerSize, _r_idx, _radix_kmers, _radix_sizes, 0, 0), 10000); //must be even , reading by pairs
+        _dispatcher->iterate (this->_partition.iterator(), SuperKReader<span,Model>  (model, _r_idx, _radix_kmers, _radix_sizes, 0, 0), 10000); //must be even , reading by pairs
     }
 }
 
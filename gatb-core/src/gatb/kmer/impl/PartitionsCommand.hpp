@@ -244,6 +244,16 @@ private:
     void executeSort   ();
     void executeDump   ();
 
+    template<class Model>  void readSuperKmers (const Model& model);
+
+    /* Calls readSuperKmers with the model or a Kmer<span>::FixedSize instance (see Kmer<span>::applyFixedSize). */
+    struct ReadSuperKmers
+    {
+        PartitionsByVectorCommand* cmd;
+        ReadSuperKmers (PartitionsByVectorCommand* cmd) : cmd(cmd) {}
+        template<class Model>  void operator() (const Model& model)  {  cmd->readSuperKmers (model);  }
+    };
+
     std::vector<size_t> _nbItemsPerBankPerPart;
 };
 
@@ -276,6 +276,9 @@ void RepartitorAlgorithm<span>::execute ()
       of superkmers in bins */
     if (_config._minimizerType == 1)  {  computeFrequencies (repartitor);  }
 
+    /* the hashed order needs no sampling: the ranks of the minimizers are given by a hash function */
+    if (_config._minimizerType == 2)  {  computeHashedOrder (repartitor);  }
+
     computeRepartition (repartitor);
 }
 
@@ -355,6 +358,46 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
     repartitor.setMinimizerFrequencies (_freq_order);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : Ranks the minimizers by an invertible hash of their value (random order)
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the ranks are stored as the frequency ranks, so the models and the
+**           repartition table are built the same way as in frequency mode.
+*********************************************************************/
+template<size_t span>
+void RepartitorAlgorithm<span>::computeHashedOrder (Repartitor& repartitor)
+{
+    DEBUG (("RepartitorAlgorithm<span>::computeHashedOrder\n"));
+
+    u_int64_t rg = ((u_int64_t)1 << (2*_config._minim_size));
+
+    /* assign ranks to minimizers; the hash is a permutation of the minimizers, so ranks are distinct */
+    _freq_order = new uint32_t[rg];
+
+    for (u_int64_t i = 0; i < rg ; i++)
+        _freq_order[i] = NativeInt64::hash64Invertible (i, rg-1);
+
+    // same trick as for frequencies: the largest minimizer has to have largest rank, as it's used as
+    // the default "largest" value; it swaps its rank with the minimizer that had it.
+    for (u_int64_t i = 0; i < rg ; i++)
+    {
+        if (_freq_order[i] == rg-1)  {  _freq_order[i] = _freq_order[rg-1];  break;  }
+    }
+    _freq_order[rg-1] = rg-1;
+
+    /* an ordered repartition (bcalm) groups the minimizers by rank */
+    if (_config._repartitionType == 1)
+    {
+        for (u_int64_t i = 0; i < rg ; i++)  {  _counts.push_back (make_pair (_freq_order[i], i));  }
+        sort (_counts.begin(), _counts.end());
+    }
+
+    repartitor.setMinimizerFrequencies (_freq_order);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -414,7 +457,11 @@ void RepartitorAlgorithm<span>::computeRepartition (Repartitor& repartitor)
     else
     {
         repartitor.computeDistrib (sample_info);
-        if (_config._repartitionType == 1)
+        if (_config._repartitionType == 1 && _config._minimizerType == 2)
+        {
+            repartitor.justGroup (sample_info, _counts); // minimizers in hashed order (see computeHashedOrder)
+        }
+        else if (_config._repartitionType == 1)
         {
             repartitor.justGroupLexi (sample_info); // For bcalm, i need the minimizers to remain in order. so using this suboptimal but okay repartition
         }
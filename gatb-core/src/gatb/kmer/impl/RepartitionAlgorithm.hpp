@@ -68,6 +68,7 @@ public:
 private:
 
     void computeFrequencies (Repartitor& repartitor);
+    void computeHashedOrder (Repartitor& repartitor);
     void computeRepartition (Repartitor& repartitor);
 
     Configuration _config;
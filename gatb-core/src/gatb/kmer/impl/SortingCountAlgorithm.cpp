@@ -30,6 +30,7 @@
 #include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/bank/impl/Bank.hpp>
+#include <gatb/bank/impl/BankComposite.hpp>
 #include <gatb/tools/collections/impl/IterableHelpers.hpp>
 #include <cmath>
 
@@ -222,9 +223,10 @@ IOptionsParser* SortingCountAlgorithm<span>::getOptionsParser (bool mandatory)
 
     IOptionsParser* devParser = new OptionsParser ("kmer count, advanced (developer)");
 
-    devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq)",                false, "0"));
+    devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq, 2=hash)",        false, "0"));
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_SIZE,    "size of a minimizer",                            false, "8"));
     devParser->push_back (new OptionOneParam (STR_REPARTITION_TYPE,  "minimizer repartition (0=unordered, 1=ordered)", false, "0"));
+    devParser->push_back (new OptionOneParam (STR_DISTINCT_ESTIMATE, "estimate the number of distinct kmers, at the cost of an extra full pass over the bank (0=no, 1=yes)", false, "0"));
     parser->push_back (devParser);
 
     return parser;
@@ -475,8 +477,15 @@ void SortingCountAlgorithm<span>::execute ()
     /** We configure all required objects (bank, configuration, repartitor, count processor). */
     configure ();
 
-    /** We create the sequences iterator. */
-    Iterator<Sequence>* itSeq = _bank->iterator();
+    /** We create the sequences iterator. The files of a composite bank are parsed by several reader
+     * threads, unless the user has set the number of readers of the bank. */
+    Iterator<Sequence>* itSeq = 0;
+
+    BankComposite* composite = dynamic_cast<BankComposite*> (_bank);
+    size_t         nbReaders = composite ? std::min (composite->getNbBanks(), getDispatcher()->getExecutionUnitsNumber() / 2) : 0;
+
+    if (composite != 0 && composite->getNbReaders() == 0 && nbReaders > 1)  {  itSeq = composite->iteratorParallel (nbReaders);  }
+    else                                                                    {  itSeq = _bank->iterator();                          }
     LOCAL (itSeq);
 
     /** We configure the progress bar. Note that we create a ProgressSynchro since this progress bar
@@ -737,8 +746,8 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
     /** We create a kmer model; using the frequency order if we're in that mode */
     uint32_t* freq_order = NULL;
 
-    /** We may have to retrieve the minimizers frequencies computed in the RepartitorAlgorithm. */
-    if (_config._minimizerType == 1)  {  freq_order = _repartitor->getMinimizerFrequencies ();  }
+    /** We may have to retrieve the minimizers frequencies (or hashed ranks) computed in the RepartitorAlgorithm. */
+    if (_config._minimizerType == 1 || _config._minimizerType == 2)  {  freq_order = _repartitor->getMinimizerFrequencies ();  }
 
     Model model( _config._kmerSize, _config._minim_size, typename kmer::impl::Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq_order);
 
@@ -747,7 +756,10 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 	/** We have to reinit the progress instance since it may have been used by SampleRepart before. */
     _progress->init();
 
-    /** We may have several input banks instead of a single one. */
+    /** We may have several input banks instead of a single one. The banks are processed one after
+     * the other, even if their files are parsed concurrently (then the next files are parsed ahead
+     * by the readers), since the kmers of a bank are stored after the ones of the previous banks
+     * in the partitions; this is how the count processors get the abundance of each bank. */
     std::vector<Iterator<Sequence>*> itBanks =  itSeq->getComposition();
 
     /** We first reset the vector holding the kmers number for each partition and for each bank.
@@ -763,6 +775,19 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
      */
     _nbKmersPerPartitionPerBank.clear();
 
+    /** A single bank may be split into parts (see IBank::splitIterator) that are parsed by the threads
+     * without lock on a shared iterator. We use several parts per thread for balancing the load, but
+     * the parts are not too small since each one has its own buffers. */
+    Iterator<Sequence>* itParts = 0;
+
+    size_t nbCores = getDispatcher()->getExecutionUnitsNumber();
+    if (nbCores > 1  &&  itBanks.size() == 1  &&  itBanks[0] == itSeq  &&  dynamic_cast<ParallelCompositeIterator<Sequence>*> (itSeq) == 0)
+    {
+        size_t nbParts = std::min ((u_int64_t)(4*nbCores), _bank->getSize() / (16*MBYTE));
+        if (nbParts > 1)  {  itParts = _bank->splitIterator (nbParts);  }
+    }
+    LOCAL (itParts);
+
     /** We launch the iteration of the sequences iterator with the created functors. */
     for (size_t i=0; i<itBanks.size(); i++)
     {
@@ -772,10 +797,18 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
         /** We fill the partitions. Each thread will read synchronously and will call FillPartitions
          * in a synchronous way (in order to have global BanksStats correctly computed). */
 
-	
-        getDispatcher()->iterate (itBanks[i], FillPartitions<span> (
-            model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo
-        ), groupSize, deleteSynchro);
+        if (itParts != 0  &&  itParts->getComposition().size() > 1)
+        {
+            getDispatcher()->iterate (itParts->getComposition(), FillPartitions<span> (
+                model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo
+            ), deleteSynchro);
+        }
+        else
+        {
+            getDispatcher()->iterate (itBanks[i], FillPartitions<span> (
+                model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo
+            ), groupSize, deleteSynchro);
+        }
 
 
         /** We flush the partitions in order to be sure to have the exact number of items per partition. */
@@ -908,10 +941,8 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
         /** We build a list of 'currentNbCores' commands to be dispatched each one in one thread. */
         for (size_t j=0; j<currentNbCores; j++, p++)
         {
-            ISynchronizer* synchro = System::thread().newSynchronizer();
-            LOCAL (synchro);
-
-            /** We clone the prototype count processor instance for the current 'p' kmers partition. */
+            /** We clone the prototype count processor instance for the current 'p' kmers partition.
+             * Each clone is used by one thread only, so the clones need no synchronization. */
             CountProcessor* processorClone = processor->clone ();
 
             /** We use and put the clone into a vector. */
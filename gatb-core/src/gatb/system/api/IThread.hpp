@@ -147,6 +147,16 @@ public:
     /** Unlock the synchronizer. */
     virtual void unlock () = 0;
 
+    /** Wait until another thread calls notify. The synchronizer must be locked by the caller;
+     * it is unlocked during the wait and locked again before returning. Note that the
+     * caller should check its waiting condition again after the call (spurious wake-ups).
+     * By default, a synchronizer can't be waited on and throws an exception. */
+    virtual void wait ()  {  throw Exception ("Synchronizer doesn't support wait");  }
+
+    /** Wake up all the threads waiting on the synchronizer.
+     * By default, a synchronizer can't be waited on and throws an exception. */
+    virtual void notify ()  {  throw Exception ("Synchronizer doesn't support notify");  }
+
     /** Destructor. */
     virtual ~ISynchronizer () {}
 };
@@ -64,14 +64,18 @@ private:
 class SynchronizerLinux : public ISynchronizer, public system::SmartPointer
 {
 public:
-    SynchronizerLinux ()             {  pthread_mutex_init (&_mutex, NULL);  }
-    virtual ~SynchronizerLinux ()    {  pthread_mutex_destroy (&_mutex);     }
+    SynchronizerLinux ()             {  pthread_mutex_init (&_mutex, NULL);  pthread_cond_init (&_cond, NULL);  }
+    virtual ~SynchronizerLinux ()    {  pthread_mutex_destroy (&_mutex);  pthread_cond_destroy (&_cond);  }
 
     void   lock ()  { pthread_mutex_lock   (&_mutex); }
     void unlock ()  { pthread_mutex_unlock (&_mutex); }
 
+    void   wait ()  { pthread_cond_wait      (&_cond, &_mutex); }
+    void notify ()  { pthread_cond_broadcast (&_cond);         }
+
 private:
     pthread_mutex_t  _mutex;
+    pthread_cond_t   _cond;
 };
 
 /*********************************************************************
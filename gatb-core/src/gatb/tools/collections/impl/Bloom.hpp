@@ -53,6 +53,13 @@ extern u_int8_t bit_mask [];
  *
  * One can get a hash code for a given [function,item] through the operator()
  *
+ * The hash functions depend on a version, so Bloom filters saved with former versions
+ * can still be used:
+ *   - version 0: each function hashes the item (hash1) with its own seed
+ *   - version 1: the item is hashed once (foldhash) into h, and the function i gives h + i*h',
+ *     h' being h with its halves swapped (odd); see Kirsch & Mitzenmacher, "Less hashing, same
+ *     performance: building a better Bloom filter".
+ *
  * Note: this class is mainly used by Bloom filters implementations. It is not
  * primarly targeted for end users but they could nevertheless use it.
  */
@@ -60,10 +67,14 @@ template <typename Item> class HashFunctors
 {
 public:
 
+    /** Version of the hash functions used by default by the Bloom filters. */
+    static const int LAST_VERSION = 1;
+
     /** Constructor.
      * \param[in] nbFct : number of hash functions to be used
-     * \param[in] seed : some initialization code for defining the hash functions. */
-    HashFunctors (size_t nbFct, u_int64_t seed=0) : _nbFct(nbFct), user_seed(seed)
+     * \param[in] seed : some initialization code for defining the hash functions.
+     * \param[in] version : version of the hash functions (see above). */
+    HashFunctors (size_t nbFct, u_int64_t seed=0, int version=0) : _nbFct(nbFct), user_seed(seed), _version(version)
     {
         generate_hash_seed ();
     }
@@ -72,7 +83,34 @@ public:
      * \param[in] key : item for which we want a hash code
      * \param[in] idx : index of the hash function to be used
      * \return the hash code for the item. */
-    u_int64_t operator ()  (const Item& key, size_t idx)  {  return hash1 (key, seed_tab[idx]);  }
+    u_int64_t operator ()  (const Item& key, size_t idx)  {  return Codes (*this, key) [idx];  }
+
+    /** Get the version of the hash functions.
+     * \return the version */
+    int getVersion () const  { return _version; }
+
+    /** Hash codes of an item for all the hash functions. With version 1, the item is hashed only
+     * once, by the constructor; with version 0, each code is computed when it is asked for. */
+    class Codes
+    {
+    public:
+        Codes (const HashFunctors& fct, const Item& key) : _fct(fct), _key(key), _h(0), _h2(0)
+        {
+            if (_fct._version > 0)  {  _h = foldhash (key, _fct.user_seed);  _h2 = ((_h >> 32) | (_h << 32)) | 1;  }
+        }
+
+        /** Hash code of the item for the hash function idx. */
+        u_int64_t operator[] (size_t idx) const
+        {
+            return _fct._version == 0 ? hash1 (_key, _fct.seed_tab[idx]) : _h + idx*_h2;
+        }
+
+    private:
+        const HashFunctors& _fct;
+        const Item&         _key;
+        u_int64_t           _h;
+        u_int64_t           _h2;
+    };
 
 private:
 
@@ -95,6 +133,7 @@ private:
     static const size_t NSEEDSBLOOM = 10;
     u_int64_t seed_tab[NSEEDSBLOOM];
     u_int64_t user_seed;
+    int       _version;
 };
 
 /********************************************************************************/
@@ -133,6 +172,10 @@ public:
      * \return the number of hash functions. */
     virtual size_t     getNbHash   () const = 0;
 
+    /** Get the version of the hash functions used for the Bloom filter (see HashFunctors).
+     * \return the version of the hash functions. */
+    virtual int        getHashVersion () const = 0;
+
     /** Tells whether the 4 neighbors of the given item are in the Bloom filter.
      * The 4 neighbors are computed from the given item by adding successively
      * nucleotides 'A', 'C', 'T' and 'G'
@@ -174,9 +217,10 @@ public:
 
     /** Constructor.
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
-     * \param[in] nbHash : number of hash functions to use */
-    BloomContainer (u_int64_t tai_bloom, size_t nbHash = 4)
-        : _hash(nbHash), n_hash_func(nbHash), blooma(0), tai(tai_bloom), nchar(0), isSizePowOf2(false)
+     * \param[in] nbHash : number of hash functions to use
+     * \param[in] hashVersion : version of the hash functions (see HashFunctors) */
+    BloomContainer (u_int64_t tai_bloom, size_t nbHash = 4, int hashVersion = HashFunctors<Item>::LAST_VERSION)
+        : _hash(nbHash, 0, hashVersion), n_hash_func(nbHash), blooma(0), tai(tai_bloom), nchar(0), isSizePowOf2(false)
     {
         nchar  = (1+tai/8LL);
         blooma = (unsigned char *) MALLOC (nchar*sizeof(unsigned char)); // 1 bit per elem
@@ -201,14 +245,19 @@ public:
     /** \copydoc IBloom::getNbHash */
     size_t getNbHash () const { return n_hash_func; }
 
+    /** \copydoc IBloom::getHashVersion */
+    int getHashVersion () const { return _hash.getVersion(); }
+
     /** \copydoc Container::contains. */
     bool contains (const Item& item)
     {
+        typename HashFunctors<Item>::Codes codes (_hash, item);
+
         if (isSizePowOf2)
         {
             for (size_t i=0; i<n_hash_func; i++)
             {
-                u_int64_t h1 = _hash (item,i) & tai;
+                u_int64_t h1 = codes[i] & tai;
                // if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) != bit_mask[h1 & 7])  {  return false;  }
 				if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) == 0)  {  return false;  }
 
@@ -218,7 +267,7 @@ public:
         {
             for (size_t i=0; i<n_hash_func; i++)
             {
-                u_int64_t h1 = _hash (item,i) % tai;
+                u_int64_t h1 = codes[i] % tai;
                // if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) != bit_mask[h1 & 7])  {  return false;  }
 				if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) == 0)  {  return false;  }
 
@@ -266,16 +315,19 @@ template <typename Item> class Bloom : public BloomContainer<Item>
 public:
 
     /** \copydoc BloomContainer::BloomContainer */
-    Bloom (u_int64_t tai_bloom, size_t nbHash = 4)  : BloomContainer<Item> (tai_bloom, nbHash)  {}
+    Bloom (u_int64_t tai_bloom, size_t nbHash = 4, int hashVersion = HashFunctors<Item>::LAST_VERSION)
+        : BloomContainer<Item> (tai_bloom, nbHash, hashVersion)  {}
 
     /** \copydoc Bag::insert. */
     void insert (const Item& item)
     {
+        typename HashFunctors<Item>::Codes codes (this->_hash, item);
+
         if (this->isSizePowOf2)
         {
             for (size_t i=0; i<this->n_hash_func; i++)
             {
-                u_int64_t h1 = this->_hash (item,i) & this->tai;
+                u_int64_t h1 = codes[i] & this->tai;
                 this->blooma [h1 >> 3] |= bit_mask[h1 & 7];
             }
         }
@@ -283,7 +335,7 @@ public:
         {
             for (size_t i=0; i<this->n_hash_func; i++)
             {
-                u_int64_t h1 = this->_hash (item,i) % this->tai;
+                u_int64_t h1 = codes[i] % this->tai;
                 this->blooma [h1 >> 3] |= bit_mask[h1 & 7];
             }
         }
@@ -345,6 +397,9 @@ public:
     /** \copydoc IBloom::getNbHash */
     size_t     getNbHash   () const { return 0; }
 
+    /** \copydoc IBloom::getHashVersion */
+    int        getHashVersion () const { return 0; }
+
     /** \copydoc IBloom::getName */
     virtual std::string  getName   () const  { return "BloomNull"; }
 
@@ -382,16 +437,19 @@ template <typename Item> class BloomSynchronized : public Bloom<Item>
 public:
 
     /** \copydoc Bloom::Bloom */
-    BloomSynchronized (u_int64_t tai_bloom, size_t nbHash = 4)  : Bloom<Item> (tai_bloom, nbHash)  {}
+    BloomSynchronized (u_int64_t tai_bloom, size_t nbHash = 4, int hashVersion = HashFunctors<Item>::LAST_VERSION)
+        : Bloom<Item> (tai_bloom, nbHash, hashVersion)  {}
 
     /** \copydoc Bag::insert. */
     void insert (const Item& item)
     {
+        typename HashFunctors<Item>::Codes codes (this->_hash, item);
+
         if (this->isSizePowOf2)
         {
             for (size_t i=0; i<this->n_hash_func; i++)
             {
-                u_int64_t h1 = this->_hash (item,i) & this->tai;
+                u_int64_t h1 = codes[i] & this->tai;
                 __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
             }
         }
@@ -399,7 +457,7 @@ public:
         {
             for (size_t i=0; i<this->n_hash_func; i++)
             {
-                u_int64_t h1 = this->_hash (item,i) % this->tai;
+                u_int64_t h1 = codes[i] % this->tai;
                 __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
             }
         }
@@ -427,9 +485,10 @@ public:
     /** Constructor.
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
      * \param[in] nbHash : number of hash functions to use
-     * \param[in] block_nbits : size of the block (actual 2^nbits) */
-    BloomCacheCoherent (u_int64_t tai_bloom, size_t nbHash = 4,size_t block_nbits = 12)
-        : Bloom<Item> (tai_bloom + 2*(1<<block_nbits), nbHash),_nbits_BlockSize(block_nbits)
+     * \param[in] block_nbits : size of the block (actual 2^nbits)
+     * \param[in] hashVersion : version of the hash functions (see HashFunctors) */
+    BloomCacheCoherent (u_int64_t tai_bloom, size_t nbHash = 4,size_t block_nbits = 12, int hashVersion = HashFunctors<Item>::LAST_VERSION)
+        : Bloom<Item> (tai_bloom + 2*(1<<block_nbits), nbHash, hashVersion),_nbits_BlockSize(block_nbits)
     {
         _mask_block = (1<<_nbits_BlockSize) - 1;
         _reduced_tai = this->tai -  2*(1<<_nbits_BlockSize) ;//2* for neighbor coherent
@@ -441,13 +500,15 @@ public:
         //for insert, no prefetch, perf is not important
         u_int64_t h0;
 
-        h0 = this->_hash (item,0) % _reduced_tai;
+        typename HashFunctors<Item>::Codes codes (this->_hash, item);
+
+        h0 = codes[0] % _reduced_tai;
 
         __sync_fetch_and_or (this->blooma + (h0 >> 3), bit_mask[h0 & 7]);
 
         for (size_t i=1; i<this->n_hash_func; i++)
         {
-            u_int64_t h1 = h0  + (simplehash16( item, i) & _mask_block )   ;
+            u_int64_t h1 = h0  + blockOffset (codes, item, i);
             __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
         }
     }
@@ -464,13 +525,15 @@ public:
         u_int64_t tab_keys [20];
         u_int64_t h0;
 
-        h0 = this->_hash (item,0) % _reduced_tai;
+        typename HashFunctors<Item>::Codes codes (this->_hash, item);
+
+        h0 = codes[0] % _reduced_tai;
         __builtin_prefetch(&(this->blooma [h0 >> 3] ), 0, 3); //preparing for read
 
         //compute all hashes during prefetch
         for (size_t i=1; i<this->n_hash_func; i++)
         {
-           tab_keys[i] =  h0  + (simplehash16( item, i) & _mask_block );// with simplest hash
+           tab_keys[i] =  h0  + blockOffset (codes, item, i);
         }
 
         if ((this->blooma[h0 >> 3 ] & bit_mask[h0 & 7]) ==0 )  {  return false;  }
@@ -493,6 +556,13 @@ protected:
     u_int64_t _mask_block;
     size_t    _nbits_BlockSize;
     u_int64_t _reduced_tai;
+
+    /** Offset of the bit of the hash function i in the block of the first one; the version 0 of the
+     * hash functions uses the simplest hash. */
+    u_int64_t blockOffset (const typename HashFunctors<Item>::Codes& codes, const Item& item, size_t i) const
+    {
+        return (this->_hash.getVersion() == 0 ? simplehash16 (item, i) : codes[i]) & _mask_block;
+    }
 };
 	
 /********************************************************************************/
@@ -513,9 +583,10 @@ public:
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
      * \param[in] kmersize : kmer size
      * \param[in] nbHash : number of hash functions to use
-     * \param[in] block_nbits : size of the block (actual 2^nbits) */
-    BloomNeighborCoherent (u_int64_t tai_bloom, size_t kmersize , size_t nbHash = 4,size_t block_nbits = 12 )  :
-    BloomCacheCoherent<Item> (tai_bloom , nbHash,block_nbits), _kmerSize(kmersize)
+     * \param[in] block_nbits : size of the block (actual 2^nbits)
+     * \param[in] hashVersion : version of the hash functions (see HashFunctors) */
+    BloomNeighborCoherent (u_int64_t tai_bloom, size_t kmersize , size_t nbHash = 4,size_t block_nbits = 12, int hashVersion = HashFunctors<Item>::LAST_VERSION)  :
+    BloomCacheCoherent<Item> (tai_bloom , nbHash,block_nbits,hashVersion), _kmerSize(kmersize)
     {
         cano2[ 0] = 0;
         cano2[ 1] = 1;
@@ -1242,16 +1313,19 @@ public:
      * \param[in] tai_bloom : size of the Bloom filter (in bits)
      * \param[in] nbHash : number of hash functions for the Bloom filter
      * \param[in] kmersize : kmer size (used only for some implementations).
+     * \param[in] hashVersion : version of the hash functions (see HashFunctors)
      */
-    template<typename T> IBloom<T>* createBloom (tools::misc::BloomKind kind, u_int64_t tai_bloom, size_t nbHash, size_t kmersize)
+    template<typename T> IBloom<T>* createBloom (tools::misc::BloomKind kind, u_int64_t tai_bloom, size_t nbHash, size_t kmersize,
+        int hashVersion = HashFunctors<T>::LAST_VERSION
+    )
     {
         switch (kind)
         {
             case tools::misc::BLOOM_NONE:      return new BloomNull<T>             ();
-            case tools::misc::BLOOM_BASIC:     return new BloomSynchronized<T>     (tai_bloom, nbHash);
-            case tools::misc::BLOOM_CACHE:     return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
-			case tools::misc::BLOOM_NEIGHBOR:  return new BloomNeighborCoherent<T> (tai_bloom, kmersize, nbHash);
-            case tools::misc::BLOOM_DEFAULT:   return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
+            case tools::misc::BLOOM_BASIC:     return new BloomSynchronized<T>     (tai_bloom, nbHash, hashVersion);
+            case tools::misc::BLOOM_CACHE:     return new BloomCacheCoherent<T>    (tai_bloom, nbHash, 12, hashVersion);
+			case tools::misc::BLOOM_NEIGHBOR:  return new BloomNeighborCoherent<T> (tai_bloom, kmersize, nbHash, 12, hashVersion);
+            case tools::misc::BLOOM_DEFAULT:   return new BloomCacheCoherent<T>    (tai_bloom, nbHash, 12, hashVersion);
             default:        throw system::Exception ("bad Bloom kind %d in createBloom", kind);
         }
     }
@@ -1261,16 +1335,21 @@ public:
      * \param[in] sizeStr : size of the Bloom filter (in bits) as a string
      * \param[in] nbHashStr : number of hash functions for the Bloom filter as a string
      * \param[in] kmerSizeStr : kmer size (used only for some implementations) as a string.
+     * \param[in] hashVersionStr : version of the hash functions as a string; empty for the filters
+     *  saved before the versioning of the hash functions (version 0).
      */
     template<typename T> IBloom<T>* createBloom (
         const std::string& name,
         const std::string& sizeStr,
         const std::string& nbHashStr,
-        const std::string& kmerSizeStr
+        const std::string& kmerSizeStr,
+        const std::string& hashVersionStr = ""
     )
     {
         tools::misc::BloomKind kind;  parse (name, kind);
-        return createBloom<T> (kind, (u_int64_t)atol (sizeStr.c_str()), (size_t)atol (nbHashStr.c_str()), atol (kmerSizeStr.c_str()));
+        return createBloom<T> (kind, (u_int64_t)atol (sizeStr.c_str()), (size_t)atol (nbHashStr.c_str()), atol (kmerSizeStr.c_str()),
+            atoi (hashVersionStr.c_str())
+        );
     }
 };
 
@@ -0,0 +1,137 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file HyperLogLog.hpp
+ *  \brief HyperLogLog estimator of the number of distinct items
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/math/LargeInt.hpp>
+#include <gatb/system/api/Exception.hpp>
+#include <gatb/system/api/types.hpp>
+#include <vector>
+#include <cmath>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Estimator of the number of distinct items (HyperLogLog)
+ *
+ * The first 'precision' bits of the hash of an item select one of 2^precision registers;
+ * the register keeps the maximal rank of the first 1 bit found in the remaining bits.
+ * The harmonic mean of the registers gives the estimation, with a standard error of
+ * 1.04/sqrt(2^precision), ie. 1.6% with 4 KBytes of registers for the default precision.
+ * Small cardinalities are estimated by linear counting of the empty registers.
+ *
+ * See Flajolet et al., "HyperLogLog: the analysis of a near-optimal cardinality estimation
+ * algorithm", 2007.
+ *
+ * Estimators with the same precision can be merged, for instance one estimator per thread
+ * merged at the end, and the merge gives the same estimation as a single estimator
+ * fed with all the items.
+ */
+class HyperLogLog
+{
+public:
+
+    /** Constructor.
+     * \param[in] precision : number of bits of the hash used for selecting a register (4 to 18). */
+    HyperLogLog (size_t precision = 12)  : _precision(precision), _registers()
+    {
+        if (_precision < 4 || _precision > 18)  {  throw system::Exception ("HyperLogLog: bad precision %d (should be in [4,18])", (int)_precision);  }
+        _registers.resize ((size_t)1 << _precision, 0);
+    }
+
+    /** Add an item given by its hash value. The hash must be uniform over 64 bits.
+     * \param[in] hash : hash value of the item. */
+    void add (u_int64_t hash)
+    {
+        size_t idx = hash >> (64 - _precision);
+
+        /** The bit set below the remaining bits bounds the rank to 64-precision+1. */
+        u_int64_t rest = (hash << _precision) | ((u_int64_t)1 << (_precision-1));
+        u_int8_t  rank = __builtin_clzll (rest) + 1;
+
+        if (rank > _registers[idx])  {  _registers[idx] = rank;  }
+    }
+
+    /** Add an item (an integer such as a kmer value), hashed with foldhash.
+     * \param[in] item : the item to be added. */
+    template<typename Item> void insert (const Item& item)  {  add (foldhash (item));  }
+
+    /** Merge another estimator into this one.
+     * \param[in] other : estimator with the same precision. */
+    void merge (const HyperLogLog& other)
+    {
+        if (other._precision != _precision)  {  throw system::Exception ("HyperLogLog: unable to merge precisions %d and %d", (int)other._precision, (int)_precision);  }
+
+        for (size_t i=0; i<_registers.size(); i++)  {  if (other._registers[i] > _registers[i])  { _registers[i] = other._registers[i]; }  }
+    }
+
+    /** Get the estimated number of distinct items added so far.
+     * \return the estimation. */
+    u_int64_t count () const
+    {
+        double m     = _registers.size();
+        double sum   = 0;
+        size_t zeros = 0;
+
+        for (size_t i=0; i<_registers.size(); i++)
+        {
+            sum += 1.0 / (double) ((u_int64_t)1 << _registers[i]);
+            if (_registers[i] == 0)  { zeros++; }
+        }
+
+        double alpha    = 0.7213 / (1.0 + 1.079 / m);
+        double estimate = alpha * m * m / sum;
+
+        /** Small range correction. */
+        if (estimate <= 2.5 * m && zeros > 0)  {  estimate = m * log (m / (double)zeros);  }
+
+        return (u_int64_t) (estimate + 0.5);
+    }
+
+    /** Get the precision of the estimator.
+     * \return the precision. */
+    size_t getPrecision () const  { return _precision; }
+
+    /** Get the memory size of the registers.
+     * \return the size in bytes. */
+    size_t getMemorySize () const  { return _registers.size() * sizeof(u_int8_t); }
+
+private:
+
+    size_t                 _precision;
+    std::vector<u_int8_t>  _registers;
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_ */
@@ -32,6 +32,8 @@
 #include <gatb/tools/collections/impl/MPHF.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 
 /********************************************************************************/
 namespace gatb        {
@@ -81,12 +83,13 @@ public:
         clearData();
     }
 
-    /* use the hash from another MapMPHF class. hmm is this smartpointer legit?
+    /* use the hash from another MapMPHF class (or MapMPHFPacked). hmm is this smartpointer legit?
      * also allocate n/x data elements
      */
-    void useHashFrom (MapMPHF *other, int x = 1)
+    template <class Map>
+    void useHashFrom (Map *other, int x = 1)
     {
-        hash = other->hash;
+        hash = other->getHash();
         
         /** We resize the vector of Value objects. */
         data.resize ((unsigned long)((hash.size()) / (unsigned long)x) + 1LL); // that +1 and not (hash.size+x-1) / x
@@ -128,14 +131,15 @@ public:
     /** Get the hash code of the given key. */
     typename Hash::Code getCode (const Key& key) { return hash(key); }
 
+    /** Get the hash function. */
+    const Hash& getHash () const { return hash; }
+
     /** Get the number of keys.
      * \return keys number. */
     size_t size() const { return hash.size(); }
 
-    void clearData() { 
-        for (unsigned long i = 0; i < data.size(); i ++)
-            data[i] = 0;
-     }
+    /** Reset all the values to 0. */
+    void clearData()  {  std::fill (data.begin(), data.end(), Value(0));  }
 
 private:
 
@@ -144,6 +148,330 @@ private:
 
 };
 
+/********************************************************************************/
+
+/** \brief hash table implementation with bit-packed values
+ *
+ * This is a variant of MapMPHF dedicated to small unsigned values (typically kmers
+ * abundances). Instead of one Value object per key, each key uses a configurable
+ * number of bits (between 1 and 16) in a packed array of 64 bits words.
+ *
+ * Two quantization modes are available:
+ *  - linear : values are stored exactly. If a value can't be represented with the
+ *    configured number of bits, a sentinel code is stored in the packed array and
+ *    the exact value is put in an overflow side table (sorted by hash code).
+ *  - log scale : the first 2^(nbBits-1) values are stored exactly; the remaining codes
+ *    are spread logarithmically up to the maximum value. No side table is needed but
+ *    high values are approximated.
+ *
+ * Values are clamped to a maximum value (given at configuration).
+ *
+ * Since values are not addressable, operator[] and at() return a proxy object that
+ * can be read or assigned like a reference.
+ *
+ * Note that setting values is not thread safe (two keys may share the same word); reading
+ * values is thread safe once 'flush' has been called.
+ */
+template <class Key, class Adaptator=AdaptatorDefault<Key> >
+class MapMPHFPacked : public system::SmartPointer
+{
+public:
+
+    /** Hash type. */
+    typedef MPHF<Key, Adaptator> Hash;
+
+    /** Type of the values. */
+    typedef u_int32_t Value;
+
+    /** Constant telling whether the feature is enabled or not. */
+    static const bool enabled = Hash::enabled;
+
+    /** Proxy on a value of the map, for reading and writing through operator[]. */
+    class Reference
+    {
+    public:
+        Reference (MapMPHFPacked& ref, typename Hash::Code code) : _ref(ref), _code(code) {}
+        operator Value () const                   { return _ref.get (_code); }
+        Reference& operator= (Value value)        { _ref.set (_code, value);  return *this; }
+        Reference& operator= (const Reference& r) { _ref.set (_code, (Value)r); return *this; }
+    private:
+        MapMPHFPacked&      _ref;
+        typename Hash::Code _code;
+    };
+
+    /** Constructor.
+     * \param[in] nbBits : number of bits per value
+     * \param[in] maxValue : maximum value (bigger values are clamped)
+     * \param[in] logScale : true for log scale quantization, false for exact values with overflow table */
+    MapMPHFPacked (size_t nbBits=8, Value maxValue=255, bool logScale=false) : _nbValues(0)  {  configure (nbBits, maxValue, logScale);  }
+
+    /** Configure the value encoding. Must be called before build/load (values are cleared).
+     * \param[in] nbBits : number of bits per value
+     * \param[in] maxValue : maximum value (bigger values are clamped)
+     * \param[in] logScale : true for log scale quantization, false for exact values with overflow table */
+    void configure (size_t nbBits, Value maxValue, bool logScale)
+    {
+        if (nbBits==0 || nbBits>16)  { throw system::Exception ("MapMPHFPacked: bad number of bits %d (should be in [1..16])", nbBits); }
+
+        _nbBits   = nbBits;
+        _maxValue = maxValue;
+        _logScale = logScale;
+        _mask     = (1ULL << _nbBits) - 1;
+
+        /** In linear mode, the biggest code is a sentinel only if it can't hold the max value. */
+        _overflowCode = (_logScale==false && _mask < _maxValue) ? _mask : _mask+1;
+
+        buildTables ();
+        resizeData (_nbValues);
+    }
+
+    /** Build the hash function from a set of items.
+     * \param[in] keys : iterable over the keys of the hash table
+     * \param[in] progress : listener called during the building of the MPHF
+     */
+    void build (tools::collections::Iterable<Key>& keys, tools::dp::IteratorListener* progress=0)
+    {
+        hash.build (&keys, progress);
+        resizeData (keys.getNbItems());
+    }
+
+    /** Save the hash function into a Group object.
+     * \param[out] group : group where to save the MPHF
+     * \param[in] name : name of the saved MPHF
+     * \return the number of bytes of the saved data.
+     */
+    size_t save (tools::storage::impl::Group& group, const std::string& name)  {  return hash.save (group, name);  }
+
+    /** Load hash function from a Group
+     * \param[in] group : group where to load the MPHF from
+     * \param[in] name : name of the MPHF
+     */
+    void load (tools::storage::impl::Group& group, const std::string& name)
+    {
+        resizeData (hash.load (group, name));
+    }
+
+    /** Get the value for a given key
+     * \param[in] key : the key
+     * \return a proxy on the value associated to the key. */
+    Reference operator[] (const Key& key)  { return Reference (*this, hash(key)); }
+
+    /** Get the value for a given index
+     * \param[in] code : the index
+     * \return a proxy on the value associated to the index. */
+    Reference at (typename Hash::Code code)  { return Reference (*this, code); }
+
+    /** Get the hash code of the given key. */
+    typename Hash::Code getCode (const Key& key) { return hash(key); }
+
+    /** Get the hash function. */
+    const Hash& getHash () const { return hash; }
+
+    /** Get the number of keys.
+     * \return keys number. */
+    size_t size() const { return hash.size(); }
+
+    /** Get the value for a given index.
+     * \param[in] code : the index
+     * \return the (possibly approximated) value. */
+    Value get (typename Hash::Code code) const
+    {
+        u_int64_t c = getPacked (code);
+        if (c == _overflowCode)  {  return getOverflow (code);  }
+        return _decode[c];
+    }
+
+    /** Set the value for a given index.
+     * \param[in] code : the index
+     * \param[in] value : the value to be set (clamped to the max value) */
+    void set (typename Hash::Code code, Value value)
+    {
+        if (value > _maxValue)  { value = _maxValue; }
+
+        if (_logScale==false && value >= _overflowCode)
+        {
+            setPacked (code, _overflowCode);
+            _overflow.push_back (std::make_pair (code, value));
+            _overflowSorted = false;
+        }
+        else
+        {
+            setPacked (code, _logScale ? _encode[value] : value);
+        }
+    }
+
+    /** Sort the overflow side table. Should be called once the map has been populated,
+     * otherwise looking for overflowed values is done with a linear scan. */
+    void flush ()
+    {
+        /** The last set value of a given code must be kept, so we use a stable sort. */
+        std::stable_sort (_overflow.begin(), _overflow.end(), CompareCode());
+
+        size_t j = 0;
+        for (size_t i=0; i<_overflow.size(); i++)
+        {
+            if (j>0 && _overflow[j-1].first == _overflow[i].first)  { _overflow[j-1] = _overflow[i]; }
+            else                                                    { _overflow[j++] = _overflow[i]; }
+        }
+        _overflow.resize (j);
+
+        _overflowSorted = true;
+    }
+
+    /** Reset all the values to 0. */
+    void clearData()
+    {
+        std::fill (data.begin(), data.end(), 0);
+        _overflow.clear();
+        _overflowSorted = true;
+    }
+
+    /** Get the number of bits per value.
+     * \return the number of bits. */
+    size_t getNbBits () const  { return _nbBits; }
+
+    /** Get the maximum value that can be stored.
+     * \return the max value. */
+    Value getMaxValue () const  { return _maxValue; }
+
+    /** Tells whether values are quantized on a log scale.
+     * \return true for log scale. */
+    bool isLogScale () const  { return _logScale; }
+
+    /** Get the number of values stored in the overflow side table.
+     * \return the number of overflowed values. */
+    size_t getNbOverflow () const  { return _overflow.size(); }
+
+    /** Get the memory used by the values (packed array and overflow table).
+     * \return the memory size in bytes. */
+    u_int64_t getMemorySize () const
+    {
+        return data.size()*sizeof(u_int64_t) + _overflow.size()*sizeof(std::pair<typename Hash::Code,Value>);
+    }
+
+private:
+
+    Hash                   hash;
+    std::vector<u_int64_t> data;
+
+    size_t    _nbBits;
+    Value     _maxValue;
+    bool      _logScale;
+    u_int64_t _mask;
+    u_int64_t _overflowCode;
+    u_int64_t _nbValues;
+
+    /** Decoding table (code -> value) and encoding table (value -> code) for the log scale. */
+    std::vector<Value>     _decode;
+    std::vector<u_int16_t> _encode;
+
+    /** Overflow side table of [index,value] couples. */
+    std::vector<std::pair<typename Hash::Code,Value> > _overflow;
+    bool _overflowSorted;
+
+    struct CompareCode
+    {
+        bool operator() (const std::pair<typename Hash::Code,Value>& a, const std::pair<typename Hash::Code,Value>& b) const
+        {  return a.first < b.first;  }
+    };
+
+    /** */
+    void resizeData (u_int64_t nbValues)
+    {
+        _nbValues = nbValues;
+        data.assign ((_nbValues*_nbBits + 63) / 64, 0);
+        _overflow.clear();
+        _overflowSorted = true;
+    }
+
+    /** */
+    void buildTables ()
+    {
+        _decode.resize (_mask+1);
+        _encode.clear ();
+
+        if (_logScale == false)
+        {
+            for (u_int64_t c=0; c<=_mask; c++)  {  _decode[c] = c;  }
+            return;
+        }
+
+        /** Small values are exact, bigger ones are spread on a log scale up to the max value. */
+        u_int64_t nbExact = std::min ((u_int64_t)(1ULL << (_nbBits-1)), (u_int64_t)_maxValue+1);
+
+        for (u_int64_t c=0; c<nbExact; c++)  {  _decode[c] = c;  }
+
+        u_int64_t nbLog = _mask + 1 - nbExact;
+        double    lmin  = log ((double) (nbExact>0 ? nbExact-1 : 0) + 1);
+        double    lmax  = log ((double) _maxValue);
+
+        for (u_int64_t i=1; i<=nbLog; i++)
+        {
+            Value v = (Value) floor (exp (lmin + (lmax-lmin)*i/nbLog) + 0.5);
+            _decode[nbExact+i-1] = std::max (v, _decode[nbExact+i-2]);
+        }
+
+        /** The encoding table gives, for each value, the code whose decoded value is the closest (in log scale). */
+        _encode.resize (_maxValue+1);
+        u_int64_t c = 0;
+        for (u_int64_t v=0; v<=_maxValue; v++)
+        {
+            while (c < _mask && _decode[c+1] <= v)  { c++; }
+
+            if (c < _mask && _decode[c] < v)
+            {
+                double dlow  = log((double)v) - log((double)std::max (_decode[c],   (Value)1));
+                double dhigh = log((double)std::max (_decode[c+1],(Value)1)) - log((double)v);
+                _encode[v] = (dhigh < dlow) ? c+1 : c;
+            }
+            else  {  _encode[v] = c;  }
+        }
+    }
+
+    /** */
+    u_int64_t getPacked (u_int64_t idx) const
+    {
+        u_int64_t bit  = idx * _nbBits;
+        u_int64_t word = bit >> 6;
+        u_int64_t off  = bit & 63;
+
+        u_int64_t result = data[word] >> off;
+        if (off + _nbBits > 64)  {  result |= data[word+1] << (64 - off);  }
+        return result & _mask;
+    }
+
+    /** */
+    void setPacked (u_int64_t idx, u_int64_t code)
+    {
+        u_int64_t bit  = idx * _nbBits;
+        u_int64_t word = bit >> 6;
+        u_int64_t off  = bit & 63;
+
+        data[word] = (data[word] & ~(_mask << off)) | (code << off);
+        if (off + _nbBits > 64)
+        {
+            u_int64_t shift = 64 - off;
+            data[word+1] = (data[word+1] & ~(_mask >> shift)) | (code >> shift);
+        }
+    }
+
+    /** */
+    Value getOverflow (typename Hash::Code code) const
+    {
+        if (_overflowSorted)
+        {
+            typename std::vector<std::pair<typename Hash::Code,Value> >::const_iterator it = std::lower_bound (
+                _overflow.begin(), _overflow.end(), std::make_pair(code,(Value)0), CompareCode()
+            );
+            return (it != _overflow.end() && it->first == code) ? it->second : _maxValue;
+        }
+
+        /** Not sorted yet: the last set value is the good one. */
+        for (size_t i=_overflow.size(); i>0; i--)  {  if (_overflow[i-1].first == code)  { return _overflow[i-1].second; }  }
+        return _maxValue;
+    }
+};
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
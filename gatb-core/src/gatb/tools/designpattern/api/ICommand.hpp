@@ -221,6 +221,47 @@ public:
         return iterate ((Iterator<Item>*)&iterator, functors, groupSize, deleteSynchro);
     }
 
+    /** Iterate several iterators, for instance the parts of a bank (see IBank::splitIterator). Each thread
+     * takes the next iterator not iterated yet and iterates it alone, so no lock is needed for getting the items.
+     * The provided functor is cloned N times, where N is the number of threads to be created (see the other
+     * iterate methods for the constraints on the Functor type).
+     *
+     * \param[in] iterators : the iterators to be iterated
+     * \param[in] functor : functor object to be cloned N times, one per thread
+     * \param[in] deleteSynchro : if false, destructor of functors are called in each thread; if true, destructor of functors are called synchronously
+     */
+    template <typename Item, typename Functor>
+    Status iterate (const std::vector<Iterator<Item>*>& iterators, const Functor& functor, bool deleteSynchro = false)
+    {
+        Status status;
+
+        /** We create a common synchronizer (only used for deleting the functors). */
+        system::ISynchronizer* synchro = newSynchro();
+
+        /** Index of the next iterator to be iterated, shared by the threads. */
+        size_t nextIterator = 0;
+
+        /** We create N IteratorsCommand instances. */
+        std::vector<ICommand*> commands;
+        for (size_t i=0; i<getExecutionUnitsNumber(); i++)
+        {
+            commands.push_back (new IteratorsCommand<Item,Functor> (iterators, nextIterator, new Functor (functor), *synchro, deleteSynchro));
+        }
+
+        /** We dispatch the commands. */
+        status.time = dispatchCommands (commands);
+
+        /** We get rid of the synchronizer. */
+        delete synchro;
+
+        /** We set the status. */
+        status.nbCores   = commands.size();
+        status.groupSize = 0;
+
+        /** We return the status. */
+        return status;
+    }
+
     /** Set the number of items to be retrieved from the iterator by one thread in a synchronized way.
      * \param[in] groupSize : number of items to be retrieved. */
     virtual void   setGroupSize (size_t groupSize) = 0;
@@ -336,6 +377,47 @@ protected:
         size_t                 _groupSize;
         bool                   _deleteSynchro;
     };
+
+    /* Inner class that iterates some of the provided iterators in one thread. */
+    template <typename Item, typename Functor> class IteratorsCommand : public ICommand, public system::SmartPointer
+    {
+    public:
+        /** Constructor.
+         * \param[in] iterators : iterators to be iterated (shared by several IteratorsCommand instances)
+         * \param[in] nextIterator : index of the next iterator to be iterated (shared by several IteratorsCommand instances)
+         * \param[in] fct : functor fed with the iterated items
+         * \param[in] synchro : shared synchronizer for deleting the functor
+         */
+        IteratorsCommand (const std::vector<Iterator<Item>*>& iterators, size_t& nextIterator, Functor* fct, system::ISynchronizer& synchro, bool deleteSynchro)
+            : _iterators(iterators), _nextIterator(nextIterator), _fct(fct), _synchro(synchro), _deleteSynchro(deleteSynchro)  {}
+
+        /** Implementation of the ICommand interface.*/
+        void execute ()
+        {
+            /** The iterators may share their current item (see CompositeIterator), so we provide our own one. */
+            Item item;
+
+            for (size_t i = __sync_fetch_and_add (&_nextIterator, 1);  i < _iterators.size();  i = __sync_fetch_and_add (&_nextIterator, 1))
+            {
+                Iterator<Item>* it = _iterators[i];
+                it->setItem (item);
+
+                for (it->first(); !it->isDone(); it->next())  {  (*_fct) (item);  }
+            }
+
+            /** We do not need the functor after that, delete it here to have parallel delete */
+            if (_deleteSynchro)  { _synchro.lock (); }
+            delete _fct;
+            if (_deleteSynchro)  { _synchro.unlock (); }
+        }
+
+    private:
+        const std::vector<Iterator<Item>*>& _iterators;
+        size_t&                             _nextIterator;
+        Functor*                            _fct;
+        system::ISynchronizer&              _synchro;
+        bool                                _deleteSynchro;
+    };
 };
 
 /********************************************************************************/
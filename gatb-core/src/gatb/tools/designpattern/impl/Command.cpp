@@ -66,6 +66,9 @@ class SynchronizerNull : public system::ISynchronizer, public system::SmartPoint
 public:
     void   lock ()  {}
     void unlock ()  {}
+
+    /** Nobody can wait on this synchronizer (see ISynchronizer::wait), so nobody has to be woken up. */
+    void notify ()  {}
 };
 
 /*********************************************************************
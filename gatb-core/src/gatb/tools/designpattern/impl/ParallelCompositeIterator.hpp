@@ -0,0 +1,390 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file ParallelCompositeIterator.hpp
+ *  \brief Composite iterator whose delegate iterators are iterated concurrently
+ */
+
+#ifndef _GATB_CORE_DP_ITERATOR_IMPL_PARALLEL_COMPOSITE_ITERATOR_HPP_
+#define _GATB_CORE_DP_ITERATOR_IMPL_PARALLEL_COMPOSITE_ITERATOR_HPP_
+
+#include <gatb/tools/designpattern/api/Iterator.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+
+/********************************************************************************/
+namespace gatb  {
+namespace core  {
+namespace tools {
+namespace dp    {
+namespace impl  {
+/********************************************************************************/
+
+/** \brief Composite iterator whose delegate iterators are iterated by several threads
+ *
+ * Like CompositeIterator, this iterator provides the items of a list of iterators (typically
+ * the sequences of the files of a BankAlbum). Here, several reader threads iterate the delegate
+ * iterators concurrently: each reader takes the next delegate iterator not iterated yet and
+ * puts its items, by batches, into a bounded queue dedicated to this delegate iterator.
+ *
+ * The items can be consumed in two ways:
+ *  - through the iterators returned by getComposition: the ith one provides the items of the ith
+ *    delegate iterator only, in their original order. These iterators must be used one after the other,
+ *    in the order of the composition; meanwhile, the readers parse the next delegate iterators ahead.
+ *  - through this iterator, which goes through these iterators one after the other, as CompositeIterator
+ *    does. The index of the delegate iterator that provided the current item is given by getCompositionIndex.
+ *
+ * The two ways must not be mixed during one iteration. As for other iterators, the consuming methods
+ * must not be called by several threads at the same time (see Dispatcher::iterate).
+ *
+ * The items are swapped (not copied) from the batches to the consumer; the Item type may provide a
+ * swap function found by argument dependent lookup (see Sequence), std::swap being used otherwise.
+ *
+ * A delegate iterator is finalized once all its items have been read.
+ */
+template <class Item> class ParallelCompositeIterator : public Iterator<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] iterators : the delegate iterators
+     * \param[in] nbReaders : number of threads iterating the delegate iterators
+     * \param[in] batchSize : number of items in a batch
+     * \param[in] nbBatches : maximum number of batches in the queue of a delegate iterator
+     */
+    ParallelCompositeIterator (const std::vector <Iterator<Item>*>& iterators, size_t nbReaders, size_t batchSize=1000, size_t nbBatches=4)
+        : _iterators(iterators), _nbReaders(nbReaders>0 ? nbReaders : 1), _batchSize(batchSize>0 ? batchSize : 1), _nbBatches(nbBatches>0 ? nbBatches : 1),
+          _queues(iterators.size()), _cursors(iterators.size()), _channelStarted(iterators.size(), false),
+          _synchro(0), _isStarted(false), _stop(false), _nextIterator(0), _current(0)
+    {
+        _synchro = system::impl::System::thread().newSynchronizer();
+
+        for (size_t i=0; i<_iterators.size(); i++)
+        {
+            _iterators[i]->use();
+            _channels.push_back (new Channel (*this, i));
+            _channels[i]->use();
+        }
+    }
+
+    /** Destructor. */
+    virtual ~ParallelCompositeIterator ()
+    {
+        stop ();
+
+        for (size_t i=0; i<_iterators.size(); i++)  {  _iterators[i]->forget();  _channels[i]->forget();  }
+        for (size_t i=0; i<_free.size();      i++)  {  delete _free[i];  }
+
+        delete _synchro;
+    }
+
+    /** \copydoc Iterator::first */
+    void first()
+    {
+        _current = 0;
+        if (_iterators.empty() == false)  {  startChannel (_current);  fetch (_current, this->_item);  skipDone ();  }
+    }
+
+    /** \copydoc Iterator::next */
+    void next()  {  fetch (_current, this->_item);  skipDone ();  }
+
+    /** \copydoc Iterator::isDone */
+    bool isDone() { return _iterators.empty() || _cursors[_current].done; }
+
+    /** \copydoc Iterator::item */
+    Item& item ()  {  return *(this->_item);  }
+
+    /** \copydoc Iterator::finalize */
+    void finalize ()  {  stop ();  }
+
+    /** Get the index (in the composition) of the delegate iterator that provided the current item.
+     * \return the index of the delegate iterator. */
+    size_t getCompositionIndex () const  { return _current; }
+
+    /** Get iterators on the items of each delegate iterator; they must be iterated in the order of the vector.
+     * \return the vector of iterators. */
+    std::vector<Iterator<Item>*> getComposition()  {  return std::vector<Iterator<Item>*> (_channels.begin(), _channels.end());  }
+
+private:
+
+    /** Some items of one delegate iterator. */
+    struct Batch
+    {
+        std::vector<Item> items;
+    };
+
+    /** Queue of the batches of one delegate iterator. */
+    struct Queue
+    {
+        Queue () : done(false)  {}
+        std::deque<Batch*> batches;
+        bool done;
+    };
+
+    /** Position of a consumer in its current batch. */
+    struct Cursor
+    {
+        Cursor () : batch(0), pos(0), done(true)  {}
+        Batch* batch;
+        size_t pos;
+        bool   done;
+    };
+
+    /** Iterator on the items of one delegate iterator. */
+    class Channel : public Iterator<Item>
+    {
+    public:
+        Channel (ParallelCompositeIterator& ref, size_t idx) : _ref(ref), _idx(idx)  {}
+
+        void  first  ()  {  _ref.startChannel (_idx);  _ref.fetch (_idx, this->_item);  }
+        void  next   ()  {  _ref.fetch (_idx, this->_item);  }
+        bool  isDone ()  {  return _ref._cursors[_idx].done;  }
+        Item& item   ()  {  return *(this->_item);  }
+
+        /** The delegate iterator is finalized by the readers. */
+        void finalize ()  {}
+
+    private:
+        ParallelCompositeIterator& _ref;
+        size_t                     _idx;
+    };
+
+    std::vector <Iterator<Item>*> _iterators;
+    std::vector <Channel*>        _channels;
+
+    size_t _nbReaders;
+    size_t _batchSize;
+    size_t _nbBatches;
+
+    std::vector<Queue>  _queues;
+    std::vector<Cursor> _cursors;   // one per channel
+    std::vector<bool>   _channelStarted;
+    std::vector<Batch*> _free;
+
+    std::vector<system::IThread*> _threads;
+    system::ISynchronizer*        _synchro;
+
+    bool        _isStarted;
+    bool        _stop;
+    size_t      _nextIterator;
+    size_t      _current;       // channel iterated by this iterator
+    std::string _error;
+
+    /** Launch the readers. */
+    void start ()
+    {
+        stop ();
+
+        for (size_t i=0; i<_queues.size(); i++)  {  _queues[i].done = false;  _channelStarted[i] = false;  }
+
+        _stop         = false;
+        _nextIterator = 0;
+        _error.clear();
+        _isStarted    = true;
+
+        size_t nbThreads = std::min (_nbReaders, _iterators.size());
+        for (size_t i=0; i<nbThreads; i++)  {  _threads.push_back (system::impl::System::thread().newThread (mainloop, this));  }
+    }
+
+    /** Stop the readers and recycle the batches. */
+    void stop ()
+    {
+        if (_isStarted == false)  { return; }
+
+        _synchro->lock ();
+        _stop = true;
+        _synchro->notify ();
+        _synchro->unlock ();
+
+        for (size_t i=0; i<_threads.size(); i++)  {  _threads[i]->join ();  delete _threads[i];  }
+        _threads.clear ();
+
+        for (size_t i=0; i<_queues.size(); i++)
+        {
+            _free.insert (_free.end(), _queues[i].batches.begin(), _queues[i].batches.end());
+            _queues[i].batches.clear();
+        }
+        for (size_t i=0; i<_cursors.size(); i++)
+        {
+            if (_cursors[i].batch != 0)  {  _free.push_back (_cursors[i].batch);  }
+            _cursors[i] = Cursor();
+        }
+
+        _isStarted = false;
+    }
+
+    /** The channels share the readers: the readers are launched again when a channel is iterated twice. */
+    void startChannel (size_t idx)
+    {
+        if (_isStarted == false || _channelStarted[idx] == true)  {  start ();  }
+        _channelStarted[idx] = true;
+    }
+
+    /** The iteration of this iterator goes to the next channel when the current one is done. */
+    void skipDone ()
+    {
+        while (_cursors[_current].done && _current+1 < _iterators.size())
+        {
+            _current++;
+            startChannel (_current);
+            fetch (_current, this->_item);
+        }
+    }
+
+    /** Go to the next item of a channel.
+     * \param[in] idx : index of the channel
+     * \param[in] item : object to be filled */
+    void fetch (size_t idx, Item* item)
+    {
+        using std::swap;
+
+        Cursor& cursor = _cursors[idx];
+
+        if (cursor.batch != 0 && ++cursor.pos < cursor.batch->items.size())
+        {
+            swap (*item, cursor.batch->items[cursor.pos]);
+            return;
+        }
+
+        _synchro->lock ();
+
+        /** We recycle the previous batch. */
+        if (cursor.batch != 0)  {  _free.push_back (cursor.batch);  cursor.batch = 0;  _synchro->notify ();  }
+
+        Queue& queue = _queues[idx];
+
+        while (queue.batches.empty() && queue.done == false && _error.empty())  {  _synchro->wait ();  }
+
+        if (queue.batches.empty() == false)
+        {
+            cursor.batch = queue.batches.front();
+            queue.batches.pop_front ();
+            _synchro->notify ();
+        }
+
+        std::string error = _error;
+
+        _synchro->unlock ();
+
+        if (error.empty() == false)  {  throw system::Exception ("%s", error.c_str());  }
+
+        cursor.done = cursor.batch == 0;
+        cursor.pos  = 0;
+
+        if (cursor.batch != 0)  {  swap (*item, cursor.batch->items[0]);  }
+    }
+
+    static void* mainloop (void* arg)  {  ((ParallelCompositeIterator*)arg)->read ();  return 0;  }
+
+    /** Main loop of a reader. */
+    void read ()
+    {
+        while (true)
+        {
+            _synchro->lock ();
+            size_t idx = _nextIterator++;
+            bool   ok  = _stop == false && idx < _iterators.size();
+            _synchro->unlock ();
+
+            if (ok == false)  { break; }
+
+            Iterator<Item>* it = _iterators[idx];
+
+            try
+            {
+                it->reset ();
+
+                for (bool isRunning=true; isRunning; )
+                {
+                    Batch* batch = getFreeBatch ();
+                    if (batch == 0)  {  return;  }
+
+                    batch->items.resize (_batchSize);
+
+                    /** We fill the batch directly from the delegate iterator. */
+                    isRunning = it->get (batch->items);
+
+                    if (put (idx, batch) == false)  { return; }
+                }
+
+                it->finalize ();
+            }
+            catch (system::Exception& e)
+            {
+                /** The exception is forwarded to the consumer. */
+                system::LocalSynchronizer ls (_synchro);
+                _error = e.getMessage();
+                _synchro->notify ();
+                return;
+            }
+            catch (...)
+            {
+                system::LocalSynchronizer ls (_synchro);
+                _error = "unknown exception while iterating a delegate iterator";
+                _synchro->notify ();
+                return;
+            }
+
+            system::LocalSynchronizer ls (_synchro);
+            _queues[idx].done = true;
+            _synchro->notify ();
+        }
+    }
+
+    /** Get a recycled batch (or a new one). Return 0 if the readers are stopped. */
+    Batch* getFreeBatch ()
+    {
+        system::LocalSynchronizer ls (_synchro);
+
+        if (_stop)  { return 0; }
+
+        if (_free.empty())  { return new Batch(); }
+
+        Batch* result = _free.back();
+        _free.pop_back ();
+        return result;
+    }
+
+    /** Put a batch in the queue of a delegate iterator, waiting for room if needed.
+     * Return false if the readers are stopped. */
+    bool put (size_t idx, Batch* batch)
+    {
+        system::LocalSynchronizer ls (_synchro);
+
+        if (batch->items.empty())  {  _free.push_back (batch);  return _stop == false;  }
+
+        while (_stop == false && _queues[idx].batches.size() >= _nbBatches)  {  _synchro->wait ();  }
+
+        if (_stop)  {  _free.push_back (batch);  return false;  }
+
+        _queues[idx].batches.push_back (batch);
+        _synchro->notify ();
+        return true;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_DP_ITERATOR_IMPL_PARALLEL_COMPOSITE_ITERATOR_HPP_ */
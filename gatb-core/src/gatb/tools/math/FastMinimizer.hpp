@@ -35,7 +35,8 @@ extern const unsigned char revcomp_4NT[];
 template<typename T, typename minimizer_type> inline void fastLexiMinimizerChunk (T val, const unsigned int _nbMinimizers, const unsigned int m, const minimizer_type high_bits, minimizer_type &minimizer, size_t &position, size_t position_offset, bool &AA_found) 
 {
     // FIXME: useless for minimizer size larger than 16 just because of the 0x55555555 mask 
-    if (m > 16) {AA_found = false; return;}
+    // the reverse complement below only knows mmers of up to 8 nucleotides; the caller falls back to the normal method
+    if (m > 8) {AA_found = false; return;}
     
     /* those require only a single AND operation, rest are constants */
     #define BINARY_MMER_STARTS_WITH_2MER(val,m,binnucl) ((val & (15 << (2*(m-2)))) == (binnucl << (2*(m-2))) )
@@ -70,7 +71,7 @@ template<typename T, typename minimizer_type> inline void fastLexiMinimizerChunk
 
         if (mmer_ends_with_TT)
         {
-            minimizer_type candidate_revcomp = ((revcomp_4NT [val&0xFF] << 8) | revcomp_4NT [(val>>8)&0xFF]) & m_mask; 
+            minimizer_type candidate_revcomp = ((revcomp_4NT [val&0xFF] << 8) | revcomp_4NT [(val>>8)&0xFF]) >> (2*(8-m));
             if (mmer_starts_with_AA) 
                 candidate = std::min(candidate, candidate_revcomp);
             else
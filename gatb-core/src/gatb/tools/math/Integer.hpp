@@ -255,6 +255,13 @@ public:
      */
     friend u_int64_t hash1        (const IntegerTemplate& a,  u_int64_t seed)  {  return  boost::apply_visitor (Integer_hash1(seed),  *a);          }
 
+    /** Get a hash value on 64 bits for a given IntegerTemplate object (one multiplication per word).
+     * \param[in] a : the integer value
+     * \param[in] seed : some seed value used for the hash computation.
+     * \return the hash value on 64 bits.
+     */
+    friend u_int64_t foldhash     (const IntegerTemplate& a,  u_int64_t seed)  {  return  boost::apply_visitor (Integer_foldhash(seed),  *a);       }
+
     /** Get a hash value on 64 bits for a given IntegerTemplate object.
      * \param[in] a : the integer value
      * \return the hash value on 64 bits.
@@ -408,6 +415,10 @@ private:
         Integer_hash1 (const u_int64_t& c) : Visitor<u_int64_t,u_int64_t>(c) {}
         template<typename T>  u_int64_t operator() (const T& a) const  { return (hash1(a,this->arg));  }};
 
+    struct Integer_foldhash : public Visitor<u_int64_t,u_int64_t>    {
+        Integer_foldhash (const u_int64_t& c) : Visitor<u_int64_t,u_int64_t>(c) {}
+        template<typename T>  u_int64_t operator() (const T& a) const  { return (foldhash(a,this->arg));  }};
+
     struct Integer_oahash : public boost::static_visitor<u_int64_t>    {
         template<typename T>  u_int64_t operator() (const T& a) const  { return (oahash(a));  }};
 
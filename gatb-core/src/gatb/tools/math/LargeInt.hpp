@@ -42,6 +42,10 @@
 #include <gatb/tools/math/NativeInt64.hpp>
 #include <gatb/tools/math/FastMinimizer.hpp>
 
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
 #ifndef ASSERTS
 #define NDEBUG // disable asserts; those asserts make sure that with PRECISION == [1 or 2], all is correct
 #endif
@@ -601,12 +605,13 @@ public:
      * \param[in] idx : index of the nucleotide to be retrieved
      * \return the nucleotide value as follow: A=0, C=1, T=2 and G=3
      */
-    u_int8_t  operator[]  (size_t idx) const    {  return (this->value[idx/32] >> (2*idx)) & 3; } // FIXME (or delete this comment): isn't this buggy when idx > 32? then the shift becomes more than 64. needs to be tested.
+    u_int8_t  operator[]  (size_t idx) const    {  return (this->value[idx/32] >> (2*(idx%32))) & 3; }
 
 private:
 
     template<int T>  friend LargeInt<T> revcomp (const LargeInt<T>& i, size_t sizeKmer);
     template<int T>  friend u_int64_t   hash1    (const LargeInt<T>& key, u_int64_t  seed);
+    template<int T>  friend u_int64_t   foldhash (const LargeInt<T>& key, u_int64_t  seed);
     template<int T>  friend u_int64_t   oahash  (const LargeInt<T>& key);
     template<int T>  friend u_int64_t   simplehash16    (const LargeInt<T>& key, int  shift);
     template<int T, typename m_T>  \
@@ -619,18 +624,40 @@ private:
     // 2 months later: I don't understand this fun fact anymore. thanks c++.
 };
 
+#ifdef __SSSE3__
 /********************************************************************************/
-template<int precision>  inline LargeInt<precision> revcomp (const LargeInt<precision>& x, size_t sizeKmer)
+/** Reverse complement of the 64 nucleotides of a 128 bits register: each nibble (2 nucleotides)
+ * is reverse complemented with a 16 entries table lookup (pshufb), then the 16 bytes are reversed. */
+inline __m128i revcompSSSE3 (__m128i x)
 {
-    const LargeInt<precision> res = x;
+    const __m128i mask  = _mm_set1_epi8 (0x0F);
+    const __m128i lowNT = _mm_setr_epi8 (0xA0,0xE0,0x20,0x60,0xB0,0xF0,0x30,0x70,0x80,0xC0,0x00,0x40,0x90,0xD0,0x10,0x50);
+    const __m128i highNT= _mm_setr_epi8 (0x0A,0x0E,0x02,0x06,0x0B,0x0F,0x03,0x07,0x08,0x0C,0x00,0x04,0x09,0x0D,0x01,0x05);
+    const __m128i order = _mm_setr_epi8 (15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+
+    __m128i res = _mm_or_si128 (
+        _mm_shuffle_epi8 (lowNT,  _mm_and_si128 (x, mask)),
+        _mm_shuffle_epi8 (highNT, _mm_and_si128 (_mm_srli_epi16 (x, 4), mask))
+    );
+    return _mm_shuffle_epi8 (res, order);
+}
+#endif
 
-    unsigned char* kmerrev  = (unsigned char *) (&(res.value[0]));
-    unsigned char* kmer     = (unsigned char *) (&(x.value[0]));
+/********************************************************************************/
+template<int precision>  inline LargeInt<precision> revcomp (const LargeInt<precision>& x, size_t sizeKmer)
+{
+    /** The words are reverse complemented one by one and stored in reverse order; the
+     * 2*(32*precision-sizeKmer) unused bits then end up on the low side and are shifted out. */
+    LargeInt<precision> res;
 
-    for (size_t i=0; i<8*precision; ++i)
+    int i=0;
+#ifdef __SSSE3__
+    for ( ; i+2<=precision; i+=2)
     {
-        kmerrev[8*precision-1-i] = revcomp_4NT [kmer[i]];
+        _mm_storeu_si128 ((__m128i*) (res.value + precision-2-i), revcompSSSE3 (_mm_loadu_si128 ((const __m128i*) (x.value + i))));
     }
+#endif
+    for ( ; i<precision; ++i)  {  res.value[precision-1-i] = NativeInt64::revcompWord (x.value[i]);  }
 
     return (res >> (2*( 32*precision - sizeKmer))  ) ;
 }
@@ -638,48 +665,41 @@ template<int precision>  inline LargeInt<precision> revcomp (const LargeInt<prec
 /********************************************************************************/
 template<int precision>  inline u_int64_t hash1 (const LargeInt<precision>& elem, u_int64_t seed=0)
 {
-    // hash = XOR_of_series[hash(i-th chunk iof 64 bits)]
-    u_int64_t result = 0, chunk, mask = ~0;
+    // hash = XOR_of_series[hash(i-th chunk iof 64 bits)]; the i-th chunk is the i-th word.
+    u_int64_t result = 0;
 
-    LargeInt<precision> intermediate = elem;
-    for (size_t i=0;i<precision;i++)
-    {
-        chunk = (intermediate & mask).value[0];
-        intermediate = intermediate >> 64;
+    for (size_t i=0;i<precision;i++)  {  result ^= NativeInt64::hash64 (elem.value[i],seed);  }
 
-        result ^= NativeInt64::hash64 (chunk,seed);
-    }
     return result;
 }
 
+/********************************************************************************/
+/** Hash of the words of an integer, one multiplication per word (see NativeInt64::foldhash64).
+ * Unlike hash1, the words are chained so the hash depends on their order. */
+template<int precision>  inline u_int64_t foldhash (const LargeInt<precision>& elem, u_int64_t seed=0)
+{
+    u_int64_t result = seed;
+
+    for (size_t i=0;i<precision;i++)  {  result = NativeInt64::foldhash64 (elem.value[i], result);  }
+
+    return NativeInt64::foldhash64End (result);
+}
+
 /********************************************************************************/
 template<int precision>  u_int64_t oahash (const LargeInt<precision>& elem)
 {
-    // hash = XOR_of_series[hash(i-th chunk iof 64 bits)]
-    u_int64_t result = 0, chunk, mask = ~0;
+    // hash = XOR_of_series[hash(i-th chunk iof 64 bits)]; the i-th chunk is the i-th word.
+    u_int64_t result = 0;
+
+    for (size_t i=0;i<precision;i++)  {  result ^= NativeInt64::oahash64 (elem.value[i]);  }
 
-    LargeInt<precision> intermediate = elem;
-    for (size_t i=0;i<precision;i++)
-    {
-        chunk = (intermediate & mask).value[0];
-        intermediate = intermediate >> 64;
-        result ^= NativeInt64::oahash64 (chunk);
-    }
     return result;
 }
 
-	
-
 /********************************************************************************/
 template<int precision> inline u_int64_t simplehash16 (const LargeInt<precision>& elem, int  shift)
 {
-    u_int64_t result = 0, chunk, mask = ~0;
-    LargeInt<precision> intermediate = elem;
-    
-    chunk = (intermediate & mask).value[0];
-    result ^= NativeInt64::simplehash16_64 (chunk,shift);
-
-    return result;
+    return NativeInt64::simplehash16_64 (elem.value[0],shift);
 }
 
 /*
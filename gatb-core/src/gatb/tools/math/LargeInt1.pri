@@ -60,12 +60,17 @@ public:
 
     LargeInt<1>& operator+=  (const LargeInt<1>& other)    {  value[0] += other.value[0]; return *this; }
     LargeInt<1>& operator^=  (const LargeInt<1>& other)    {  value[0] ^= other.value[0]; return *this; }
+    LargeInt<1>& operator&=  (const LargeInt<1>& other)    {  value[0] &= other.value[0]; return *this; }
+    LargeInt<1>& operator|=  (const LargeInt<1>& other)    {  value[0] |= other.value[0]; return *this; }
 
     LargeInt<1>& operator<<=  (const int& coeff)  { value[0] <<= coeff; return *this; } 
     LargeInt<1>& operator>>=  (const int& coeff)  { value[0] >>= coeff; return *this; }
 
     u_int8_t  operator[]  (size_t idx) const   {  return (value[0] >> (2*idx)) & 3; }
 
+    LargeInt<1>& sync_fetch_and_or  (const LargeInt<1>& other)  {  __sync_fetch_and_or  (value, other.value[0]);  return *this;  }
+    LargeInt<1>& sync_fetch_and_and (const LargeInt<1>& other)  {  __sync_fetch_and_and (value, other.value[0]);  return *this;  }
+
     /********************************************************************************/
     friend std::ostream & operator<<(std::ostream & s, const LargeInt<1> & l)
     {
@@ -118,21 +123,7 @@ public:
     /********************************************************************************/
     inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
     {
-        u_int64_t res = x;
-
-        // OLD VERSION (with lookup table)
-        // unsigned char* kmerrev  = (unsigned char *) (&(res));
-        // unsigned char* kmer     = (unsigned char *) (&(x));
-        // for (size_t i=0; i<8; ++i)  {  kmerrev[8-1-i] = revcomp_4NT [kmer[i]];  }
-
-        res = ((res>> 2 & 0x3333333333333333) | (res & 0x3333333333333333) <<  2);
-        res = ((res>> 4 & 0x0F0F0F0F0F0F0F0F) | (res & 0x0F0F0F0F0F0F0F0F) <<  4);
-        res = ((res>> 8 & 0x00FF00FF00FF00FF) | (res & 0x00FF00FF00FF00FF) <<  8);
-        res = ((res>>16 & 0x0000FFFF0000FFFF) | (res & 0x0000FFFF0000FFFF) << 16);
-        res = ((res>>32 & 0x00000000FFFFFFFF) | (res & 0x00000000FFFFFFFF) << 32);
-        res = res ^ 0xAAAAAAAAAAAAAAAA;
-        
-        return (res >> (2*(32-sizeKmer))) ;
+        return NativeInt64::revcomp64 (x, sizeKmer);
     }
 
     /********************************************************************************/
@@ -211,6 +202,7 @@ private:
 
     friend LargeInt<1> revcomp (const LargeInt<1>& i,   size_t sizeKmer);
     friend u_int64_t    hash1    (const LargeInt<1>& key, u_int64_t  seed);
+    friend u_int64_t    foldhash (const LargeInt<1>& key, u_int64_t  seed);
     friend u_int64_t    oahash  (const LargeInt<1>& key);
     friend u_int64_t    simplehash16    (const LargeInt<1>& key, int  shift);
 
@@ -229,6 +221,12 @@ inline u_int64_t hash1 (const LargeInt<1>& key, u_int64_t seed=0)
     return LargeInt<1>::hash64 (key.value[0], seed);
 }
 
+/********************************************************************************/
+inline u_int64_t foldhash (const LargeInt<1>& key, u_int64_t seed=0)
+{
+    return NativeInt64::foldhash64End (NativeInt64::foldhash64 (key.value[0], seed));
+}
+
 /********************************************************************************/
 inline u_int64_t oahash (const LargeInt<1>& key)
 {
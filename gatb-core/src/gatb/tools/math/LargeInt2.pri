@@ -60,11 +60,32 @@ public:
 
     LargeInt<2>& operator+=  (const LargeInt<2>& other)    {  value[0] += other.value[0]; return *this; }
     LargeInt<2>& operator^=  (const LargeInt<2>& other)    {  value[0] ^= other.value[0]; return *this; }
+    LargeInt<2>& operator&=  (const LargeInt<2>& other)    {  value[0] &= other.value[0]; return *this; }
+    LargeInt<2>& operator|=  (const LargeInt<2>& other)    {  value[0] |= other.value[0]; return *this; }
 
     LargeInt<2>& operator<<=  (const int& coeff)  { value[0] <<= coeff; return *this; } 
     LargeInt<2>& operator>>=  (const int& coeff)  { value[0] >>= coeff; return *this; }
 
-    u_int8_t  operator[]  (size_t idx) const   {  return (value[0] >> (2*idx)) & 3; }
+    /** Operator[] access the ith nucleotide; reading the 64 bits half that holds it avoids a variable 128 bits shift. */
+    u_int8_t  operator[]  (size_t idx) const   {  return ((idx < 32 ? (u_int64_t)value[0] : (u_int64_t)(value[0] >> 64)) >> (2*(idx%32))) & 3; }
+
+    /********************************************************************************/
+    /** Synchronized atomic operations, done on each 64 bits half (there is no 128 bits atomic 'or').
+     * \param[in] other : operand
+     */
+    LargeInt<2>& sync_fetch_and_or (const LargeInt<2>& other)
+    {
+        __sync_fetch_and_or  ((u_int64_t*)value + 0, (u_int64_t) other.value[0]);
+        __sync_fetch_and_or  ((u_int64_t*)value + 1, (u_int64_t)(other.value[0] >> 64));
+        return *this;
+    }
+
+    LargeInt<2>& sync_fetch_and_and (const LargeInt<2>& other)
+    {
+        __sync_fetch_and_and ((u_int64_t*)value + 0, (u_int64_t) other.value[0]);
+        __sync_fetch_and_and ((u_int64_t*)value + 1, (u_int64_t)(other.value[0] >> 64));
+        return *this;
+    }
 
     /** Output stream overload. NOTE: for easier process, dump the value in hexadecimal.
      * \param[in] os : the output stream
@@ -91,7 +112,7 @@ public:
     inline void printASCII ( size_t sizeKmer = 64)
     {
         int i;
-        u_int64_t temp = value[0];
+        __uint128_t temp = value[0];
         
         
         char seq[65];
@@ -141,6 +162,7 @@ public:
 private:
     friend LargeInt<2> revcomp (const LargeInt<2>& i,   size_t sizeKmer);
     friend u_int64_t    hash1    (const LargeInt<2>& key, u_int64_t  seed);
+    friend u_int64_t    foldhash (const LargeInt<2>& key, u_int64_t  seed);
     friend u_int64_t    oahash  (const LargeInt<2>& key);
     friend u_int64_t    simplehash16    (const LargeInt<2>& key, int  shift);
     template<typename m_T> friend void fastLexiMinimizer (const LargeInt<2>& x, const unsigned int _nbMinimizers, \
@@ -157,24 +179,22 @@ inline LargeInt<2> revcomp (const LargeInt<2>& in, size_t sizeKmer)
     //
     // ex:            [         AC  | .......TG   ]
     //
-    //revcomp:        [         CA  | .......GT   ]
-    //                 \_low_nucl__/\high_nucl/
+    //revcomp:        [ .......GT   |         CA  ] >> 2*(64-sizeKmer)
+    //                 \_low_nucl__/ \_high_nucl_/
+    //
+    // Each word is reverse complemented as 32 nucleotides and the two words are swapped, so the
+    // unused bits end up on the low side; the shift is at most 126 bits, whatever sizeKmer is.
 
     const __uint128_t& x = in.value[0];
 
-    u_int64_t high_nucl = (u_int64_t)(x>>64);
-    int nb_high_nucl = sizeKmer>32?sizeKmer - 32:0;
-
-    __uint128_t revcomp_high_nucl = NativeInt64::revcomp64 (high_nucl, nb_high_nucl);
+#ifdef __SSSE3__
+    __uint128_t res;
+    _mm_storeu_si128 ((__m128i*) &res, revcompSSSE3 (_mm_loadu_si128 ((const __m128i*) &x)));
+#else
+    __uint128_t res = ((__uint128_t) NativeInt64::revcompWord ((u_int64_t) x) << 64) | NativeInt64::revcompWord ((u_int64_t) (x>>64));
+#endif
 
-    if (sizeKmer<=32) revcomp_high_nucl = 0; // srsly dunno why this is needed. gcc bug? u_int64_t x ---> (x>>64) != 0
-
-    u_int64_t low_nucl = (u_int64_t)(x&((((__uint128_t)1)<<64)-1));
-    int nb_low_nucl = sizeKmer>32?32:sizeKmer;
-
-    __uint128_t revcomp_low_nucl = NativeInt64::revcomp64 (low_nucl, nb_low_nucl);
-
-    return (revcomp_low_nucl<<(2*nb_high_nucl)) + revcomp_high_nucl;
+    return res >> (2*(64-sizeKmer));
 }
 
 /********************************************************************************/
@@ -186,6 +206,14 @@ inline u_int64_t hash1 (const LargeInt<2>& item, u_int64_t seed=0)
            NativeInt64::hash64 ((u_int64_t)(elem&((((__uint128_t)1)<<64)-1)),seed);
 }
 
+/********************************************************************************/
+inline u_int64_t foldhash (const LargeInt<2>& item, u_int64_t seed=0)
+{
+    const __uint128_t& elem = item.value[0];
+
+    return NativeInt64::foldhash64End (NativeInt64::foldhash64 ((u_int64_t)(elem>>64), NativeInt64::foldhash64 ((u_int64_t)elem, seed)));
+}
+
 /********************************************************************************/
 inline u_int64_t oahash (const LargeInt<2>& item)
 {
@@ -60,7 +60,7 @@ public:
 
     static const char* getName ()  { return "NativeInt128"; }
 
-    u_int64_t getVal ()  { return *value; }
+    u_int64_t getVal () const  { return *value; }
 
     static const size_t getSize ()  { return 8*sizeof(__uint128_t); }
 
@@ -88,17 +88,22 @@ public:
     NativeInt128& operator<<= (const int& coeff)             {  value[0] <<= coeff;         return *this; }
     NativeInt128& operator>>= (const int& coeff)             {  value[0] >>= coeff;         return *this; }
 
+    /** Operator[] access the ith nucleotide; reading the 64 bits half that holds it avoids a variable 128 bits shift. */
+    u_int8_t  operator[]  (size_t idx) const   {  return ((idx < 32 ? (u_int64_t)value[0] : (u_int64_t)(value[0] >> 64)) >> (2*(idx%32))) & 3; }
+
     /********************************************************************************/
     NativeInt128& sync_fetch_and_or (const NativeInt128& other)
     {
-        for (int i=0 ; i < 2 ; i++)  {  __sync_fetch_and_or ((u_int64_t*)(value + i), other.value[i]); }
+        __sync_fetch_and_or  ((u_int64_t*)value + 0, (u_int64_t) other.value[0]);
+        __sync_fetch_and_or  ((u_int64_t*)value + 1, (u_int64_t)(other.value[0] >> 64));
         return *this;
     }
 
     /********************************************************************************/
     NativeInt128& sync_fetch_and_and (const NativeInt128& other)
     {
-        for (int i=0 ; i < 2 ; i++)  {  __sync_fetch_and_and (this->value + i, other.value[i]); }
+        __sync_fetch_and_and ((u_int64_t*)value + 0, (u_int64_t) other.value[0]);
+        __sync_fetch_and_and ((u_int64_t*)value + 1, (u_int64_t)(other.value[0] >> 64));
         return *this;
     }
 
@@ -127,7 +132,7 @@ public:
     inline void printASCII ( size_t sizeKmer = 64)
     {
         int i;
-        u_int64_t temp = value[0];
+        __uint128_t temp = value[0];
 
 
         char seq[65];
@@ -154,6 +159,7 @@ public:
 private:
     friend NativeInt128 revcomp (const NativeInt128& i,   size_t sizeKmer);
     friend u_int64_t    hash1    (const NativeInt128& key, u_int64_t  seed);
+    friend u_int64_t    foldhash (const NativeInt128& key, u_int64_t  seed);
     friend u_int64_t    oahash  (const NativeInt128& key);
     friend u_int64_t    simplehash16    (const NativeInt128& key, int  shift);
 
@@ -167,24 +173,17 @@ inline NativeInt128 revcomp (const NativeInt128& in, size_t sizeKmer)
     //
     // ex:            [         AC  | .......TG   ]
     //
-    //revcomp:        [         CA  | .......GT   ]
-    //                 \_low_nucl__/\high_nucl/
+    //revcomp:        [ .......GT   |         CA  ] >> 2*(64-sizeKmer)
+    //                 \_low_nucl__/ \_high_nucl_/
+    //
+    // Each word is reverse complemented as 32 nucleotides and the two words are swapped, so the
+    // unused bits end up on the low side; the shift is at most 126 bits, whatever sizeKmer is.
 
     const __uint128_t& x = in.value[0];
 
-    u_int64_t high_nucl = (u_int64_t)(x>>64);
-    int nb_high_nucl = sizeKmer>32?sizeKmer - 32:0;
-
-    __uint128_t revcomp_high_nucl = NativeInt64::revcomp64 (high_nucl, nb_high_nucl);
-
-    if (sizeKmer<=32) revcomp_high_nucl = 0; // srsly dunno why this is needed. gcc bug? u_int64_t x ---> (x>>64) != 0
-
-    u_int64_t low_nucl = (u_int64_t)(x&((((__uint128_t)1)<<64)-1));
-    int nb_low_nucl = sizeKmer>32?32:sizeKmer;
-
-    __uint128_t revcomp_low_nucl = NativeInt64::revcomp64 (low_nucl, nb_low_nucl);
+    __uint128_t res = ((__uint128_t) NativeInt64::revcompWord ((u_int64_t) x) << 64) | NativeInt64::revcompWord ((u_int64_t) (x>>64));
 
-    return (revcomp_low_nucl<<(2*nb_high_nucl)) + revcomp_high_nucl;
+    return res >> (2*(64-sizeKmer));
 }
 
 /********************************************************************************/
@@ -196,6 +195,14 @@ inline u_int64_t hash1 (const NativeInt128& item, u_int64_t seed=0)
            NativeInt64::hash64 ((u_int64_t)(elem&((((__uint128_t)1)<<64)-1)),seed);
 }
 
+/********************************************************************************/
+inline u_int64_t foldhash (const NativeInt128& item, u_int64_t seed=0)
+{
+    const __uint128_t& elem = item.value[0];
+
+    return NativeInt64::foldhash64End (NativeInt64::foldhash64 ((u_int64_t)(elem>>64), NativeInt64::foldhash64 ((u_int64_t)elem, seed)));
+}
+
 /********************************************************************************/
 inline u_int64_t oahash (const NativeInt128& item)
 {
@@ -142,16 +142,22 @@ public:
 
     
     /********************************************************************************/
-    inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
+    /** Reverse complement of the 32 nucleotides of a word. The 2-bit groups are swapped
+     * inside each byte with masks, then the bytes are reversed with a single bswap; the
+     * complement is a xor since A=0,C=1,T=2,G=3.
+     * \param[in] x : the 32 nucleotides
+     * \return the reverse complement. */
+    inline static u_int64_t revcompWord (u_int64_t x)
     {
-        u_int64_t res = x;
-
-        unsigned char* kmerrev  = (unsigned char *) (&(res));
-        unsigned char* kmer     = (unsigned char *) (&(x));
-
-        for (size_t i=0; i<8; ++i)  {  kmerrev[8-1-i] = revcomp_4NT [kmer[i]];  }
+        x = ((x>>2 & 0x3333333333333333) | (x & 0x3333333333333333) << 2);
+        x = ((x>>4 & 0x0F0F0F0F0F0F0F0F) | (x & 0x0F0F0F0F0F0F0F0F) << 4);
+        return __builtin_bswap64 (x) ^ 0xAAAAAAAAAAAAAAAA;
+    }
 
-        return (res >> (2*( 32 - sizeKmer))) ;
+    /********************************************************************************/
+    inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
+    {
+        return (revcompWord (x) >> (2*( 32 - sizeKmer))) ;
     }
 
 	
@@ -186,6 +192,67 @@ public:
         return hash;
     }
 
+    /********************************************************************************/
+    /** Multiplies two words and folds the 128 bits of the product into 64 bits (xor of the two halves).
+     * This is the mixing step of wyhash: a single multiplication mixes every bit of both words. */
+    inline static u_int64_t fold64 (u_int64_t a, u_int64_t b)
+    {
+#ifdef INT128_FOUND
+        __uint128_t r = (__uint128_t)a * b;
+        return (u_int64_t)r ^ (u_int64_t)(r >> 64);
+#else
+        u_int64_t ha = a >> 32, hb = b >> 32, la = (u_int32_t)a, lb = (u_int32_t)b;
+        u_int64_t rh = ha*hb, rm0 = ha*lb, rm1 = hb*la, rl = la*lb, t = rl + (rm0 << 32), c = t < rl;
+        u_int64_t lo = t + (rm1 << 32);  c += lo < t;
+        u_int64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+        return lo ^ hi;
+#endif
+    }
+
+    /********************************************************************************/
+    /** Step of the hash of a multi words integer (see foldhash): mixes one word into the current hash.
+     * \param[in] word : the word to be mixed
+     * \param[in] hash : the current hash (the seed for the first word)
+     * \return the new hash. */
+    inline static u_int64_t foldhash64 (u_int64_t word, u_int64_t hash)
+    {
+        return fold64 (word ^ 0xa0761d6478bd642fULL, hash ^ 0xe7037ed1a0b428dbULL);
+    }
+
+    /********************************************************************************/
+    /** Last step of the hash of a multi words integer (see foldhash).
+     * \param[in] hash : the hash of the words
+     * \return the hash value. */
+    inline static u_int64_t foldhash64End (u_int64_t hash)
+    {
+        return fold64 (hash ^ 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL);
+    }
+
+    /********************************************************************************/
+    /** Invertible hash of the bits of a key selected by a mask of the form 2^n-1, so the hash is a
+     * permutation of [0,2^n). The steps are the ones of the murmur3 finalizer (xor with a right shift,
+     * odd multiplication), every one being invertible modulo 2^n. The shifts are scaled to the n bits
+     * of the key: fixed 64 bits shifts would vanish for small keys and leave an almost affine hash.
+     * \param[in] key : key of the hash (lower than mask)
+     * \param[in] mask : mask of the bits of the key
+     * \return the hash value, lower than mask. */
+    inline static u_int64_t hash64Invertible (u_int64_t key, u_int64_t mask)
+    {
+        size_t nbBits = 0;
+        for (u_int64_t m=mask; m!=0; m>>=1)  { nbBits++; }
+
+        size_t shift = (nbBits+1) / 2;
+
+        key = (key + 0x9e3779b97f4a7c15ULL) & mask; // 0 is not a fixed point
+        key = key ^ (key >> shift);
+        key = (key * 0xff51afd7ed558ccdULL) & mask;
+        key = key ^ (key >> shift);
+        key = (key * 0xc4ceb9fe1a85ec53ULL) & mask;
+        key = key ^ (key >> shift);
+
+        return key;
+    }
+
     /********************************************************************************/
     inline static u_int64_t oahash64 (u_int64_t elem)
     {
@@ -229,6 +296,7 @@ private:
 
     friend NativeInt64 revcomp (const NativeInt64& i,   size_t sizeKmer);
     friend u_int64_t    hash1    (const NativeInt64& key, u_int64_t  seed);
+    friend u_int64_t    foldhash (const NativeInt64& key, u_int64_t  seed);
     friend u_int64_t    oahash  (const NativeInt64& key);
     friend u_int64_t    simplehash16    (const NativeInt64& key, int  shift);
 
@@ -247,6 +315,12 @@ inline u_int64_t hash1 (const NativeInt64& key, u_int64_t seed=0)
     return NativeInt64::hash64 (key.value[0], seed);
 }
 
+/********************************************************************************/
+inline u_int64_t foldhash (const NativeInt64& key, u_int64_t seed=0)
+{
+    return NativeInt64::foldhash64End (NativeInt64::foldhash64 (key.value[0], seed));
+}
+
 /********************************************************************************/
 inline u_int64_t oahash (const NativeInt64& key)
 {
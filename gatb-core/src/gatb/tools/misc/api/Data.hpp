@@ -34,8 +34,14 @@
 #include <gatb/tools/misc/api/Vector.hpp>
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /********************************************************************************/
 namespace gatb      {
 namespace core      {
@@ -94,6 +100,7 @@ public:
                 this->set (d.getBuffer(), d.size()/4+1);
                 this->setSize(d.size());
                 this->encoding = BINARY;
+                this->invalidMask = d.invalidMask;
             }
             else
             {
@@ -104,7 +111,9 @@ public:
         return *this;
     }
 
-    /** Set the content of this data as a referenced of another Data object.
+    /** Set the content of this data as a referenced of another Data object. With the BINARY encoding,
+     * the offset is a number of bytes (ie. the data starts at the nucleotide 4*offset of the referred
+     * data) and the invalid nucleotides of the referred range are kept in the mask.
      * \param[in] ref : referred data
      * \param[in] offset : position to be used in the referred data
      * \param[in] length : length of the data
@@ -116,6 +125,31 @@ public:
 
         /** We set the encoding. */
         encoding = ref->getEncoding();
+
+        /** We rebase the runs of the referred mask that overlap the range. */
+        invalidMask.clear();
+        if (encoding == BINARY)
+        {
+            const InvalidMask& mask = ref->getInvalidMask();
+            u_int64_t first = 4*(u_int64_t)offset;
+            u_int64_t last  = first + length;
+
+            for (size_t i=0; i+1<mask.size(); i+=2)
+            {
+                u_int64_t start = std::max (first, (u_int64_t) mask[i]);
+                u_int64_t end   = std::min (last,  (u_int64_t) mask[i] + mask[i+1]);
+                if (start < end)  {  invalidMask.push_back (start - first);  invalidMask.push_back (end - start);  }
+            }
+        }
+    }
+
+    /** Exchange the content of two data, without copying the nucleotides.
+     * \param[in] d : data to be exchanged with the current instance */
+    void swap (Data& d)
+    {
+        Vector<char>::swap (d);
+        std::swap (encoding, d.encoding);
+        invalidMask.swap (d.invalidMask);
     }
 
     /** \copydoc Vector<char>::setRef(char*,size_t) */
@@ -134,6 +168,20 @@ public:
      */
     void setEncoding (Encoding_e encoding)  { this->encoding = encoding; }
 
+    /** Run-length mask of the invalid nucleotides, as successive pairs (start, length) sorted by start.
+     * With the BINARY encoding, a nucleotide is coded on 2 bits and can't tell by itself whether it is
+     * invalid (like N); such nucleotides are then given by this mask (see BankBinary). The mask is not
+     * used with the other encodings. */
+    typedef std::vector<u_int32_t> InvalidMask;
+
+    /** Get the mask of the invalid nucleotides (for the BINARY encoding).
+     * \return the mask. */
+    const InvalidMask& getInvalidMask () const  { return invalidMask; }
+
+    /** Get the mask of the invalid nucleotides (for the BINARY encoding).
+     * \return the mask. */
+    InvalidMask& getInvalidMask ()  { return invalidMask; }
+
     /** Conversion from one encoding scheme to another.
      *  TO BE IMPROVED (support only one kind of conversion, from binary to integer)
      * \param[in] in  : input data
@@ -168,12 +216,46 @@ public:
     struct ConvertInteger  { static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar(buffer[idx],0); }         };
     struct ConvertBinary   { static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar(((buffer[idx>>2] >> ((3-(idx&3))*2)) & 3),0); } };
 
+    /** Conversion of several successive nucleotides at once. Each nucleotide gives one code
+     * holding its value in the 2 lowest bits and its invalid status in the third bit (ie. code
+     * is 'first | second<<2' of the ConvertChar). The ASCII conversion handles 16 nucleotides at
+     * once with SSE2 when available.
+     * \param[in] buffer : the data buffer
+     * \param[in] idx : index of the first nucleotide to convert
+     * \param[in] nb : number of nucleotides to convert
+     * \param[out] codes : the 'nb' codes */
+    template<class Convert> static void convert (const char* buffer, size_t idx, size_t nb, u_int8_t* codes)
+    {
+        for (size_t i=0; i<nb; i++)  {  ConvertChar c = Convert::get (buffer, idx+i);  codes[i] = c.first | (c.second<<2);  }
+    }
+
 private:
 
     /** Encoding scheme of the data instance. */
     Encoding_e  encoding;
+
+    /** Invalid nucleotides for the BINARY encoding. */
+    InvalidMask invalidMask;
 };
 
+/********************************************************************************/
+template<> inline void Data::convert<Data::ConvertASCII> (const char* buffer, size_t idx, size_t nb, u_int8_t* codes)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    /** The nucleotide value is (c>>1)&3 and the invalid status is (c>>3)&1, so the code is (c>>1)&7. */
+    const __m128i seven = _mm_set1_epi8 (7);
+    for ( ; i+16 <= nb; i+=16)
+    {
+        __m128i block = _mm_loadu_si128 ((const __m128i*) (buffer+idx+i));
+        _mm_storeu_si128 ((__m128i*) (codes+i), _mm_and_si128 (_mm_srli_epi16 (block, 1), seven));
+    }
+#endif
+
+    for ( ; i<nb; i++)  {  codes[i] = (buffer[idx+i]>>1) & 7;  }
+}
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
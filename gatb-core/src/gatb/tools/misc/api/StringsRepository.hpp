@@ -67,6 +67,12 @@ public:
     const char* BANK_bad_file_path      () { return "unable to find file '%s'"; }
     const char* BANK_unable_open_file   () { return "error opening file: %s"; }
     const char* BANK_unable_write_file  () { return "unable to write into file"; }
+    const char* BANK_bad_bgzf_block     () { return "corrupted BGZF block in file: %s"; }
+    const char* BANK_bad_gzip_file      () { return "corrupted or truncated gzip file: %s"; }
+    const char* BANK_unable_index_file  () { return "unable to index file %s: %s"; }
+    const char* BANK_unknown_sequence   () { return "unknown sequence '%s' in file %s"; }
+    const char* BANK_bad_sequence_id    () { return "bad sequence index %ld (should be lower than %ld) in file %s"; }
+    const char* BANK_being_written      () { return "unable to read file %s while it is being written"; }
 };
 
 /********************************************************************************/
@@ -111,6 +117,8 @@ public:
     const char* branching_type ()  { return "-branching-nodes";}
     const char* topology_stats ()  { return "-topology-stats";}
     const char* mphf_type ()       { return "-mphf";}
+    const char* mphf_abundance_bits () { return "-mphf-abundance-bits";}
+    const char* mphf_abundance_log  () { return "-mphf-abundance-log";}
     const char* uri_solid_kmers()  { return "-solid-kmers-out";    }
     const char* bank_convert_type ()  { return "-bank-convert";   }
     const char* integer_precision ()  { return "-integer-precision";}
@@ -119,6 +127,7 @@ public:
     const char* repartition_type() { return "-repartition-type"; }
     const char* compress_level()   { return "-out-compress"; }
     const char* config_only()      { return "-config-only"; }
+    const char* distinct_estimate(){ return "-distinct-estimate"; }
 
     const char* attr_uri_input      ()  { return "input";           }
     const char* attr_kmer_size      ()  { return "kmer_size";       }
@@ -164,6 +173,8 @@ public:
 #define STR_BRANCHING_TYPE      gatb::core::tools::misc::StringRepository::singleton().branching_type()
 #define STR_TOPOLOGY_STATS      gatb::core::tools::misc::StringRepository::singleton().topology_stats()
 #define STR_MPHF_TYPE           gatb::core::tools::misc::StringRepository::singleton().mphf_type()
+#define STR_MPHF_ABUNDANCE_BITS gatb::core::tools::misc::StringRepository::singleton().mphf_abundance_bits()
+#define STR_MPHF_ABUNDANCE_LOG  gatb::core::tools::misc::StringRepository::singleton().mphf_abundance_log()
 #define STR_URI_SOLID_KMERS     gatb::core::tools::misc::StringRepository::singleton().uri_solid_kmers()
 #define STR_BANK_CONVERT_TYPE   gatb::core::tools::misc::StringRepository::singleton().bank_convert_type()
 #define STR_SOLIDITY_KIND       gatb::core::tools::misc::StringRepository::singleton().solidity_kind()
@@ -171,6 +182,7 @@ public:
 #define STR_REPARTITION_TYPE    gatb::core::tools::misc::StringRepository::singleton().repartition_type()
 #define STR_COMPRESS_LEVEL      gatb::core::tools::misc::StringRepository::singleton().compress_level()
 #define STR_CONFIG_ONLY         gatb::core::tools::misc::StringRepository::singleton().config_only()
+#define STR_DISTINCT_ESTIMATE   gatb::core::tools::misc::StringRepository::singleton().distinct_estimate()
 
 /********************************************************************************/
 
@@ -187,6 +199,12 @@ public:
 #define STR_BANK_bad_file_path      gatb::core::tools::misc::MessageRepository::singleton().BANK_bad_file_path ()
 #define STR_BANK_unable_open_file   gatb::core::tools::misc::MessageRepository::singleton().BANK_unable_open_file ()
 #define STR_BANK_unable_write_file  gatb::core::tools::misc::MessageRepository::singleton().BANK_unable_write_file ()
+#define STR_BANK_bad_bgzf_block     gatb::core::tools::misc::MessageRepository::singleton().BANK_bad_bgzf_block ()
+#define STR_BANK_bad_gzip_file      gatb::core::tools::misc::MessageRepository::singleton().BANK_bad_gzip_file ()
+#define STR_BANK_unable_index_file  gatb::core::tools::misc::MessageRepository::singleton().BANK_unable_index_file ()
+#define STR_BANK_unknown_sequence   gatb::core::tools::misc::MessageRepository::singleton().BANK_unknown_sequence ()
+#define STR_BANK_bad_sequence_id    gatb::core::tools::misc::MessageRepository::singleton().BANK_bad_sequence_id ()
+#define STR_BANK_being_written      gatb::core::tools::misc::MessageRepository::singleton().BANK_being_written ()
 
 /********************************************************************************/
 } } } } /* end of namespaces. */
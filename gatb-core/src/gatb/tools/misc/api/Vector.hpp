@@ -30,6 +30,7 @@
 
 #include <gatb/system/api/ISmartPointer.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb      {
@@ -131,7 +132,16 @@ public:
         _isAllocated = true;
         memcpy (_buffer, buffer, _size*sizeof(char));
     }
-    
+
+    /** Exchange the content of two vectors, without copying the data.
+     * \param[in] vect : vector to be exchanged with the current instance */
+    void swap (Vector& vect)
+    {
+        std::swap (_buffer,      vect._buffer);
+        std::swap (_size,        vect._size);
+        std::swap (_isAllocated, vect._isAllocated);
+        std::swap (_ref,         vect._ref);
+    }
 
 private:
 
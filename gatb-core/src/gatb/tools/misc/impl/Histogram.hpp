@@ -34,6 +34,7 @@
 #include <gatb/tools/collections/api/Bag.hpp>
 #include <gatb/tools/misc/api/IHistogram.hpp>
 #include <string>
+#include <vector>
 #include <iostream>
 
 /********************************************************************************/
@@ -154,8 +155,9 @@ public:
 /** \brief Cached implementation of the IHistogram interface.
  *
  * This implementation is a Proxy design pattern. It allows to modify a IHistogram instance
- * by several threads at the same time. Actually, each thread has a local copy and at
- * the end, all the local copies are merged into the referred instance.
+ * by several threads at the same time. Actually, each thread has a local copy (a plain array
+ * of counters, no lock is taken by 'inc') and the local copies are merged into the referred
+ * instance by 'flush', or at the latest when they are destroyed.
  * */
 class HistogramCache : public IHistogram, public system::SmartPointer
 {
@@ -165,18 +167,25 @@ public:
      * \param[in] ref : the referred instance.
      * \param[in] synchro : used for synchronization */
     HistogramCache (IHistogram* ref, system::ISynchronizer* synchro=0)
-        : _ref(0), _synchro(synchro), _localHisto(ref ? ref->getLength() : 0) {  setRef(ref); }
+        : _ref(0), _synchro(synchro), _length(ref ? ref->getLength() : 0), _localHisto(_length+1, 0) {  setRef(ref); }
 
     /** Destructor. */
     ~HistogramCache()
     {
-        system::LocalSynchronizer ls (_synchro);
-        for (size_t cc=1; cc<_localHisto.getLength(); cc++)  {  _ref->get(cc) += _localHisto.get(cc);  }
+        flush ();
         setRef (0);
     }
 
+    /** Merges the local copy into the referred instance and resets the local copy, so
+     * the counts are merged only once whatever the number of calls. */
+    void flush ()
+    {
+        system::LocalSynchronizer ls (_synchro);
+        for (size_t cc=1; cc<_localHisto.size(); cc++)  {  _ref->get(cc) += _localHisto[cc];  _localHisto[cc] = 0;  }
+    }
+
     /** \copydoc IHistogram::inc */
-    void inc (u_int16_t index)  { _localHisto.inc (index); }
+    void inc (u_int16_t index)  { _localHisto [(index >= _length) ? _length : index] ++; }
 
     /** \copydoc IHistogram::save */
     void save (tools::storage::impl::Group& group)  { return _ref->save(group); }
@@ -194,10 +203,10 @@ public:
     u_int16_t get_first_peak () { return _ref->get_first_peak(); }
 
     /** \copydoc IHistogram::getLength */
-    size_t getLength() { return _localHisto.getLength(); }
+    size_t getLength() { return _length; }
 
     /** \copydoc IHistogram::get */
-    u_int64_t& get (u_int16_t idx)  { return _localHisto.get(idx); }
+    u_int64_t& get (u_int16_t idx)  { return _localHisto[idx]; }
 
 private:
 
@@ -205,7 +214,8 @@ private:
     void setRef (IHistogram* ref)  { SP_SETATTR(ref); }
 
     system::ISynchronizer* _synchro;
-    Histogram              _localHisto;
+    size_t                 _length;
+    std::vector<u_int64_t> _localHisto;
 };
 
 /********************************************************************************/
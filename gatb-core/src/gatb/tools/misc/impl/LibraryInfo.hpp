@@ -66,6 +66,7 @@ public:
             props->add (1, "build_compiler", "%s", system::impl::System::info().getBuildCompiler().c_str());
             //props->add (1, "build_options",  "%s", system::impl::System::info().getBuildOptions().c_str());
             props->add (1, "build_kmer_size", "%s", KSIZE_STRING);
+            props->add (1, "build_kmer_size_fixed", "%s", KSIZE_FIXED_STRING);
             //props->add (1, "custom_memalloc", "%d", CUSTOM_MEM_ALLOC);
 
             singleton.setRef (props);
@@ -438,6 +438,9 @@ public:
         std::string result;
         herr_t status;
 
+        /** The property may not exist (for instance in a file written by a former version). */
+        if (H5Aexists (_datasetId, key.c_str()) <= 0)  { return result; }
+
         hid_t datatype = H5Tcopy (H5T_C_S1);  H5Tset_size (datatype, H5T_VARIABLE);
 
         hid_t attrId = H5Aopen (_datasetId, key.c_str(), H5P_DEFAULT);
@@ -113,11 +113,13 @@ public:
         std::stringstream ss1;  ss1 <<  bloom->getBitSize();
         std::stringstream ss2;  ss2 <<  bloom->getNbHash();
         std::stringstream ss3;  ss3 <<  kmerSize;
+        std::stringstream ss4;  ss4 <<  bloom->getHashVersion();
 
         bloomCollection->addProperty ("size",      ss1.str());
         bloomCollection->addProperty ("nb_hash",   ss2.str());
         bloomCollection->addProperty ("type",      bloom->getName());
         bloomCollection->addProperty ("kmer_size", ss3.str());
+        bloomCollection->addProperty ("hash_version", ss4.str());
     }
 
     /** Load a Bloom filter from a group
@@ -130,12 +132,14 @@ public:
         /** We retrieve the raw data buffer for the Bloom filter. */
         tools::collections::Collection<tools::math::NativeInt8>* bloomArray = & group.getCollection<tools::math::NativeInt8> (name);
 
-        /** We create the Bloom fiter. */
+        /** We create the Bloom fiter. Note that the filters saved before the versioning of the hash
+         * functions have no 'hash_version' property, so they keep their hash functions (version 0). */
         tools::collections::impl::IBloom<T>* bloom = tools::collections::impl::BloomFactory::singleton().createBloom<T> (
             bloomArray->getProperty("type"),
             bloomArray->getProperty("size"),
             bloomArray->getProperty("nb_hash"),
-            bloomArray->getProperty("kmer_size")
+            bloomArray->getProperty("kmer_size"),
+            bloomArray->getProperty("hash_version")
         );
 
         if (bloomMode == 0)
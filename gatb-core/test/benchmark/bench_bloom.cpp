@@ -76,6 +76,8 @@ using namespace gatb::core::tools::collections::impl;
 
 using namespace gatb::core::tools::math;
 
+typedef LargeInt<1> kmer_type;
+
 #define MAX_RANDOM 2147483648
 #define srandomdev() srand((unsigned) time(NULL))
 
@@ -97,6 +99,7 @@ int main (int argc, char* argv[])
         cerr << "   1) bloom size"  << endl;
         cerr << "   2) nb elems inserted"  << endl;
         cerr << "   3) nb hash funcs"  << endl;
+        cerr << "   4) hash functions version (optional)"  << endl;
 
         return EXIT_FAILURE;
     }
@@ -112,6 +115,7 @@ int main (int argc, char* argv[])
     uint64_t bloomsize = atoll(argv[1]);
     uint64_t nelems = atoll(argv[2]);
     uint64_t nhash = atoll(argv[3]);
+    int      hashVersion = argc > 4 ? atoi(argv[4]) : HashFunctors<kmer_type>::LAST_VERSION;
     uint64_t resu =0;
     double  ratio  = bloomsize / (double) nelems ;
     double  expected_FP  = pow(0.6185,ratio);
@@ -137,9 +141,9 @@ int main (int argc, char* argv[])
         //    8589934592   bits for 1GB   //1 = 780903144
         /** We create a bloom with inserted solid kmers. */
         kmer_type kmertemp;
-      //  Bloom<kmer_type>* bloom =  new Bloom<kmer_type> (bloomsize,nhash);
-        BloomCacheCoherent<kmer_type>* bloomcc =  new BloomCacheCoherent<kmer_type> (bloomsize,nhash,12);
-        Bloom<kmer_type>*    bloom_std =  new Bloom<kmer_type> (bloomsize,nhash);
+      //  Bloom<kmer_type>* bloom =  new Bloom<kmer_type> (bloomsize,nhash,hashVersion);
+        BloomCacheCoherent<kmer_type>* bloomcc =  new BloomCacheCoherent<kmer_type> (bloomsize,nhash,12,hashVersion);
+        Bloom<kmer_type>*    bloom_std =  new Bloom<kmer_type> (bloomsize,nhash,hashVersion);
 
         //testing bloom cache coherent
         _timeInfo.start ("Inserting N elements cache_coherent");
@@ -202,10 +206,10 @@ int main (int argc, char* argv[])
         //////////////////////// testing fp rate with random elements
       
         delete bloom_std;
-       bloom_std =  new Bloom<kmer_type> (bloomsize,nhash);
+       bloom_std =  new Bloom<kmer_type> (bloomsize,nhash,hashVersion);
 
         delete bloomcc;
-        bloomcc =  new BloomCacheCoherent<kmer_type> (bloomsize,nhash,12);
+        bloomcc =  new BloomCacheCoherent<kmer_type> (bloomsize,nhash,12,hashVersion);
 
         //insert n randoms
         for(int ii = 0; ii<nelems; ii++)
@@ -246,6 +250,7 @@ int main (int argc, char* argv[])
 
         res.add (1, "N elems inserted  ", "%lli",nelems);
         res.add (1, "nb  hash funcs", "%i",nhash);
+        res.add (1, "hash funcs version", "%i",hashVersion);
         res.add (1, "ratio bits/elem", "%g",bloomsize/(double) nelems);
 
         
@@ -0,0 +1,106 @@
+/* benchmark of the FASTA/FASTQ parsing of BankFasta
+ *
+ * usage: bench_fasta <file> [size_in_MB]
+ *
+ * if the file doesn't exist, a random FASTQ file of the given size (default 2048 MB) is created first.
+ */
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <gatb/system/impl/System.hpp>
+
+#include <gatb/bank/impl/BankFasta.hpp>
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace std;
+
+using namespace gatb::core::bank;
+using namespace gatb::core::bank::impl;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+/********************************************************************************/
+
+static void generate (const string& filename, u_int64_t size)
+{
+    FILE* file = fopen (filename.c_str(), "w");
+    if (file == 0)  { cerr << "unable to create " << filename << endl;  exit(1); }
+
+    const char* nt = "ACGT";
+    char seq[256], qual[256];
+    const size_t readLength = 150;
+
+    srand (17);
+
+    u_int64_t written = 0;
+    for (u_int64_t i=0; written < size; i++)
+    {
+        for (size_t j=0; j<readLength; j++)  {  seq[j] = nt[rand()&3];  qual[j] = 33 + rand()%41;  }
+        seq[readLength] = qual[readLength] = 0;
+
+        written += fprintf (file, "@read_%lld length=%d\n%s\n+\n%s\n", (long long)i, (int)readLength, seq, qual);
+    }
+
+    fclose (file);
+}
+
+/********************************************************************************/
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2)  { cerr << "usage: " << argv[0] << " <file> [size_in_MB]" << endl;  return 1; }
+
+    string filename = argv[1];
+
+    if (System::file().doesExist (filename) == false)
+    {
+        u_int64_t size = (argc > 2 ? atoll (argv[2]) : 2048) * 1024 * 1024;
+
+        cout << "generating " << filename << " (" << size/(1024*1024) << " MB)..." << endl;
+        generate (filename, size);
+    }
+
+    double unit = 1000000000;
+    cout.setf(ios_base::fixed);
+    cout.precision(3);
+
+    u_int64_t fileSize = System::file().getSize (filename);
+
+    BankFasta::Iterator::CommentMode_e modes[] = { BankFasta::Iterator::NONE, BankFasta::Iterator::IDONLY, BankFasta::Iterator::FULL };
+    const char* names[] = { "NONE", "IDONLY", "FULL" };
+
+    BankFasta::Iterator::DataMode_e dataModes[] = { BankFasta::Iterator::COPY, BankFasta::Iterator::REFERENCE };
+    const char* dataNames[] = { "COPY", "REFERENCE" };
+
+    for (size_t d=0; d<sizeof(dataModes)/sizeof(dataModes[0]); d++)
+    {
+        for (size_t m=0; m<sizeof(modes)/sizeof(modes[0]); m++)
+        {
+            BankFasta bank (filename);
+            BankFasta::Iterator it (bank, modes[m], dataModes[d]);
+
+            u_int64_t nbSequences = 0, nbNucleotides = 0;
+
+            auto start_t = get_wtime();
+            for (it.first(); !it.isDone(); it.next())
+            {
+                nbSequences   ++;
+                nbNucleotides += it.item().getDataSize();
+            }
+            auto end_t = get_wtime();
+
+            double time = diff_wtime(start_t, end_t) / unit;
+
+            cout << "data " << dataNames[d] << ", comments " << names[m] << " : " << nbSequences << " sequences, " << nbNucleotides << " nucleotides in "
+                 << time << " seconds => " << (fileSize / (1024.0*1024.0)) / time << " MB/s" << endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/* compares the kmer kernels of a model (runtime kmer size) with the ones of Kmer<span>::FixedSize (kmer size known at compile time) */
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <gatb/kmer/impl/Model.hpp>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+
+using namespace gatb::core::kmer::impl;
+
+/* what the graph does for getting the neighbors of a node: a reverse complement and 8 rolls;
+ * the rolled nucleotides depend on the round, so the compiler can't compute the rounds only once */
+template<typename Type, typename Model> u_int64_t neighbors (const Model& model, const vector<Type>& kmers, size_t round)
+{
+    u_int64_t checksum = 0;
+
+    for (size_t n=0; n<kmers.size(); n++)
+    {
+        Type reverse = model.reverse (kmers[n]);
+
+        for (size_t nt=0; nt<4; nt++)
+        {
+            Type f = kmers[n], r = reverse;
+            model.rollRight (f, r, (nt+round) & 3);
+            checksum += (f < r ? f : r).getVal();
+
+            f = kmers[n];  r = reverse;
+            model.rollLeft (f, r, (nt+round) & 3);
+            checksum += (f < r ? f : r).getVal();
+        }
+    }
+
+    return checksum;
+}
+
+/* what the counting does for reading a superkmer: a reverse complement and one roll per nucleotide */
+template<typename Type, typename Model> u_int64_t superkmers (const Model& model, const vector<Type>& kmers, size_t round)
+{
+    u_int64_t checksum = 0;
+
+    for (size_t n=0; n+32<kmers.size(); n+=32)
+    {
+        Type forward = kmers[n], reverse = model.reverse (kmers[n]);
+
+        for (size_t i=1; i<32; i++)
+        {
+            model.rollRight (forward, reverse, (kmers[n+i].getVal() + round) & 3);
+            checksum += (forward < reverse ? forward : reverse).getVal();
+        }
+    }
+
+    return checksum;
+}
+
+template<size_t span, size_t K> void bench ()
+{
+    typedef typename Kmer<span>::Type Type;
+
+    typename Kmer<span>::ModelCanonical   model (K);
+    typename Kmer<span>::template FixedSize<K> fixed;
+
+    size_t NB_KMERS = 1<<16;
+    size_t NB_REPETITIONS = 100;
+
+    /* random kmers */
+    vector<Type> kmers (NB_KMERS);
+    for (size_t n=0; n<NB_KMERS; n++)
+    {
+        Type kmer (0);
+        for (size_t i=0; i<K; i++)  {  kmer = (kmer << 2) + Type(rand() & 3);  }
+        kmers[n] = kmer;
+    }
+
+    /* a checksum prevents the compiler from removing the loops, and checks both versions agree */
+    u_int64_t checksum_model = 0, checksum_fixed = 0;
+
+    auto start_t=get_wtime();
+    for (size_t r=0; r<NB_REPETITIONS; r++)  {  checksum_model += neighbors (model, kmers, r);  }
+    auto end_t=get_wtime();
+    double neighbors_model = diff_wtime(start_t, end_t) / (double)(NB_REPETITIONS*NB_KMERS);
+
+    start_t=get_wtime();
+    for (size_t r=0; r<NB_REPETITIONS; r++)  {  checksum_fixed += neighbors (fixed, kmers, r);  }
+    end_t=get_wtime();
+    double neighbors_fixed = diff_wtime(start_t, end_t) / (double)(NB_REPETITIONS*NB_KMERS);
+
+    start_t=get_wtime();
+    for (size_t r=0; r<NB_REPETITIONS; r++)  {  checksum_model += superkmers (model, kmers, r);  }
+    end_t=get_wtime();
+    double superkmers_model = diff_wtime(start_t, end_t) / (double)(NB_REPETITIONS*NB_KMERS);
+
+    start_t=get_wtime();
+    for (size_t r=0; r<NB_REPETITIONS; r++)  {  checksum_fixed += superkmers (fixed, kmers, r);  }
+    end_t=get_wtime();
+    double superkmers_fixed = diff_wtime(start_t, end_t) / (double)(NB_REPETITIONS*NB_KMERS);
+
+    cout << Type::getName() << " k=" << K
+         << "  neighbors: " << neighbors_model << " -> " << neighbors_fixed << " ns/kmer"
+         << "  superkmers: " << superkmers_model << " -> " << superkmers_fixed << " ns/kmer"
+         << (checksum_model == checksum_fixed ? "" : "  MISMATCH") << endl;
+}
+
+int main (int argc, char* argv[])
+{
+    cout.setf(ios_base::fixed);
+    cout.precision(2);
+
+    cout << "times with the model -> with FixedSize" << endl;
+
+    bench<KMER_SPAN(0),21>  ();
+    bench<KMER_SPAN(0),31>  ();
+    bench<KMER_SPAN(1),51>  ();
+    bench<KMER_SPAN(1),63>  ();
+    bench<KMER_SPAN(2),95>  ();
+    bench<KMER_SPAN(3),127> ();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/* compares the hot kmer operations of LargeInt<2> with the ones of NativeInt128 (both built on __uint128_t)
+ * and of the generic LargeInt code (LargeInt<3>), for k=51..63 */
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <gatb/tools/math/LargeInt.hpp>
+#include <gatb/tools/math/NativeInt128.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+using namespace gatb::core::tools::math;
+
+#define NB_KMERS        (1<<16)
+#define NB_REPETITIONS  50
+
+/* each kernel returns a checksum, which prevents the compiler from removing the loops and checks that LargeInt<2>
+ * and NativeInt128 agree (the generic hash functions also hash the third, empty, word of LargeInt<3>) */
+
+template<typename Type> u_int64_t kernel_revcomp (vector<Type>& kmers, size_t kmerSize)
+{
+    u_int64_t checksum = 0;
+    for (size_t n=0; n<kmers.size(); n++)  {  checksum += revcomp (kmers[n], kmerSize).getVal();  }
+    return checksum;
+}
+
+template<typename Type> u_int64_t kernel_hash (vector<Type>& kmers, size_t kmerSize)
+{
+    u_int64_t checksum = 0;
+    for (size_t n=0; n<kmers.size(); n++)  {  checksum += hash1 (kmers[n], n) ^ oahash (kmers[n]);  }
+    return checksum;
+}
+
+/* what the minimizer window does: one mmer (here m=10) extracted per kmer position */
+template<typename Type> u_int64_t kernel_minimizer (vector<Type>& kmers, size_t kmerSize)
+{
+    Type mask ((1<<20) - 1);
+    u_int64_t checksum = 0;
+    for (size_t n=0; n<kmers.size(); n++)
+    {
+        u_int64_t minimizer = ~0;
+        for (size_t i=0; i+10<=kmerSize; i++)  {  minimizer = min (minimizer, (kmers[n] >> (2*i)).getVal() & mask.getVal());  }
+        checksum += minimizer;
+    }
+    return checksum;
+}
+
+/* what SuperKmer::save and the superkmer readers do: pack the last nucleotide of successive kmers, then read them back */
+template<typename Type> u_int64_t kernel_superkmer (vector<Type>& kmers, size_t kmerSize)
+{
+    u_int64_t checksum = 0;
+    for (size_t n=0; n+32<kmers.size(); n+=32)
+    {
+        Type compactedK (0);
+        for (size_t i=1; i<32; i++)  {  compactedK = (compactedK << 2) | Type (kmers[n+i][0]);  }
+
+        Type temp = kmers[n];
+        for (size_t rem=32; rem>=2; rem--)  {  temp = (temp << 2) | Type (compactedK[rem-2]);  checksum += temp.getVal();  }
+    }
+    return checksum;
+}
+
+/* what the partitions sorting does */
+template<typename Type> u_int64_t kernel_sort (vector<Type>& kmers, size_t kmerSize)
+{
+    vector<Type> sorted (kmers);
+    sort (sorted.begin(), sorted.end());
+    return sorted[sorted.size()/2].getVal();
+}
+
+template<typename Type> double run (u_int64_t (*kernel) (vector<Type>&, size_t), vector<Type>& kmers, size_t kmerSize, u_int64_t& checksum)
+{
+    checksum = 0;
+    auto start_t=get_wtime();
+    for (size_t r=0; r<NB_REPETITIONS; r++)  {  checksum += kernel (kmers, kmerSize);  }
+    auto end_t=get_wtime();
+    return diff_wtime(start_t, end_t) / (double)(NB_REPETITIONS*kmers.size());
+}
+
+/* the same random kmers, nucleotide by nucleotide, for each type */
+template<typename Type> vector<Type> build (size_t kmerSize)
+{
+    srand (0);
+    vector<Type> kmers (NB_KMERS);
+    for (size_t n=0; n<NB_KMERS; n++)
+    {
+        Type kmer (0);
+        for (size_t i=0; i<kmerSize; i++)  {  kmer = (kmer << 2) + Type(rand() & 3);  }
+        kmers[n] = kmer;
+    }
+    return kmers;
+}
+
+void bench (const char* name, u_int64_t (*k1) (vector<LargeInt<2> >&, size_t), u_int64_t (*k2) (vector<NativeInt128>&, size_t),
+    u_int64_t (*k3) (vector<LargeInt<3> >&, size_t), size_t kmerSize)
+{
+    vector<LargeInt<2> > kmers1 = build<LargeInt<2> > (kmerSize);
+    vector<NativeInt128> kmers2 = build<NativeInt128> (kmerSize);
+    vector<LargeInt<3> > kmers3 = build<LargeInt<3> > (kmerSize);
+
+    u_int64_t c1, c2, c3;
+    double t1 = run (k1, kmers1, kmerSize, c1);
+    double t2 = run (k2, kmers2, kmerSize, c2);
+    double t3 = run (k3, kmers3, kmerSize, c3);
+
+    cout << "k=" << kmerSize << "  " << name << "\t" << t1 << "\t" << t2 << "\t" << t3 << " ns/kmer"
+         << (c1==c2 ? "" : "  MISMATCH") << endl;
+}
+
+#define BENCH(kernel,k)  bench (#kernel, kernel<LargeInt<2> >, kernel<NativeInt128>, kernel<LargeInt<3> >, k)
+
+int main (int argc, char* argv[])
+{
+    cout.setf(ios_base::fixed);
+    cout.precision(2);
+
+    cout << "times for LargeInt<2>, NativeInt128 and LargeInt<3> (generic)" << endl;
+
+    size_t sizes[] = { 51, 63 };
+
+    for (size_t i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++)
+    {
+        BENCH (kernel_revcomp,   sizes[i]);
+        BENCH (kernel_hash,      sizes[i]);
+        BENCH (kernel_minimizer, sizes[i]);
+        BENCH (kernel_superkmer, sizes[i]);
+        BENCH (kernel_sort,      sizes[i]);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/* compares the reverse complement of kmers with the former lookup table version */
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <gatb/tools/math/LargeInt.hpp>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+
+using namespace gatb::core::tools::math;
+
+/* former implementation: one lookup in a 256 entries table per byte */
+template<int precision> LargeInt<precision> revcomp_lut (const LargeInt<precision>& x, size_t sizeKmer)
+{
+    LargeInt<precision> res = x;
+
+    unsigned char* kmerrev  = (unsigned char *) (&res);
+    unsigned char* kmer     = (unsigned char *) (&x);
+
+    for (size_t i=0; i<8*precision; ++i)  {  kmerrev[8*precision-1-i] = revcomp_4NT [kmer[i]];  }
+
+    return res >> (2*(32*precision - sizeKmer));
+}
+
+template<int precision> void bench (size_t kmerSize)
+{
+    typedef LargeInt<precision> Type;
+
+    size_t NB_KMERS = 1<<16;
+    size_t NB_REPETITIONS = 200;
+
+    /* random kmers */
+    vector<Type> kmers (NB_KMERS);
+    for (size_t n=0; n<NB_KMERS; n++)
+    {
+        Type kmer (0);
+        for (size_t i=0; i<kmerSize; i++)  {  kmer = (kmer << 2) + Type(rand() & 3);  }
+        kmers[n] = kmer;
+    }
+
+    /* a checksum prevents the compiler from removing the loops, and checks both versions agree */
+    u_int64_t checksum_lut = 0, checksum = 0;
+
+    auto start_t=get_wtime();
+    for (size_t r=0; r<NB_REPETITIONS; r++)
+        for (size_t n=0; n<NB_KMERS; n++)  {  checksum_lut += hash1 (revcomp_lut (kmers[n], kmerSize), r);  }
+    auto end_t=get_wtime();
+    double time_lut = diff_wtime(start_t, end_t) / (double)(NB_REPETITIONS*NB_KMERS);
+
+    start_t=get_wtime();
+    for (size_t r=0; r<NB_REPETITIONS; r++)
+        for (size_t n=0; n<NB_KMERS; n++)  {  checksum += hash1 (revcomp (kmers[n], kmerSize), r);  }
+    end_t=get_wtime();
+    double time = diff_wtime(start_t, end_t) / (double)(NB_REPETITIONS*NB_KMERS);
+
+    cout << Type::getName() << " k=" << kmerSize
+         << "  lookup table: " << time_lut << " ns/kmer"
+         << "  current: " << time << " ns/kmer"
+         << (checksum == checksum_lut ? "" : "  MISMATCH") << endl;
+}
+
+int main (int argc, char* argv[])
+{
+    cout.setf(ios_base::fixed);
+    cout.precision(2);
+
+#ifdef __SSSE3__
+    cout << "(SSSE3 enabled)" << endl;
+#endif
+
+    /* note: the time of hash1 (used for the checksums) is included in both timings */
+    bench<1> (21);
+    bench<1> (31);
+    bench<2> (51);
+    bench<2> (63);
+    bench<3> (95);
+    bench<4> (127);
+
+    return EXIT_SUCCESS;
+}
@@ -32,6 +32,8 @@
 #include <list>
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
+#include <string.h>
+#include <zlib.h>
 
 using namespace std;
 
@@ -62,6 +64,10 @@ class TestBank : public Test
     CPPUNIT_TEST_SUITE_GATB (TestBank);
 
         CPPUNIT_TEST_GATB (bank_checkSample1);
+        CPPUNIT_TEST_GATB (bank_checkReference);
+        CPPUNIT_TEST_GATB (bank_checkDecompress);
+        CPPUNIT_TEST_GATB (bank_checkSplit);
+        CPPUNIT_TEST_GATB (bank_checkIndexed);
         CPPUNIT_TEST_GATB (bank_checkSample2);
         CPPUNIT_TEST_GATB (bank_checkSample3);
         CPPUNIT_TEST_GATB (bank_checkComments);
@@ -71,6 +77,7 @@ class TestBank : public Test
         CPPUNIT_TEST_GATB (bank_checkEstimateNbSequences);
         CPPUNIT_TEST_GATB (bank_checkProgress);
         CPPUNIT_TEST_GATB (bank_checkConvertBinary);
+        CPPUNIT_TEST_GATB (bank_checkBinaryBlocks);
         CPPUNIT_TEST_GATB (bank_checkRegistery1);
         CPPUNIT_TEST_GATB (bank_checkRegistery2);
         CPPUNIT_TEST_GATB (bank_strings1);
@@ -78,6 +85,7 @@ class TestBank : public Test
         CPPUNIT_TEST_GATB (bank_splitter_1);
         CPPUNIT_TEST_GATB (bank_random_1);
         CPPUNIT_TEST_GATB (bank_composite);
+        CPPUNIT_TEST_GATB (bank_composite_parallel);
         CPPUNIT_TEST_GATB (bank_album1);
         CPPUNIT_TEST_GATB (bank_album2);
         CPPUNIT_TEST_GATB (bank_album3);
@@ -166,6 +174,423 @@ public:
         bank_checkSample1_aux (DBPATH("sample1.fa.gz"), BankFasta::Iterator::FULL);
     }
 
+    /********************************************************************************/
+    void bank_checkReference_aux (const string& filename, BankFasta::Iterator::CommentMode_e mode)
+    {
+        BankFasta b (filename);
+
+        /** We iterate the bank both in COPY and REFERENCE modes. */
+        BankFasta::Iterator itCopy (b, mode, BankFasta::Iterator::COPY);
+        BankFasta::Iterator itRef  (b, mode, BankFasta::Iterator::REFERENCE);
+
+        Sequence previous;
+        size_t   nbSeq = 0;
+
+        for (itCopy.first(), itRef.first(); !itCopy.isDone(); itCopy.next(), itRef.next(), nbSeq++)
+        {
+            CPPUNIT_ASSERT (itRef.isDone() == false);
+
+            CPPUNIT_ASSERT (itRef->getDataSize() == itCopy->getDataSize());
+            CPPUNIT_ASSERT (itRef->toString()    == itCopy->toString());
+            CPPUNIT_ASSERT (itRef->getComment()  == itCopy->getComment());
+            CPPUNIT_ASSERT (itRef->getQuality()  == itCopy->getQuality());
+            CPPUNIT_ASSERT (itRef->getIndex()    == itCopy->getIndex());
+
+            /** A copy of the previous item must not be modified by the iteration. */
+            if (nbSeq > 0)  {  CPPUNIT_ASSERT (previous.getIndex() == nbSeq-1);  }
+
+            previous = itRef.item();
+        }
+
+        CPPUNIT_ASSERT (itRef.isDone() == true);
+        CPPUNIT_ASSERT (nbSeq > 0);
+    }
+
+    /** Check that the REFERENCE data mode of BankFasta::Iterator provides the same sequences
+     * as the COPY data mode. */
+    void bank_checkReference ()
+    {
+        const char* files[] = { "sample1.fa", "sample1.fa.gz", "sample.fastq", "sample.fastq.gz", "reads1.fa" };
+
+        BankFasta::Iterator::CommentMode_e modes[] = { BankFasta::Iterator::NONE, BankFasta::Iterator::IDONLY, BankFasta::Iterator::FULL };
+
+        for (size_t i=0; i<ARRAY_SIZE(files); i++)
+        {
+            for (size_t j=0; j<ARRAY_SIZE(modes); j++)  {  bank_checkReference_aux (DBPATH(files[i]), modes[j]);  }
+        }
+
+        /** A copy of an item holds its own data and comment. */
+        BankFasta b (DBPATH("sample1.fa"));
+        BankFasta::Iterator it (b, BankFasta::Iterator::FULL, BankFasta::Iterator::REFERENCE);
+
+        it.first();
+        Sequence first = it.item();
+        it.next();
+
+        CPPUNIT_ASSERT (first.getComment() == "seq1 generic");
+        CPPUNIT_ASSERT (first.toString()   == "ARNDCQEGHILKMFPSTWYV");
+        CPPUNIT_ASSERT (it->getComment()   == "seq2 generic");
+    }
+
+    /********************************************************************************/
+    /** Write a file in the BGZF format (series of gzip members of at most 64 KB). */
+    void bank_writeBGZF (const string& input, const string& output, size_t memberSize)
+    {
+        FILE* in  = fopen (input.c_str(),  "rb");
+        FILE* out = fopen (output.c_str(), "wb");
+        CPPUNIT_ASSERT (in != 0 && out != 0);
+
+        vector<unsigned char> data (memberSize), cdata (2*memberSize + 1024);
+
+        for (size_t len = 1; len > 0; )
+        {
+            /** The last member is the empty end of file marker. */
+            len = fread (&data[0], 1, memberSize, in);
+
+            z_stream zs;  memset (&zs, 0, sizeof(zs));
+            CPPUNIT_ASSERT (deflateInit2 (&zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+            zs.next_in  = &data[0];   zs.avail_in  = len;
+            zs.next_out = &cdata[0];  zs.avail_out = cdata.size();
+            CPPUNIT_ASSERT (deflate (&zs, Z_FINISH) == Z_STREAM_END);
+            size_t clen = zs.total_out;
+            deflateEnd (&zs);
+
+            u_int32_t bsize = 12 + 6 + clen + 8 - 1;
+            u_int32_t crc   = crc32 (0, &data[0], len);
+
+            unsigned char header[18] = { 31, 139, 8, 4, 0,0,0,0, 0, 255, 6,0, 'B','C', 2,0, (unsigned char)(bsize & 0xFF), (unsigned char)(bsize >> 8) };
+            unsigned char trailer[8];
+            for (size_t i=0; i<4; i++)  {  trailer[i] = (crc >> (8*i)) & 0xFF;  trailer[4+i] = (len >> (8*i)) & 0xFF;  }
+
+            fwrite (header,    1, sizeof(header),  out);
+            fwrite (&cdata[0], 1, clen,            out);
+            fwrite (trailer,   1, sizeof(trailer), out);
+        }
+
+        fclose (in);
+        fclose (out);
+    }
+
+    /** Compute a checksum of the sequences of a bank. */
+    u_int64_t bank_checksum (const string& filename)
+    {
+        BankFasta b (filename);
+        BankFasta::Iterator it (b);
+
+        u_int64_t result = 0;
+        for (it.first(); !it.isDone(); it.next())
+        {
+            string s = it->toString() + it->getComment() + it->getQuality();
+            for (size_t i=0; i<s.size(); i++)  {  result = result*1000003 + s[i];  }
+        }
+        return result;
+    }
+
+    /** Check that the background decompression (gzip and BGZF files) provides the same sequences
+     * as the uncompressed files, whatever the number of decompression threads. */
+    void bank_checkDecompress ()
+    {
+        const char* files[] = { "sample1.fa", "sample.fastq", "reads1.fa" };
+
+        size_t nbThreads[] = { 0, 1, 2, 4 };
+
+        size_t nbThreadsInit = BankFasta::getNbDecompressThreads();
+
+        for (size_t i=0; i<ARRAY_SIZE(files); i++)
+        {
+            string filename = DBPATH(files[i]);
+            string bgzfname = filename + ".bgzf.gz";
+
+            /** We use small members in order to have several members per block of the ring. */
+            bank_writeBGZF (filename, bgzfname, 1000);
+
+            u_int64_t checksum = bank_checksum (filename);
+
+            for (size_t j=0; j<ARRAY_SIZE(nbThreads); j++)
+            {
+                BankFasta::setNbDecompressThreads (nbThreads[j]);
+
+                CPPUNIT_ASSERT (bank_checksum (filename + ".gz") == checksum);
+                CPPUNIT_ASSERT (bank_checksum (bgzfname)         == checksum);
+            }
+
+            CPPUNIT_ASSERT (System::file().remove (bgzfname) == 0);
+        }
+
+        /** A truncated gzip file must raise an exception, as a corrupted BGZF block does. */
+        string truncated = DBPATH("reads1.fa.gz");
+        string truncname = truncated + ".truncated.gz";
+        {
+            FILE* in  = fopen (truncated.c_str(), "rb");
+            FILE* out = fopen (truncname.c_str(), "wb");
+            CPPUNIT_ASSERT (in != 0 && out != 0);
+
+            vector<char> data (System::file().getSize (truncated) / 2);
+            CPPUNIT_ASSERT (fread  (&data[0], 1, data.size(), in)  == data.size());
+            CPPUNIT_ASSERT (fwrite (&data[0], 1, data.size(), out) == data.size());
+            fclose (in);
+            fclose (out);
+        }
+
+        for (size_t j=0; j<ARRAY_SIZE(nbThreads); j++)
+        {
+            BankFasta::setNbDecompressThreads (nbThreads[j]);
+
+            bool hasThrown = false;
+            try  {  bank_checksum (truncname);  }  catch (gatb::core::system::Exception& e)  {  hasThrown = true;  }
+            CPPUNIT_ASSERT (hasThrown);
+        }
+
+        CPPUNIT_ASSERT (System::file().remove (truncname) == 0);
+
+        BankFasta::setNbDecompressThreads (nbThreadsInit);
+    }
+
+    /********************************************************************************/
+    static u_int64_t bank_hash (Sequence& seq)
+    {
+        string s = seq.toString() + seq.getComment() + seq.getQuality();
+        u_int64_t result = 0;
+        for (size_t i=0; i<s.size(); i++)  {  result = result*1000003 + s[i];  }
+        return result;
+    }
+
+    struct SplitFunctor
+    {
+        SplitFunctor (u_int64_t& nb, u_int64_t& sum) : nb(nb), sum(sum) {}
+        void operator() (Sequence& seq)  {  __sync_fetch_and_add (&nb, 1);  __sync_fetch_and_add (&sum, bank_hash(seq));  }
+        u_int64_t& nb;
+        u_int64_t& sum;
+    };
+
+    void bank_checkSplit_aux (const string& filename, bool canSplit)
+    {
+        BankFasta b (filename);
+
+        /** We get the sequences through a usual iterator. */
+        vector<u_int64_t> check;
+        u_int64_t checkSum = 0;
+
+        BankFasta::Iterator it (b);
+        for (it.first(); !it.isDone(); it.next())  {  check.push_back (bank_hash (*it));  checkSum += check.back();  }
+
+        size_t nbParts[] = { 1, 2, 5, 1000 };
+
+        for (size_t i=0; i<ARRAY_SIZE(nbParts); i++)
+        {
+            Iterator<Sequence>* itSplit = b.splitIterator (nbParts[i]);
+            LOCAL (itSplit);
+
+            size_t nbActualParts = itSplit->getComposition().size();
+            CPPUNIT_ASSERT (nbActualParts <= nbParts[i]);
+            CPPUNIT_ASSERT (nbActualParts <= check.size());
+            CPPUNIT_ASSERT (canSplit == true || nbActualParts == 1);
+            CPPUNIT_ASSERT (canSplit == false || nbParts[i] == 1 || nbActualParts > 1);
+
+            /** The parts iterated one after the other give the sequences in the file order. */
+            size_t nb = 0;
+            for (itSplit->first(); !itSplit->isDone(); itSplit->next(), nb++)
+            {
+                CPPUNIT_ASSERT (nb < check.size());
+                CPPUNIT_ASSERT (bank_hash (itSplit->item()) == check[nb]);
+            }
+            CPPUNIT_ASSERT (nb == check.size());
+
+            /** The parts iterated concurrently give the same sequences. */
+            u_int64_t nbItems = 0, sum = 0;
+            Dispatcher(4).iterate (itSplit->getComposition(), SplitFunctor (nbItems, sum));
+            CPPUNIT_ASSERT (nbItems == check.size());
+            CPPUNIT_ASSERT (sum     == checkSum);
+        }
+    }
+
+    /** Check that the parts of a split file give the sequences of the file. */
+    void bank_checkSplit ()
+    {
+        bank_checkSplit_aux (DBPATH("reads1.fa"),     true);
+        bank_checkSplit_aux (DBPATH("sample1.fa"),    true);
+        bank_checkSplit_aux (DBPATH("sample.fastq"),  true);
+        bank_checkSplit_aux (DBPATH("query.fa"),      true);
+        bank_checkSplit_aux (DBPATH("sample1.fa.gz"), false);
+
+        /** We check a FASTQ file whose quality lines may start with '@' or '+'. */
+        string filename = System::file().getTemporaryDirectory() + "/test_split.fastq";
+        FILE* file = fopen (filename.c_str(), "w");
+        CPPUNIT_ASSERT (file != 0);
+
+        const char* quals = "@+!#@IJ+";
+        srand (7);
+        for (size_t i=0; i<2000; i++)
+        {
+            size_t len = rand() % 50;
+            string seq, qual;
+            for (size_t j=0; j<len; j++)  {  seq += "ACGT"[rand()%4];  qual += quals[rand()%8];  }
+            if (len > 0 && i%2==0)  { qual[0] = '@'; }
+            fprintf (file, "@read%ld\n%s\n+\n%s\n", i, seq.c_str(), qual.c_str());
+        }
+        fclose (file);
+
+        bank_checkSplit_aux (filename, true);
+
+        System::file().remove (filename);
+    }
+
+    /********************************************************************************/
+    void bank_checkIndexed_aux (const string& filename)
+    {
+        /** We read the whole bank sequentially. */
+        vector<string> names, datas;
+        BankFasta b (filename);
+        BankFasta::Iterator it (b, BankFasta::Iterator::IDONLY);
+        for (it.first(); !it.isDone(); it.next())
+        {
+            names.push_back (it->getComment());
+            datas.push_back (it->toString());
+        }
+
+        BankFastaIndexed bank (filename);
+
+        CPPUNIT_ASSERT (bank.getNbSequences() == names.size());
+        CPPUNIT_ASSERT (System::file().doesExist (BankFastaIndexed::getIndexUri (filename)) == true);
+
+        Sequence seq;
+        for (size_t i=0; i<names.size(); i++)
+        {
+            /** We check the whole sequence, by index and by name. */
+            bank.getSequence (i, seq);
+            CPPUNIT_ASSERT (seq.toString() == datas[i]);
+            CPPUNIT_ASSERT (seq.getComment() == names[i]);
+
+            bank.getSequence (names[i], seq);
+            CPPUNIT_ASSERT (seq.toString() == datas[i]);
+
+            /** We check some regions, including regions overlapping the end of the sequence. */
+            size_t len = datas[i].size();
+            for (size_t start=0; start<=len; start += 1 + len/17)
+            {
+                for (size_t length=0; length<=len+5; length += 1 + len/7)
+                {
+                    bank.getRegion (i, start, length, seq);
+                    CPPUNIT_ASSERT (seq.toString() == datas[i].substr (start, length));
+                }
+            }
+        }
+
+        /** The index is read from the .fai file and must give the same entries. */
+        BankFastaIndexed other (filename);
+        CPPUNIT_ASSERT (other.getNbSequences() == bank.getNbSequences());
+        for (size_t i=0; i<bank.getNbSequences(); i++)
+        {
+            CPPUNIT_ASSERT (other.getEntry(i).offset    == bank.getEntry(i).offset);
+            CPPUNIT_ASSERT (other.getEntry(i).length    == bank.getEntry(i).length);
+            CPPUNIT_ASSERT (other.getEntry(i).lineWidth == bank.getEntry(i).lineWidth);
+        }
+
+        System::file().remove (BankFastaIndexed::getIndexUri (filename));
+    }
+
+    /********************************************************************************/
+    void bank_checkIndexed ()
+    {
+        bank_checkIndexed_aux (DBPATH("reads1.fa"));
+
+        /** We check a file with different line lengths for the different sequences. */
+        string filename = System::file().getTemporaryDirectory() + "/test_indexed.fa";
+        FILE* file = fopen (filename.c_str(), "w");
+        CPPUNIT_ASSERT (file != 0);
+
+        srand (11);
+        for (size_t i=0; i<200; i++)
+        {
+            size_t len = rand() % 500;
+            size_t width = 1 + rand() % 80;
+            fprintf (file, ">seq%ld some comment\n", i);
+            for (size_t j=0; j<len; j++)  {  fputc ("ACGT"[rand()%4], file);  if ((j+1)%width==0 || j+1==len) { fputc ('\n', file); }  }
+        }
+        fclose (file);
+
+        bank_checkIndexed_aux (filename);
+
+        Sequence seq;
+        BankFastaIndexed bank (filename);
+        bank.getRegion ("seq3", 2, 10, seq);
+        CPPUNIT_ASSERT (seq.getComment() == "seq3:3-12");
+
+        /** We check that an unknown name is rejected. */
+        bool isCaught = false;
+        try  {  bank.getSequence ("unknown", seq);  }  catch (Exception& e)  { isCaught = true; }
+        CPPUNIT_ASSERT (isCaught == true);
+
+        /** We check that an index out of range is rejected. */
+        isCaught = false;
+        try  {  bank.getSequence (200, seq);  }  catch (Exception& e)  { isCaught = true; }
+        CPPUNIT_ASSERT (isCaught == true);
+
+        isCaught = false;
+        try  {  bank.getRegion (200, 0, 10, seq);  }  catch (Exception& e)  { isCaught = true; }
+        CPPUNIT_ASSERT (isCaught == true);
+
+        System::file().remove (BankFastaIndexed::getIndexUri (filename));
+
+        /** We check that a long name is correctly read back from the index file. */
+        string longName (10000, 'N');
+        file = fopen (filename.c_str(), "w");
+        fprintf (file, ">%s\nACGT\nAC\n>seq1\nACGTACGT\n", longName.c_str());
+        fclose (file);
+
+        bank_checkIndexed_aux (filename);
+
+        {
+            BankFastaIndexed first (filename), second (filename);
+            CPPUNIT_ASSERT (second.getNbSequences() == 2);
+            CPPUNIT_ASSERT (second.getId (longName) == 0);
+            CPPUNIT_ASSERT (second.getId ("seq1")   == 1);
+        }
+
+        System::file().remove (BankFastaIndexed::getIndexUri (filename));
+
+        /** We check that an index is not used once the FASTA file has been rewritten, even within the same second. */
+        file = fopen (filename.c_str(), "w");
+        fprintf (file, ">seq0\nACGTACGT\n");
+        fclose (file);
+        {
+            BankFastaIndexed first (filename);
+            CPPUNIT_ASSERT (first.getNbSequences() == 1);
+        }
+        file = fopen (filename.c_str(), "w");
+        fprintf (file, ">seq0\nAC\n>seq1\nGG\n");
+        fclose (file);
+        {
+            BankFastaIndexed second (filename);
+            CPPUNIT_ASSERT (second.getNbSequences() == 2);
+            second.getSequence ("seq1", seq);
+            CPPUNIT_ASSERT (seq.toString() == "GG");
+        }
+
+        System::file().remove (BankFastaIndexed::getIndexUri (filename));
+
+        /** We check that duplicate sequence names are rejected, and that no index is saved. */
+        file = fopen (filename.c_str(), "w");
+        fprintf (file, ">seq0\nACGT\n>seq1\nAC\n>seq0 other\nGG\n");
+        fclose (file);
+
+        isCaught = false;
+        try  {  BankFastaIndexed bad (filename);  }  catch (Exception& e)  { isCaught = true; }
+        CPPUNIT_ASSERT (isCaught == true);
+        CPPUNIT_ASSERT (System::file().doesExist (BankFastaIndexed::getIndexUri (filename)) == false);
+
+        /** We check that a sequence with irregular lines is rejected. */
+        file = fopen (filename.c_str(), "w");
+        fprintf (file, ">seq0\nACGT\nAC\nACGT\n");
+        fclose (file);
+
+        isCaught = false;
+        try  {  BankFastaIndexed bad (filename);  }  catch (Exception& e)  { isCaught = true; }
+        CPPUNIT_ASSERT (isCaught == true);
+
+        System::file().remove (filename);
+    }
+
     /********************************************************************************/
     void bank_checkSample2_aux (const string& filename)
     {
@@ -358,6 +783,27 @@ public:
 
         /** We check the size of the bank. */
         CPPUNIT_ASSERT (b1.getSize() == 710);
+
+        /** The size of a compressed bank is the size of its decompressed data, whatever the gzip flavor. */
+        const char* files[] = { "sample1.fa", "sample.fastq", "reads1.fa", "query.fa" };
+
+        for (size_t i=0; i<ARRAY_SIZE(files); i++)
+        {
+            string filename = DBPATH(files[i]);
+            string bgzfname = filename + ".bgzf.gz";
+
+            bank_writeBGZF (filename, bgzfname, 1000);
+
+            BankFasta b (filename), bgz (filename + ".gz"), bbgzf (bgzfname);
+
+            CPPUNIT_ASSERT (bgz.getSize()   == b.getSize());
+            CPPUNIT_ASSERT (bbgzf.getSize() == b.getSize());
+
+            CPPUNIT_ASSERT (bgz.estimateNbItems()   == b.estimateNbItems());
+            CPPUNIT_ASSERT (bbgzf.estimateNbItems() == b.estimateNbItems());
+
+            CPPUNIT_ASSERT (System::file().remove (bgzfname) == 0);
+        }
     }
 
     /********************************************************************************/
@@ -599,8 +1045,9 @@ public:
         /** We check that the binary bank exists. */
         CPPUNIT_ASSERT (System::file().doesExist (filenameBin) == true);
 
-        /** We check that the binary file size is smaller than the original file (should be about 25%). */
-        if (checkSize)  {  CPPUNIT_ASSERT (System::file().getSize (filename) >= 4 * System::file().getSize (filenameBin));  }
+        /** We check that the binary file size is smaller than the original file (should be about 25%, a little
+         * more with the index of the blocks and the mask of the invalid nucleotides). */
+        if (checkSize)  {  CPPUNIT_ASSERT (26 * System::file().getSize (filename) >= 100 * System::file().getSize (filenameBin));  }
 
         Iterator<Sequence>* it1 = bank1.iterator();  LOCAL (it1);
         Iterator<Sequence>* it2 = bank2.iterator();  LOCAL (it2);
@@ -641,6 +1088,163 @@ public:
         bank_checkConvertBinary_aux (DBPATH("reads2.fa"),     true);
     }
 
+    /********************************************************************************/
+    static u_int64_t bank_hash_binary (Sequence& seq)
+    {
+        u_int64_t result = seq.getIndex();
+        for (size_t i=0; i<seq.getDataSize(); i++)  {  result = result*1000003 + Data::ConvertBinary::get (seq.getDataBuffer(), i).first;  }
+        return result;
+    }
+
+    struct BinarySplitFunctor
+    {
+        BinarySplitFunctor (u_int64_t& nb, u_int64_t& sum) : nb(nb), sum(sum) {}
+        void operator() (Sequence& seq)  {  __sync_fetch_and_add (&nb, 1);  __sync_fetch_and_add (&sum, bank_hash_binary(seq));  }
+        u_int64_t& nb;
+        u_int64_t& sum;
+    };
+
+    void bank_checkBinaryBlocks_aux (BankBinary& bank, const vector<u_int64_t>& check)
+    {
+        /** We check the exact number of sequences. */
+        CPPUNIT_ASSERT (bank.getNbItems() == (int64_t)check.size());
+
+        u_int64_t number=0, totalSize=0, maxSize=0;
+        bank.estimate (number, totalSize, maxSize);
+        CPPUNIT_ASSERT (number == check.size());
+
+        /** We check that the blocks, iterated one by one, provide the sequences of the bank. */
+        size_t nbSeq = 0;
+        for (size_t i=0; i<bank.getNbBlocks(); i++)
+        {
+            Iterator<Sequence>* it = bank.getBlockIterator (i);  LOCAL (it);
+            for (it->first(); !it->isDone(); it->next(), nbSeq++)
+            {
+                CPPUNIT_ASSERT (nbSeq < check.size());
+                CPPUNIT_ASSERT ((*it)->getIndex() == nbSeq);
+                CPPUNIT_ASSERT (bank_hash_binary (it->item()) == check[nbSeq]);
+            }
+        }
+        CPPUNIT_ASSERT (nbSeq == check.size());
+
+        /** We check that the parts of the bank provide the sequences of the bank. */
+        size_t nbPartsTable[] = { 1, 2, 3, 7, 1000 };
+        for (size_t p=0; p<ARRAY_SIZE(nbPartsTable); p++)
+        {
+            Iterator<Sequence>* it = bank.splitIterator (nbPartsTable[p]);  LOCAL (it);
+
+            u_int64_t nb=0, sum=0, checkSum=0;
+            for (size_t i=0; i<check.size(); i++)  { checkSum += check[i]; }
+
+            Dispatcher(4).iterate (it->getComposition(), BinarySplitFunctor(nb,sum));
+            CPPUNIT_ASSERT (nb == check.size());
+            CPPUNIT_ASSERT (sum == checkSum);
+        }
+    }
+
+    /** Writes a binary bank and checks that reading it fails. */
+    void bank_checkBinaryCorrupted_aux (const vector<char>& content, const string& filename)
+    {
+        FILE* file = fopen (filename.c_str(), "wb");
+        fwrite (content.data(), 1, content.size(), file);
+        fclose (file);
+
+        BankBinary bank (filename);
+
+        bool isCaught = false;
+        try  {  BankBinary::Iterator it (bank);  it.first();  }  catch (Exception& e)  { isCaught = true; }
+        CPPUNIT_ASSERT (isCaught == true);
+    }
+
+    /** \brief Check the index of the blocks of a binary bank.
+     */
+    void bank_checkBinaryBlocks ()
+    {
+        string filename    = DBPATH("reads2.fa");
+        string filenameBin = System::file().getTemporaryDirectory() + "/test_blocks.bin";
+
+        /** We use small blocks in order to have many of them. */
+        u_int64_t bufferSize = BankBinary::getBufferSize();
+        BankBinary::setBufferSize (4000);
+
+        BankFasta  bank1 (filename);
+        BankBinary bank2 (filenameBin);
+
+        BankBinary::setBufferSize (bufferSize);
+
+        vector<u_int64_t> check;
+        BankFasta::Iterator itSeq1 (bank1);
+        for (itSeq1.first(); !itSeq1.isDone(); itSeq1.next())  {  bank2.insert (*itSeq1);  }   bank2.flush ();
+
+        /** We compute the hash of the sequences as read from the binary bank. */
+        BankBinary::Iterator itSeq2 (bank2);
+        for (itSeq2.first(); !itSeq2.isDone(); itSeq2.next())  {  check.push_back (bank_hash_binary (itSeq2.item()));  }
+
+        CPPUNIT_ASSERT (check.size() > 0);
+        CPPUNIT_ASSERT (bank2.getNbBlocks() > 10);
+
+        bank_checkBinaryBlocks_aux (bank2, check);
+
+        /** We build a file of the first version of the format (no index at the end). */
+        vector<char> content (System::file().getSize (filenameBin));
+        FILE* file = fopen (filenameBin.c_str(), "rb");
+        CPPUNIT_ASSERT (fread (content.data(), 1, content.size(), file) == content.size());
+        fclose (file);
+
+        u_int64_t magic = 0x12345678;
+        u_int64_t nbBlocks = 0;
+        memcpy (&nbBlocks, content.data() + content.size() - 2*sizeof(u_int64_t), sizeof(nbBlocks));
+
+        /** A corrupted index must be rejected: a number of blocks whose index size wraps to 0... */
+        string filenameBad = filenameBin + "bad";
+        vector<char> bad = content;
+        u_int64_t hugeNbBlocks = (u_int64_t)1 << 61;
+        memcpy (bad.data() + bad.size() - 2*sizeof(u_int64_t), &hugeNbBlocks, sizeof(hugeNbBlocks));
+        bank_checkBinaryCorrupted_aux (bad, filenameBad);
+
+        /** ... or a block out of the file, here with an end that wraps to the beginning of the file. */
+        bad = content;
+        u_int64_t badBlock[2] = { 8, ~(u_int64_t)0 - 4 };
+        memcpy (bad.data() + bad.size() - (nbBlocks*5 + 2)*sizeof(u_int64_t), badBlock, sizeof(badBlock));
+        bank_checkBinaryCorrupted_aux (bad, filenameBad);
+
+        System::file().remove (filenameBad);
+        memcpy (content.data(), &magic, sizeof(magic));
+        content.resize (content.size() - (nbBlocks*5 + 2)*sizeof(u_int64_t));
+
+        string filenameBin1 = filenameBin + "1";
+        file = fopen (filenameBin1.c_str(), "wb");
+        fwrite (content.data(), 1, content.size(), file);
+        fclose (file);
+
+        CPPUNIT_ASSERT (BankBinary::check (filenameBin1) == true);
+
+        BankBinary bank3 (filenameBin1);
+        CPPUNIT_ASSERT (bank3.getNbBlocks() == nbBlocks);
+        bank_checkBinaryBlocks_aux (bank3, check);
+
+        /** An iterator keeps its sequences when the bank is rewritten, but the bank can't be read while
+         * it is being written. */
+        BankBinary::Iterator itLive (bank2);
+        itLive.first();
+
+        BankFasta::Iterator itFirst (bank1);
+        itFirst.first();
+        bank2.insert (*itFirst);
+
+        CPPUNIT_ASSERT (bank_hash_binary (itLive.item()) == check[0]);
+
+        bool isCaught = false;
+        try  {  BankBinary::Iterator it (bank2);  it.first();  }  catch (Exception& e)  { isCaught = true; }
+        CPPUNIT_ASSERT (isCaught == true);
+
+        bank2.flush ();
+        CPPUNIT_ASSERT (bank2.getNbItems() == 1);
+
+        System::file().remove (filenameBin);
+        System::file().remove (filenameBin1);
+    }
+
     /********************************************************************************/
     /** \brief Performance test
      */
@@ -882,6 +1486,82 @@ public:
         CPPUNIT_ASSERT (bankComposite.getNbItems()==ARRAY_SIZE(table));
     }
 
+    /********************************************************************************/
+    void bank_composite_parallel ()
+    {
+        const char* files[] = { "reads1.fa", "sample.fastq", "sample1.fa.gz", "reads2.fa", "sample2.fa" };
+
+        /** We get the expected sequences of each file (data and quality). */
+        vector<IBank*>         banks;
+        vector<vector<string> > check (ARRAY_SIZE(files));
+        size_t                 nbTotal = 0;
+
+        for (size_t i=0; i<ARRAY_SIZE(files); i++)
+        {
+            banks.push_back (new BankFasta (DBPATH(files[i])));
+
+            Iterator<Sequence>* it = banks[i]->iterator();  LOCAL (it);
+            for (it->first(); !it->isDone(); it->next())
+            {
+                check[i].push_back (it->item().toString() + it->item().getQuality());
+                nbTotal++;
+            }
+        }
+
+        BankComposite bankComposite (banks);
+
+        for (size_t nbReaders=1; nbReaders<=4; nbReaders++)
+        {
+            ParallelCompositeIterator<Sequence>* it = bankComposite.iteratorParallel (nbReaders);
+            LOCAL (it);
+
+            for (size_t pass=0; pass<2; pass++)
+            {
+                /** We check the sequences of each file, in their original order. */
+                vector<Iterator<Sequence>*> itBanks = it->getComposition();
+                CPPUNIT_ASSERT (itBanks.size() == ARRAY_SIZE(files));
+
+                for (size_t i=0; i<itBanks.size(); i++)
+                {
+                    size_t nb = 0;
+                    for (itBanks[i]->first(); !itBanks[i]->isDone(); itBanks[i]->next(), nb++)
+                    {
+                        CPPUNIT_ASSERT (nb < check[i].size());
+                        CPPUNIT_ASSERT (itBanks[i]->item().toString() + itBanks[i]->item().getQuality() == check[i][nb]);
+                    }
+                    CPPUNIT_ASSERT (nb == check[i].size());
+                }
+
+                /** We check the iteration of the composite: the files come one after the other, in their original order. */
+                vector<size_t> nbPerFile (ARRAY_SIZE(files), 0);
+                size_t nb = 0, previous = 0;
+                for (it->first(); !it->isDone(); it->next(), nb++)
+                {
+                    size_t idx = it->getCompositionIndex();
+                    CPPUNIT_ASSERT (idx < ARRAY_SIZE(files));
+                    CPPUNIT_ASSERT (idx >= previous && (idx == previous || nbPerFile[previous] == check[previous].size()));
+                    previous = idx;
+                    CPPUNIT_ASSERT (nbPerFile[idx] < check[idx].size());
+                    CPPUNIT_ASSERT (it->item().toString() + it->item().getQuality() == check[idx][nbPerFile[idx]++]);
+                }
+                CPPUNIT_ASSERT (nb == nbTotal);
+
+                /** We stop an iteration before its end; the readers must be stopped without error. */
+                nb = 0;
+                for (it->first(); !it->isDone() && nb<10; it->next())  { nb++; }
+                it->finalize();
+                CPPUNIT_ASSERT (nb == 10);
+            }
+        }
+
+        /** The iterator of the bank uses the readers when asked for. */
+        bankComposite.setNbReaders (3);
+        Iterator<Sequence>* itSeq = bankComposite.iterator();  LOCAL (itSeq);
+        size_t nb = 0;
+        for (itSeq->first(); !itSeq->isDone(); itSeq->next())  { nb++; }
+        CPPUNIT_ASSERT (nb == nbTotal);
+    }
+
     /********************************************************************************/
     void bank_album1 (void)
     {
@@ -33,12 +33,15 @@
 #include <gatb/debruijn/impl/Graph.hpp>
 #include <gatb/debruijn/impl/Terminator.hpp>
 #include <gatb/debruijn/impl/Traversal.hpp>
+#include <gatb/debruijn/impl/UnitigsAlgorithm.hpp>
+#include <gatb/debruijn/impl/ContigsAlgorithm.hpp>
 
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
 #include <gatb/kmer/impl/BloomAlgorithm.hpp>
 #include <gatb/kmer/impl/DebloomAlgorithm.hpp>
 
 #include <gatb/bank/impl/BankStrings.hpp>
+#include <gatb/bank/impl/BankFasta.hpp>
 #include <gatb/bank/impl/BankSplitter.hpp>
 #include <gatb/bank/impl/BankRandom.hpp>
 
@@ -103,8 +106,11 @@ class TestDebruijn : public Test
         CPPUNIT_TEST_GATB (debruijn_mutation);
         CPPUNIT_TEST_GATB (debruijn_build);
         CPPUNIT_TEST_GATB (debruijn_checkbranching);
+        CPPUNIT_TEST_GATB (debruijn_partitions);
+        CPPUNIT_TEST_GATB (debruijn_contigs);
 #ifdef WITH_MPHF
         CPPUNIT_TEST_GATB (debruijn_mphf);
+        CPPUNIT_TEST_GATB (debruijn_unitigs);
 #endif
         CPPUNIT_TEST_GATB (debruijn_traversal1);
 
@@ -808,6 +814,116 @@ public:
         return result;
     }
 
+    /********************************************************************************/
+    void debruijn_unitigs_aux (const char* sequences[], size_t len, size_t kmerSize, size_t nbCores, size_t nbUnitigs)
+    {
+        // We create the graph.
+        Graph graph = Graph::create (new BankStrings (sequences, len),  "-kmer-size %d  -abundance-min 1  -verbose 0 -mphf emphf  -max-memory %d", kmerSize, MAX_MEMORY);
+
+        string filename = "unitigs.fa";
+        System::file().remove (filename);
+
+        {
+            BankFasta* output = new BankFasta (filename);
+            LOCAL (output);
+
+            UnitigsAlgorithm algo (graph, output, nbCores, true);
+            algo.execute ();
+
+            CPPUNIT_ASSERT (algo.getNbUnitigs() == nbUnitigs);
+        }
+
+        // We check that each node of the graph belongs to exactly one unitig.
+        size_t nbNodes = 0;
+        Graph::Iterator<Node> it = graph.iterator<Node> ();
+        for (it.first(); !it.isDone(); it.next())  { nbNodes++; }
+
+        size_t nbUnitigNodes = 0;
+        size_t nbFound       = 0;
+
+        BankFasta input (filename);
+        Iterator<Sequence>* itSeq = input.iterator();
+        LOCAL (itSeq);
+
+        for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+        {
+            CPPUNIT_ASSERT (itSeq->item().getDataSize() >= kmerSize);
+            nbUnitigNodes += itSeq->item().getDataSize() - kmerSize + 1;
+            nbFound ++;
+        }
+
+        CPPUNIT_ASSERT (nbFound       == nbUnitigs);
+        CPPUNIT_ASSERT (nbUnitigNodes == nbNodes);
+
+        System::file().remove (filename);
+    }
+
+    /** */
+    void debruijn_unitigs ()
+    {
+        // a single linear path
+        const char* sequences1[] = { "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATAACC" };
+
+        // a bubble (one mutation in the second read) => 4 unitigs (left, two branches, right)
+        const char* sequences2[] =
+        {
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATAACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATGTTTGGTATTACGCTACAGCAG",
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATAACCATGTATAATTATAAGTCGGTACCTATTTTTTTATTTTAAACTGAAATGTTTGGTATTACGCTACAGCAG"
+        };
+
+        // a circular path (the last 10 nucleotides are the first ones) => 1 unitig
+        const char* sequences3[] = { "ACGTTGCATGCAGTCAGTTACGGATCAACGTTGCATG" };
+
+        size_t nbCores[] = { 1, 4 };
+
+        for (size_t i=0; i<ARRAY_SIZE(nbCores); i++)
+        {
+            debruijn_unitigs_aux (sequences1, ARRAY_SIZE(sequences1), 15, nbCores[i], 1);
+            debruijn_unitigs_aux (sequences2, ARRAY_SIZE(sequences2), 15, nbCores[i], 4);
+            debruijn_unitigs_aux (sequences3, ARRAY_SIZE(sequences3), 11, nbCores[i], 1);
+        }
+    }
+
+    /********************************************************************************/
+    void debruijn_contigs ()
+    {
+        Graph graph = Graph::create (new BankFasta (DBPATH("reads3.fa.gz")), "-kmer-size 31 -abundance-min 1 -verbose 0 -max-memory %d", MAX_MEMORY);
+
+        size_t nbCores[] = { 1, 2, 4 };
+
+        vector<string> ref;
+
+        for (size_t i=0; i<ARRAY_SIZE(nbCores); i++)
+        {
+            string filename = "contigs.fa";
+            System::file().remove (filename);
+
+            {
+                BankFasta* output = new BankFasta (filename);
+                LOCAL (output);
+
+                ContigsAlgorithm algo (graph, output, TRAVERSAL_CONTIG, nbCores[i]);
+                algo.execute ();
+
+                CPPUNIT_ASSERT (algo.getNbContigs() > 0);
+            }
+
+            vector<string> contigs;
+
+            BankFasta input (filename);
+            Iterator<Sequence>* itSeq = input.iterator();
+            LOCAL (itSeq);
+
+            for (itSeq->first(); !itSeq->isDone(); itSeq->next())  {  contigs.push_back (itSeq->item().toString());  }
+
+            // The contigs (and their order) must not depend on the number of cores.
+            if (i==0)  { ref = contigs; }
+            else       { CPPUNIT_ASSERT (contigs == ref); }
+
+            System::file().remove (filename);
+        }
+    }
+
     /********************************************************************************/
     void debruijn_build_aux (const char* sequences[], size_t nbSequences)
     {
@@ -995,6 +1111,44 @@ public:
 
     /********************************************************************************/
 
+    /** Check that the partitioned nodes iterators provide the same nodes as the global one. */
+    void debruijn_partitions ()
+    {
+        string filepath = DBPATH("reads3.fa.gz");
+
+        /** We create a graph. */
+        Graph graph = Graph::create ("-verbose 0 -in %s -max-memory %d", filepath.c_str(), MAX_MEMORY);
+
+        size_t      nbNodes1 = 0;
+        Node::Value checksum1 = 0;
+
+        Graph::Iterator<Node> it = graph.iterator<Node> ();
+        for (it.first(); !it.isDone(); it.next())  {  nbNodes1++;  checksum1 += it->kmer;  }
+
+        size_t      nbNodes2 = 0;
+        Node::Value checksum2 = 0;
+
+        std::vector<Graph::Iterator<Node> > partitions = graph.getNodesPartitioned ();
+        CPPUNIT_ASSERT (partitions.size() > 0);
+
+        for (size_t i=0; i<partitions.size(); i++)
+        {
+            size_t nbPartitionNodes = 0;
+            for (partitions[i].first(); !partitions[i].isDone(); partitions[i].next())
+            {
+                nbPartitionNodes++;  checksum2 += partitions[i]->kmer;
+            }
+            CPPUNIT_ASSERT (nbPartitionNodes == partitions[i].size());
+            nbNodes2 += nbPartitionNodes;
+        }
+
+        CPPUNIT_ASSERT (nbNodes1  == it.size());
+        CPPUNIT_ASSERT (nbNodes1  == nbNodes2);
+        CPPUNIT_ASSERT (checksum1 == checksum2);
+    }
+
+    /********************************************************************************/
+
     void debruijn_traversal1_aux_aux (bool useCopyTerminator, size_t kmerSize, const char** seqs, size_t seqsSize,
 		TraversalKind traversalKind, const char* checkStr
 	)
@@ -26,6 +26,7 @@
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
 #include <gatb/kmer/impl/Model.hpp>
 #include <gatb/kmer/impl/BankKmers.hpp>
+#include <gatb/kmer/impl/CountProcessorAbstract.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
@@ -41,6 +42,8 @@
 #include <boost/variant.hpp>
 #include <boost/mpl/for_each.hpp>
 
+#include <map>
+
 using namespace std;
 
 using namespace gatb::core::system;
@@ -81,6 +84,36 @@ struct Functor_getValue : public boost::static_visitor<Integer>    {
 template<typename T>  struct ToKmerVariant  {  typedef typename Kmer<T::value>::Count type;  };
 typedef boost::make_variant_over<boost::mpl::transform<IntegerList, ToKmerVariant<boost::mpl::_> >::type >::type KmerVariant;
 
+/** Count processor keeping the count vector of each kmer. */
+template<size_t span>
+class CountProcessorVectors : public CountProcessorAbstract<span>
+{
+public:
+
+    typedef typename Kmer<span>::Type Type;
+
+    CountProcessorAbstract<span>* clone ()  {  return new CountProcessorVectors ();  }
+
+    void finishClones (std::vector<ICountProcessor<span>*>& clones)
+    {
+        for (size_t i=0; i<clones.size(); i++)
+        {
+            if (CountProcessorVectors* clone = dynamic_cast<CountProcessorVectors*> (clones[i]))
+            {
+                _counts.insert (clone->_counts.begin(), clone->_counts.end());
+            }
+        }
+    }
+
+    bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum)
+    {
+        _counts[kmer] = count;
+        return true;
+    }
+
+    std::map<Type,CountVector> _counts;
+};
+
 /** \brief Test class for genomic databases management
  */
 class TestDSK : public Test
@@ -96,6 +129,7 @@ class TestDSK : public Test
         CPPUNIT_TEST_GATB (DSK_perBank2);
 
         CPPUNIT_TEST_GATB (DSK_perBankKmer);
+        CPPUNIT_TEST_GATB (DSK_perBankCores);
 
         CPPUNIT_TEST_GATB (DSK_multibank);
 
@@ -110,12 +144,13 @@ public:
     void tearDown () {}
 
     /********************************************************************************/
-    void DSK_check1_aux (const char* sequences[], size_t nbSequences, size_t kmerSize, size_t nks, size_t checkNbSolids)
+    void DSK_check1_aux (const char* sequences[], size_t nbSequences, size_t kmerSize, size_t nks, size_t checkNbSolids, size_t minimizerType=0)
     {
         /** We configure parameters for a SortingCountAlgorithm object. */
         IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
         params->setInt (STR_KMER_SIZE,          kmerSize);
         params->setInt (STR_KMER_ABUNDANCE_MIN, nks);
+        params->setInt (STR_MINIMIZER_TYPE,     minimizerType);
         params->setStr (STR_URI_OUTPUT,         "foo");
 
         /** We create a DSK instance. */
@@ -227,6 +262,15 @@ public:
         DSK_check1_aux (seqs4, ARRAY_SIZE(seqs4), 15, 1, 2691);
         DSK_check1_aux (seqs4, ARRAY_SIZE(seqs4), 15, 2, 5);
         DSK_check1_aux (seqs4, ARRAY_SIZE(seqs4), 15, 3, 0);
+
+        /** The solid kmers don't depend on the order of the minimizers (frequency, hashed). */
+        for (size_t minimizerType=1; minimizerType<=2; minimizerType++)
+        {
+            DSK_check1_aux (seqs4, ARRAY_SIZE(seqs4), 9,  1, 2540, minimizerType);
+            DSK_check1_aux (seqs4, ARRAY_SIZE(seqs4), 9,  2, 151,  minimizerType);
+            DSK_check1_aux (seqs4, ARRAY_SIZE(seqs4), 11, 2, 41,   minimizerType);
+            DSK_check1_aux (seqs4, ARRAY_SIZE(seqs4), 15, 2, 5,    minimizerType);
+        }
     }
 
     /********************************************************************************/
@@ -650,6 +694,56 @@ public:
         DSK_perBankKmer_aux (11, 3);
     }
 
+    /********************************************************************************/
+    /** The count vectors given to the count processors don't depend on the number of cores (several
+     * cores may parse the files of an album concurrently). They hold one count per bank, except for
+     * the sum solidity which gives the total count only. */
+    void DSK_perBankCores_aux (KmerSolidityKind solidityKind, size_t nbCounts)
+    {
+        typedef Kmer<KSIZE_1>::Type Type;
+
+        size_t nbCores[] = { 1, 8 };
+
+        std::map<Type,CountVector> counts[ARRAY_SIZE(nbCores)];
+
+        for (size_t i=0; i<ARRAY_SIZE(nbCores); i++)
+        {
+            /** The album holds reads1.fa and reads2.fa. */
+            IBank* bank = Bank::open (DBPATH("album.txt"));  LOCAL (bank);
+
+            IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();
+            params->setInt (STR_KMER_SIZE,          21);
+            params->setInt (STR_KMER_ABUNDANCE_MIN, 1);
+            params->setStr (STR_SOLIDITY_KIND,      toString(solidityKind));
+            params->setStr (STR_URI_OUTPUT,         "output");
+            params->add (0, STR_NB_CORES,  "%d", nbCores[i]);
+
+            SortingCountAlgorithm<KSIZE_1> sortingCount (bank, params);
+
+            CountProcessorVectors<KSIZE_1>* processor = new CountProcessorVectors<KSIZE_1> ();
+            sortingCount.addProcessor (processor);
+
+            sortingCount.execute();
+
+            counts[i] = processor->_counts;
+        }
+
+        CPPUNIT_ASSERT (counts[0].empty() == false);
+
+        for (std::map<Type,CountVector>::iterator it = counts[0].begin(); it != counts[0].end(); ++it)
+        {
+            CPPUNIT_ASSERT (it->second.size() == nbCounts);
+        }
+
+        CPPUNIT_ASSERT (counts[0] == counts[1]);
+    }
+
+    void DSK_perBankCores ()
+    {
+        DSK_perBankCores_aux (KMER_SOLIDITY_SUM, 1);
+        DSK_perBankCores_aux (KMER_SOLIDITY_MIN, 2);
+    }
+
     /********************************************************************************/
     struct DSK_multibank_aux  {  template<typename U> void operator() (U)
     {
@@ -76,6 +76,12 @@ class TestKmer : public Test
         CPPUNIT_TEST_GATB (kmer_minimizer);
         CPPUNIT_TEST_GATB (kmer_minimizer2);
         CPPUNIT_TEST_GATB (kmer_badchar);
+        CPPUNIT_TEST_GATB (kmer_neighbors);
+        CPPUNIT_TEST_GATB (kmer_buildBlock);
+        CPPUNIT_TEST_GATB (kmer_minimizerWindow);
+        CPPUNIT_TEST_GATB (kmer_minimizerDirectLut);
+        CPPUNIT_TEST_GATB (kmer_minimizerFastLexi);
+        CPPUNIT_TEST_GATB (kmer_fixedSize);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -478,6 +484,313 @@ public:
 
         model.iterate (data, fct);
     }
+
+    /********************************************************************************/
+    template<typename Type>
+    struct kmer_neighbors_functor
+    {
+        vector<Type>& neighbors;
+        kmer_neighbors_functor (vector<Type>& neighbors) : neighbors(neighbors) {}
+        void operator() (const Type& kmer)  {  neighbors.push_back (kmer);  }
+    };
+
+    template<size_t span>
+    void kmer_neighbors_aux (size_t kmerSize, size_t nbKmers)
+    {
+        typedef typename Kmer<span>::ModelCanonical Model;
+        typedef typename Kmer<span>::Type           Type;
+
+        Model model (kmerSize);
+
+        const char* nucleotides = "ACTG";
+
+        srand (0);
+
+        for (size_t n=0; n<nbKmers; n++)
+        {
+            string kmerStr;
+            for (size_t i=0; i<kmerSize; i++)  {  kmerStr += nucleotides[rand()%4];  }
+
+            Type kmer = model.codeSeed (kmerStr.c_str(), Data::ASCII).forward();
+
+            /** The neighbors are computed by rolling the kmer and its reverse complement... */
+            vector<Type> neighbors;
+            kmer_neighbors_functor<Type> fct (neighbors);
+            model.iterateNeighbors (kmer, fct);
+
+            CPPUNIT_ASSERT (neighbors.size() == 8);
+
+            /** ...and we check them against the canonical kmers of the extended strings. */
+            for (size_t nt=0; nt<4; nt++)
+            {
+                string outgoing = kmerStr.substr (1)            + nucleotides[nt];
+                string incoming = nucleotides[nt] + kmerStr.substr (0, kmerSize-1);
+
+                CPPUNIT_ASSERT (neighbors[nt]   == model.codeSeed (outgoing.c_str(), Data::ASCII).value());
+                CPPUNIT_ASSERT (neighbors[nt+4] == model.codeSeed (incoming.c_str(), Data::ASCII).value());
+            }
+        }
+    }
+
+    /** */
+    void kmer_neighbors ()
+    {
+        size_t kmerSizes[] = { 5, 21, 31 };
+        for (size_t i=0; i<ARRAY_SIZE(kmerSizes); i++)
+        {
+            kmer_neighbors_aux<KMER_SPAN(0)> (kmerSizes[i], 500);
+            kmer_neighbors_aux<KMER_SPAN(1)> (kmerSizes[i], 500);
+        }
+
+        kmer_neighbors_aux<KMER_SPAN(1)> (63, 500);
+        kmer_neighbors_aux<KMER_SPAN(2)> (63, 500);
+        kmer_neighbors_aux<KMER_SPAN(2)> (95, 500);
+        kmer_neighbors_aux<KMER_SPAN(3)> (127, 500);
+    }
+
+    /********************************************************************************/
+    template<size_t span>
+    void kmer_buildBlock_aux (size_t kmerSize)
+    {
+        typedef typename Kmer<span>::ModelCanonical Model;
+
+        Model model (kmerSize);
+
+        /** We use some invalid characters and lengths around the size of the chunks converted by 'iterate'. */
+        const char* nucleotides = "ACGTACGTACGTACGTNn";
+
+        srand (0);
+
+        vector<string> sequences;
+        for (size_t n=0; n<200; n++)
+        {
+            string seq;
+            size_t length = rand() % 600;
+            for (size_t i=0; i<length; i++)  {  seq += nucleotides[rand() % (rand()%10==0 ? 18 : 16)];  }
+            sequences.push_back (seq);
+        }
+
+        vector<Data>  data  (sequences.size(), Data(Data::ASCII));
+        vector<Data*> block (sequences.size());
+        for (size_t n=0; n<sequences.size(); n++)  {  data[n].setRef ((char*)sequences[n].data(), sequences[n].size());  block[n] = &data[n];  }
+
+        vector<typename Model::Kmer> kmers;
+        vector<size_t>               offsets;
+
+        size_t nbKmers = model.build (block, kmers, offsets);
+
+        CPPUNIT_ASSERT (nbKmers == kmers.size());
+        CPPUNIT_ASSERT (offsets.size() == sequences.size()+1);
+
+        /** We check each kmer against the kmer computed directly at its position. */
+        for (size_t n=0; n<sequences.size(); n++)
+        {
+            size_t length = sequences[n].size();
+            CPPUNIT_ASSERT (offsets[n+1]-offsets[n] == (length >= kmerSize ? length-kmerSize+1 : 0));
+
+            for (size_t i=0; i<offsets[n+1]-offsets[n]; i++)
+            {
+                typename Model::Kmer check = model.getKmer (data[n], i);
+
+                CPPUNIT_ASSERT (kmers[offsets[n]+i].isValid() == check.isValid());
+                if (check.isValid())  {  CPPUNIT_ASSERT (kmers[offsets[n]+i].value() == check.value());  }
+            }
+        }
+    }
+
+    /** */
+    void kmer_buildBlock ()
+    {
+        kmer_buildBlock_aux<KMER_SPAN(0)> (21);
+        kmer_buildBlock_aux<KMER_SPAN(0)> (31);
+        kmer_buildBlock_aux<KMER_SPAN(1)> (51);
+    }
+
+    /********************************************************************************/
+    template<size_t span, class ModelType>
+    void kmer_minimizerWindow_aux (size_t kmerSize, size_t miniSize, bool frequency)
+    {
+        typedef typename Kmer<span>::template ModelMinimizer<ModelType> Model;
+
+        srand (0);
+
+        /** We may use a random order of the mmers instead of the lexicographic one. */
+        vector<uint32_t> freq_order (1 << (2*miniSize));
+        size_t rg = freq_order.size();
+        for (size_t i=0; i<rg; i++)  {  freq_order[i] = i;  }
+        for (size_t i=rg-1; i>0; i--)  {  std::swap (freq_order[i], freq_order[rand() % (i+1)]);  }
+
+        /** As in RepartitionAlgorithm, the last mmer keeps the maximal rank, which stands for a forbidden mmer. */
+        for (size_t i=0; i<rg; i++)  {  if (freq_order[i] == rg-1)  {  freq_order[i] = freq_order[rg-1];  break;  }  }
+        freq_order[rg-1] = rg-1;
+
+        Model model (kmerSize, miniSize, typename Kmer<span>::ComparatorMinimizerFrequencyOrLex(), frequency ? &freq_order[0] : NULL);
+
+        const char* nucleotides = "ACGTACGTACGTACGTNn";
+
+        for (size_t n=0; n<100; n++)
+        {
+            string seq;
+            size_t length = rand() % 600;
+            for (size_t i=0; i<length; i++)  {  seq += nucleotides[rand() % (rand()%10==0 ? 18 : 16)];  }
+
+            /** We also use repeats, so the minimizers can be found several times in the kmers. */
+            if (n%2==0)  {  seq = seq.substr (0, seq.size()/8);  for (size_t i=0; i<3; i++)  {  seq += seq;  }  }
+
+            Data data ((char*)seq.data());
+
+            vector<typename Model::Kmer> kmers;
+            model.build (data, kmers);
+
+            /** We check each minimizer against the ones computed from the kmer alone, with and without the fast method. */
+            for (size_t i=0; i<kmers.size(); i++)
+            {
+                CPPUNIT_ASSERT (kmers[i].minimizer().value().getVal() == model.getMinimizerValue (kmers[i].value(0), false));
+                CPPUNIT_ASSERT (kmers[i].minimizer().value().getVal() == model.getMinimizerValue (kmers[i].value(0), true));
+
+                if (kmers[i].position() >= 0)
+                {
+                    string mmer = model.toString (kmers[i].value(0)).substr (kmers[i].position(), miniSize);
+                    CPPUNIT_ASSERT (model.getMmersModel().codeSeed (mmer.data(), Data::ASCII).value() == kmers[i].minimizer().value());
+                }
+            }
+        }
+    }
+
+    /** */
+    void kmer_minimizerWindow ()
+    {
+        size_t   kmerSizes[] = { 21, 31 };
+        size_t   miniSizes[] = {  5,  8, 10 };
+
+        for (size_t i=0; i<ARRAY_SIZE(kmerSizes); i++)
+        {
+            for (size_t j=0; j<ARRAY_SIZE(miniSizes); j++)
+            {
+                for (size_t f=0; f<2; f++)
+                {
+                    kmer_minimizerWindow_aux<KMER_SPAN(0), Kmer<KMER_SPAN(0)>::ModelCanonical> (kmerSizes[i], miniSizes[j], f==1);
+                    kmer_minimizerWindow_aux<KMER_SPAN(0), Kmer<KMER_SPAN(0)>::ModelDirect>    (kmerSizes[i], miniSizes[j], f==1);
+                }
+            }
+        }
+
+        kmer_minimizerWindow_aux<KMER_SPAN(1), Kmer<KMER_SPAN(1)>::ModelCanonical> (51, 10, false);
+        kmer_minimizerWindow_aux<KMER_SPAN(1), Kmer<KMER_SPAN(1)>::ModelCanonical> (51, 10, true);
+    }
+
+    /********************************************************************************/
+    /** Returns the superkmer boundaries of a sequence, as "index:minimizer" for each kmer
+     * whose minimizer differs from the one of the previous kmer. */
+    template<class ModelType>
+    string kmer_minimizerBoundaries_aux (size_t kmerSize, size_t miniSize, const char* seq)
+    {
+        typedef Kmer<KMER_SPAN(0)>::ModelMinimizer<ModelType> Model;
+
+        Model model (kmerSize, miniSize);
+        Data  data ((char*)seq);
+
+        vector<typename Model::Kmer> kmers;
+        model.build (data, kmers);
+
+        string result, previous;
+        for (size_t i=0; i<kmers.size(); i++)
+        {
+            string mmer = model.getMmersModel().toString (kmers[i].minimizer().value());
+            if (mmer != previous)
+            {
+                char index[32];  snprintf (index, sizeof(index), "%s%d:", result.empty() ? "" : " ", (int)i);
+                result += index + mmer;
+            }
+            previous = mmer;
+
+            CPPUNIT_ASSERT (kmers[i].minimizer().value().getVal() == model.getMinimizerValue (kmers[i].value(0), false));
+            CPPUNIT_ASSERT (kmers[i].minimizer().value().getVal() == model.getMinimizerValue (kmers[i].value(0), true));
+        }
+        return result;
+    }
+
+    /** */
+    void kmer_minimizerDirectLut ()
+    {
+        /** With the lexicographic order, CAAC is forbidden (AA inside). The direct model used
+         * to extract the new right mmer without the LUT, so CAAC was the minimizer of the second
+         * kmer: "0:GGCA 1:CAAC 2:AACG 8:ACGG 9:CGGG 10:GGGG". */
+        CPPUNIT_ASSERT (kmer_minimizerBoundaries_aux<Kmer<KMER_SPAN(0)>::ModelDirect> (9, 4, "GGGGGGCAACGGGGGGGGGG")
+            == "0:GGCA 2:AACG 8:ACGG 9:CGGG 10:GGGG"
+        );
+    }
+
+    /** */
+    void kmer_minimizerFastLexi ()
+    {
+        /** For m>8, the fast lexicographic method computed the revcomp of the mmers as if m=8,
+         * which lost the AACCTTCAC minimizer: "0:AAGGTTTAC 6:ACTTCGAGA 8:ACCTCATAT". */
+        CPPUNIT_ASSERT (kmer_minimizerBoundaries_aux<Kmer<KMER_SPAN(0)>::ModelCanonical> (21, 9, "GAGTGAAGGTTTACTTCGAGATATGAGGTGGAGATGAGCC")
+            == "0:AACCTTCAC 3:AAGGTTTAC 6:ACTTCGAGA 8:ACCTCATAT"
+        );
+    }
+
+    /********************************************************************************/
+    struct kmer_fixedSize_functor
+    {
+        size_t& kmerSize;
+        kmer_fixedSize_functor (size_t& kmerSize) : kmerSize(kmerSize) {}
+        template<class Model>  void operator() (const Model& model)  {  kmerSize = model.getKmerSize();  }
+    };
+
+    template<size_t span, size_t K>
+    void kmer_fixedSize_aux (size_t nbKmers)
+    {
+        typedef typename Kmer<span>::Type Type;
+
+        typename Kmer<span>::ModelCanonical   model (K);
+        typename Kmer<span>::template FixedSize<K> fixed;
+
+        CPPUNIT_ASSERT (fixed.getKmerSize() == K);
+        CPPUNIT_ASSERT (fixed.getKmerMax()  == model.getKmerMax());
+
+        /** The functor gets the kmer size, whether it is one of KSIZE_FIXED_LIST or not. */
+        size_t kmerSize = 0;
+        kmer_fixedSize_functor fct (kmerSize);
+        Kmer<span>::applyFixedSize (model, fct);
+        CPPUNIT_ASSERT (kmerSize == K);
+
+        srand (0);
+
+        for (size_t n=0; n<nbKmers; n++)
+        {
+            Type kmer = 0;
+            for (size_t i=0; i<K; i++)  {  kmer = (kmer << 2) + Type(rand()%4);  }
+
+            CPPUNIT_ASSERT (fixed.reverse(kmer) == model.reverse(kmer));
+
+            for (size_t nt=0; nt<4; nt++)
+            {
+                Type f1 = kmer, r1 = model.reverse(kmer), f2 = f1, r2 = r1;
+
+                model.rollRight (f1, r1, nt);
+                fixed.rollRight (f2, r2, nt);
+                CPPUNIT_ASSERT (f1 == f2 && r1 == r2);
+
+                model.rollLeft (f1, r1, nt);
+                fixed.rollLeft (f2, r2, nt);
+                CPPUNIT_ASSERT (f1 == f2 && r1 == r2);
+            }
+        }
+    }
+
+    /** */
+    void kmer_fixedSize ()
+    {
+        kmer_fixedSize_aux<KMER_SPAN(0),21>  (1000);
+        kmer_fixedSize_aux<KMER_SPAN(0),31>  (1000);
+        kmer_fixedSize_aux<KMER_SPAN(1),31>  (1000);
+        kmer_fixedSize_aux<KMER_SPAN(1),51>  (1000);
+        kmer_fixedSize_aux<KMER_SPAN(1),63>  (1000);
+        kmer_fixedSize_aux<KMER_SPAN(2),95>  (1000);
+        kmer_fixedSize_aux<KMER_SPAN(3),127> (1000);
+    }
 };
 
 /********************************************************************************/
@@ -37,6 +37,7 @@ using namespace gatb::core::tools::dp;
 using namespace gatb::core::tools::dp::impl;
 
 using namespace gatb::core::tools::math;
+using namespace gatb::core::tools::misc;
 
 using namespace gatb::core::bank;
 using namespace gatb::core::bank::impl;
@@ -70,14 +71,13 @@ public:
 
     /********************************************************************************/
     template<class ModelType>
-    void kmerbank_checkKmersFromBankAndBankBinary_aux (const char* filepath, size_t span)
+    void kmerbank_checkKmersFromBankAndBankBinary_aux (const string& filename, size_t span)
     {
         /** Shortcuts. */
         typedef typename ModelType::Kmer     Kmer;
         typedef typename ModelType::Iterator ModelIterator;
 
-        string filename    = DBPATH (filepath);
-        string filenameBin = filepath + string(".bin");
+        string filenameBin = System::file().getTemporaryDirectory() + "/" + System::file().getBaseName (filename) + ".bin";
 
         /** We check that the bank exists. */
         CPPUNIT_ASSERT (System::file().doesExist (filename) == true);
@@ -115,9 +115,25 @@ public:
             /** We loop the kmers for the two datas. */
             for (itKmer.first(); !itKmer.isDone();  itKmer.next())
             {
-                CPPUNIT_ASSERT (itKmer->first.value() == itKmer->second.value());
+                CPPUNIT_ASSERT (itKmer->first.value()   == itKmer->second.value());
+                CPPUNIT_ASSERT (itKmer->first.isValid() == itKmer->second.isValid());
+            }
+
+            /** We check the kmers built at a given index, the binary data telling invalid nucleotides by its mask. */
+            Data& data1 = (*itSeq1)->getData();
+            Data& data2 = (*itSeq2)->getData();
+
+            for (size_t idx=0; idx+span <= data1.size(); idx++)
+            {
+                Kmer kmer1 = model.getKmer (data1, idx);
+                Kmer kmer2 = model.getKmer (data2, idx);
+
+                CPPUNIT_ASSERT (kmer1.value()   == kmer2.value());
+                CPPUNIT_ASSERT (kmer1.isValid() == kmer2.isValid());
             }
         }
+
+        bank2.remove ();
     }
 
     /** \brief check that Bank and BankBinary provide the same set of kmers
@@ -134,10 +150,38 @@ public:
         {
             for (size_t j=0; j<ARRAY_SIZE(spans); j++)
             {
-                kmerbank_checkKmersFromBankAndBankBinary_aux <Kmer<>::ModelDirect>    (files[i], spans[j]);
-                kmerbank_checkKmersFromBankAndBankBinary_aux <Kmer<>::ModelCanonical> (files[i], spans[j]);
+                kmerbank_checkKmersFromBankAndBankBinary_aux <Kmer<>::ModelDirect>    (DBPATH(files[i]), spans[j]);
+                kmerbank_checkKmersFromBankAndBankBinary_aux <Kmer<>::ModelCanonical> (DBPATH(files[i]), spans[j]);
+            }
+        }
+
+        /** We check a bank with invalid nucleotides, which must give invalid kmers in the binary bank too. */
+        string filename = System::file().getTemporaryDirectory() + "/test_invalid.fa";
+        FILE* file = fopen (filename.c_str(), "w");
+        CPPUNIT_ASSERT (file != 0);
+
+        const char* invalid[] = { "N", "NNNNN", "n", "Y", "NNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNN" };
+        srand (5);
+        for (size_t i=0; i<500; i++)
+        {
+            string seq;
+            size_t len = 1 + rand() % 150;
+            while (seq.size() < len)
+            {
+                if (rand()%20 == 0)  {  seq += invalid[rand() % ARRAY_SIZE(invalid)];  }
+                else                 {  seq += "ACGT"[rand()%4];  }
             }
+            fprintf (file, ">read%ld\n%s\n", i, seq.c_str());
         }
+        fclose (file);
+
+        for (size_t j=0; j<ARRAY_SIZE(spans); j++)
+        {
+            kmerbank_checkKmersFromBankAndBankBinary_aux <Kmer<>::ModelDirect>    (filename, spans[j]);
+            kmerbank_checkKmersFromBankAndBankBinary_aux <Kmer<>::ModelCanonical> (filename, spans[j]);
+        }
+
+        System::file().remove (filename);
     }
 
     /********************************************************************************/
@@ -34,6 +34,7 @@
 #include <gatb/tools/storage/impl/Storage.hpp>
 
 #include <gatb/tools/collections/impl/MPHF.hpp>
+#include <gatb/tools/collections/impl/MapMPHF.hpp>
 
 using namespace std;
 
@@ -71,6 +72,7 @@ class TestMPHF : public Test
 
         CPPUNIT_TEST_GATB (MPHF_check1);
         CPPUNIT_TEST_GATB (MPHF_check2);
+        CPPUNIT_TEST_GATB (MPHF_check3);
 
         CPPUNIT_TEST_GATB (test_mphf1);
         CPPUNIT_TEST_GATB (test_mphf2);
@@ -254,6 +256,70 @@ public:
         }
     }
 
+    /********************************************************************************/
+    void MPHF_check3 ()
+    {
+        /** We define our packed map type for kmers. */
+        typedef MapMPHFPacked<Type> Map;
+
+        /** We check that we can use such a type. */
+        if (Map::enabled == false) { return; }
+
+        size_t kmerSize = 11;
+
+        const char* seqs[] = {
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATA"
+            "ACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATTCAATATTATATAGGCAAAG"
+        } ;
+
+        /** We configure parameters for a SortingCountAlgorithm object. */
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();
+        params->setInt (STR_KMER_SIZE,          kmerSize);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, 1);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+
+        /** We create a DSK instance and launch it. */
+        SortingCountAlgorithm<> sortingCount (new BankStrings (seqs, ARRAY_SIZE(seqs)), params);
+        sortingCount.execute();
+
+        Iterable<Type>* solids = sortingCount.getSolidKmers();
+
+        /** We check the different encodings: exact values with overflow table, and log scale. */
+        size_t bits[]     = { 3, 4, 5, 8, 4, 6 };
+        bool   logScale[] = { false, false, false, false, true, true };
+
+        for (size_t k=0; k<ARRAY_SIZE(bits); k++)
+        {
+            Map theMap (bits[k], 255, logScale[k]);
+            theMap.build (*solids);
+
+            CPPUNIT_ASSERT (theMap.size() == solids->getNbItems());
+
+            /** We set a value per kmer (some of them don't fit the packed bits). */
+            for (size_t i=0; i<theMap.size(); i++)  {  theMap.set (i, (i*7) % 300);  }
+            theMap.flush();
+
+            Map::Value previous = 0;
+
+            for (size_t i=0; i<theMap.size(); i++)
+            {
+                Map::Value expected = std::min ((i*7) % 300, (size_t)255);
+
+                if (logScale[k] == false)  {  CPPUNIT_ASSERT (theMap.get(i) == expected);  }
+                else
+                {
+                    /** Small values are exact, others are approximated within the log step. */
+                    if (expected < (1U << (bits[k]-1)))  {  CPPUNIT_ASSERT (theMap.get(i) == expected);  }
+                    else  {  CPPUNIT_ASSERT (theMap.get(i) > expected/2 && theMap.get(i) < expected*2);  }
+                }
+            }
+
+            /** Overwriting an overflowed value must be taken into account. */
+            theMap.at(0) = 1000;   CPPUNIT_ASSERT (theMap.get(0) == 255);
+            theMap.at(0) = 1;      CPPUNIT_ASSERT (theMap.get(0) == 1);
+        }
+    }
+
     /********************************************************************************/
     void test_mphf1 (void)
     {
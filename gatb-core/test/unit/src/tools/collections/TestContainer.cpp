@@ -19,6 +19,7 @@
 #include <CppunitCommon.hpp>
 
 #include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/collections/impl/HyperLogLog.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 
@@ -30,6 +31,7 @@
 #include <time.h>       /* time */
 
 #include <set>
+#include <vector>
 
 using namespace std;
 using namespace gatb::core::tools::collections;
@@ -50,6 +52,8 @@ class TestContainer : public Test
     CPPUNIT_TEST_SUITE_GATB (TestContainer);
 
         CPPUNIT_TEST_GATB (bloom_checkContains);
+        CPPUNIT_TEST_GATB (bloom_checkHashVersions);
+        CPPUNIT_TEST_GATB (hyperloglog_check);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -129,6 +133,99 @@ public:
         bloom_checkContains_aux<LargeInt<5> > (values2, ARRAY_SIZE(values2));
         bloom_checkContains_aux<LargeInt<5> > (values3, ARRAY_SIZE(values3));
     }
+
+    /********************************************************************************/
+    template<typename Item> void bloom_checkHashVersions_aux (int version)
+    {
+        Bloom<Item>              bloom1 (1000*1000, 4, version);
+        BloomCacheCoherent<Item> bloom2 (1000*1000, 4, 12, version);
+
+        CPPUNIT_ASSERT (bloom1.getHashVersion() == version);
+        CPPUNIT_ASSERT (bloom2.getHashVersion() == version);
+
+        std::vector<Item> items;
+        for (size_t i=0; i<1000; i++)
+        {
+            Item item (rand());
+            for (size_t j=0; j<sizeof(Item)/sizeof(int); j++)  {  item = (item << 31) + Item(rand());  }
+            items.push_back (item);
+        }
+
+        for (size_t i=0; i<items.size(); i++)  {  bloom1.insert (items[i]);  bloom2.insert (items[i]);  }
+
+        /** We check there is no false negative. */
+        for (size_t i=0; i<items.size(); i++)
+        {
+            CPPUNIT_ASSERT (bloom1.contains (items[i]) == true);
+            CPPUNIT_ASSERT (bloom2.contains (items[i]) == true);
+        }
+    }
+
+    /** */
+    void bloom_checkHashVersions ()
+    {
+        /** The version 0 of the hash functions relies on hash1 which must not change (Bloom filters of
+         * existing files): it is the xor of the hashes of the words of the integer. */
+        u_int64_t w0 = 0x0123456789abcdefULL, w1 = 0xfedcba9876543210ULL, w2 = 0x1122334455667788ULL;
+        LargeInt<3> x = (((LargeInt<3>(w2) << 64) + LargeInt<3>(w1)) << 64) + LargeInt<3>(w0);
+        CPPUNIT_ASSERT (hash1 (x, 17) == (NativeInt64::hash64 (w0,17) ^ NativeInt64::hash64 (w1,17) ^ NativeInt64::hash64 (w2,17)));
+        CPPUNIT_ASSERT (oahash (x) == (NativeInt64::oahash64 (w0) ^ NativeInt64::oahash64 (w1) ^ NativeInt64::oahash64 (w2)));
+
+        for (int version=0; version<=HashFunctors<NativeInt64>::LAST_VERSION; version++)
+        {
+            bloom_checkHashVersions_aux<NativeInt64>  (version);
+            bloom_checkHashVersions_aux<LargeInt<1> > (version);
+            bloom_checkHashVersions_aux<LargeInt<2> > (version);
+            bloom_checkHashVersions_aux<LargeInt<3> > (version);
+        }
+    }
+
+    /********************************************************************************/
+    template<typename Item> void hyperloglog_check_aux (u_int64_t nbItems)
+    {
+        HyperLogLog hll, hll1, hll2;
+
+        /** Each item is inserted 3 times, in a single estimator and across two estimators. */
+        for (size_t n=0; n<3; n++)
+        {
+            for (u_int64_t i=0; i<nbItems; i++)
+            {
+                Item item = (Item(i) << 64) + Item(i*17);
+                hll.insert (item);
+                if (i%2==0)  { hll1.insert (item); }  else  { hll2.insert (item); }
+            }
+        }
+
+        /** We check the estimation is within 5% (about 3 standard errors). */
+        u_int64_t estimate = hll.count();
+        CPPUNIT_ASSERT (estimate >= nbItems*0.95  &&  estimate <= nbItems*1.05);
+
+        /** We check the merge of the two estimators gives the same estimation. */
+        hll1.merge (hll2);
+        CPPUNIT_ASSERT (hll1.count() == estimate);
+    }
+
+    /** */
+    void hyperloglog_check ()
+    {
+        u_int64_t nbItems[] = { 10, 1000, 50000, 1000000 };
+
+        for (size_t i=0; i<ARRAY_SIZE(nbItems); i++)
+        {
+            hyperloglog_check_aux<LargeInt<2> > (nbItems[i]);
+            hyperloglog_check_aux<LargeInt<3> > (nbItems[i]);
+        }
+
+        /** We check the precision bounds and that different precisions can't be merged. */
+        bool hasThrown = false;
+        try  {  HyperLogLog hll (2);  }  catch (gatb::core::system::Exception& e)  { hasThrown = true; }
+        CPPUNIT_ASSERT (hasThrown);
+
+        hasThrown = false;
+        HyperLogLog hll1 (10), hll2 (12);
+        try  {  hll1.merge (hll2);  }  catch (gatb::core::system::Exception& e)  { hasThrown = true; }
+        CPPUNIT_ASSERT (hasThrown);
+    }
 };
 
 /********************************************************************************/
@@ -20,6 +20,11 @@
 
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/tools/math/Integer.hpp>
+#include <gatb/tools/misc/api/Macros.hpp>
+
+#include <set>
+#include <vector>
+#include <cmath>
 
 using namespace std;
 using namespace gatb::core::tools::math;
@@ -36,6 +41,9 @@ class TestMath : public Test
         CPPUNIT_TEST_GATB (math_checkBasic);
         CPPUNIT_TEST_GATB (math_checkFibo);
         CPPUNIT_TEST_GATB (math_test1);
+        CPPUNIT_TEST_GATB (math_revcomp);
+        CPPUNIT_TEST_GATB (math_nucleotides);
+        CPPUNIT_TEST_GATB (math_hashInvertible);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -171,6 +179,138 @@ public:
         math_test1_template <LargeInt<4> >();
         math_test1_template <LargeInt<5> >();
     }
+
+    /********************************************************************************/
+    template <typename T> void math_revcomp_template (size_t nbKmers)
+    {
+        srand (0);
+
+        for (size_t kmerSize=1; kmerSize<=T::getSize()/2; kmerSize++)
+        {
+            for (size_t n=0; n<nbKmers; n++)
+            {
+                /** We build a random kmer and its reverse complement, nucleotide by nucleotide
+                 * (A=0, C=1, T=2, G=3, so the complement of a nucleotide is a xor with 2). */
+                T kmer (0);
+                T check (0);
+
+                for (size_t i=0; i<kmerSize; i++)
+                {
+                    u_int64_t nt = rand() & 3;
+                    kmer  = (kmer << 2) + T(nt);
+                    check = check + (T(nt^2) << (2*i));
+                }
+
+                CPPUNIT_ASSERT (revcomp (kmer,  kmerSize) == check);
+                CPPUNIT_ASSERT (revcomp (check, kmerSize) == kmer);
+            }
+        }
+    }
+
+    void math_revcomp ()
+    {
+        math_revcomp_template <LargeInt<1> > (100);
+        math_revcomp_template <LargeInt<2> > (100);
+        math_revcomp_template <LargeInt<3> > (100);
+        math_revcomp_template <LargeInt<4> > (100);
+        math_revcomp_template <LargeInt<5> > (100);
+    }
+
+    /********************************************************************************/
+    template <typename T> void math_nucleotides_template (size_t nbKmers)
+    {
+        char bin2NT[4] = {'A','C','T','G'};
+
+        srand (0);
+
+        size_t kmerSize = T::getSize()/2;
+
+        for (size_t n=0; n<nbKmers; n++)
+        {
+            /** We build a random kmer, its ASCII string and a mask of its 4 last nucleotides. */
+            T kmer (0);
+            T mask (0);
+            string check;
+
+            for (size_t i=0; i<kmerSize; i++)
+            {
+                u_int64_t nt = rand() & 3;
+                kmer  = (kmer << 2) + T(nt);
+                check += bin2NT[nt];
+            }
+            for (size_t i=0; i<4; i++)  {  mask = (mask << 2) + T(3);  }
+
+            /** operator[] starts from the last nucleotide. */
+            for (size_t i=0; i<kmerSize; i++)  {  CPPUNIT_ASSERT (kmer[i] == string("ACTG").find (check[kmerSize-1-i]));  }
+
+            CPPUNIT_ASSERT (kmer.toString(kmerSize) == check);
+
+            /** Assignment operators and their synchronized versions give the same result as the plain operators. */
+            T a = kmer;  a &= mask;                    CPPUNIT_ASSERT (a == (kmer & mask));
+            T b = kmer;  b |= mask;                    CPPUNIT_ASSERT (b == (kmer | mask));
+            T c = kmer;  c.sync_fetch_and_and (mask);  CPPUNIT_ASSERT (c == (kmer & mask));
+            T d = kmer;  d.sync_fetch_and_or  (mask);  CPPUNIT_ASSERT (d == (kmer | mask));
+        }
+    }
+
+    void math_nucleotides ()
+    {
+        math_nucleotides_template <LargeInt<1> > (100);
+        math_nucleotides_template <LargeInt<2> > (100);
+        math_nucleotides_template <LargeInt<3> > (100);
+        math_nucleotides_template <LargeInt<4> > (100);
+        math_nucleotides_template <LargeInt<5> > (100);
+    }
+
+    /********************************************************************************/
+    /** The hashed order of the mmers must be a permutation that doesn't keep the order of the keys. */
+    void math_hashInvertible ()
+    {
+        size_t miniSizes[] = { 1, 2, 4, 8, 10 };
+
+        for (size_t i=0; i<ARRAY_SIZE(miniSizes); i++)
+        {
+            u_int64_t rg   = (u_int64_t)1 << (2*miniSizes[i]);
+            u_int64_t mask = rg - 1;
+
+            vector<bool> found (rg, false);
+            for (u_int64_t key=0; key<rg; key++)
+            {
+                u_int64_t rank = NativeInt64::hash64Invertible (key, mask);
+                CPPUNIT_ASSERT (rank < rg);
+                CPPUNIT_ASSERT (found[rank] == false);
+                found[rank] = true;
+            }
+        }
+
+        /** For m=8 (the default), we check that the ranks are not correlated with the keys, that the ranks of
+         * adjacent keys are not a constant apart, and that the low bits of the ranks depend on the first nucleotide. */
+        u_int64_t rg   = (u_int64_t)1 << 16;
+        u_int64_t mask = rg - 1;
+
+        double sx=0, sy=0, sxy=0, sxx=0, syy=0;
+        set<u_int64_t> deltas;
+        u_int64_t nbLowChanged = 0;
+
+        for (u_int64_t key=0; key<rg; key++)
+        {
+            double x = key;
+            double y = NativeInt64::hash64Invertible (key, mask);
+            sx += x;  sy += y;  sxy += x*y;  sxx += x*x;  syy += y*y;
+
+            deltas.insert ((NativeInt64::hash64Invertible ((key+1) & mask, mask) - (u_int64_t)y) & mask);
+
+            u_int64_t other = key ^ ((u_int64_t)3 << 14);
+            if ((NativeInt64::hash64Invertible (other, mask) & 3) != ((u_int64_t)y & 3))  { nbLowChanged++; }
+        }
+
+        double n = rg;
+        double corr = (sxy - sx*sy/n) / sqrt ((sxx - sx*sx/n) * (syy - sy*sy/n));
+
+        CPPUNIT_ASSERT (fabs (corr) < 0.01);
+        CPPUNIT_ASSERT (deltas.size() > rg/4);
+        CPPUNIT_ASSERT (nbLowChanged > rg*7/10  &&  nbLowChanged < rg*8/10);
+    }
 };
 
 /********************************************************************************/
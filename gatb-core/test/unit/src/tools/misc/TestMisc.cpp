@@ -23,12 +23,14 @@
 
 #include <gatb/tools/misc/api/Range.hpp>
 #include <gatb/tools/misc/api/Vector.hpp>
+#include <gatb/tools/misc/api/Data.hpp>
 #include <gatb/tools/misc/api/Macros.hpp>
 
 #include <gatb/tools/misc/impl/OptionsParser.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
 
 #include <gatb/tools/misc/impl/StringLine.hpp>
+#include <gatb/tools/misc/impl/Histogram.hpp>
 
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
@@ -62,11 +64,14 @@ class TestMisc : public Test
         // DEACTIVATED BECAUSE OF MACOS (TO BE INVESTIGATED...)  CPPUNIT_TEST_GATB (vector_check1);
         CPPUNIT_TEST_GATB (vector_check2);
         CPPUNIT_TEST_GATB (vector_check3);
+        CPPUNIT_TEST_GATB (data_checkInvalidMask);
         CPPUNIT_TEST_GATB (parser_check1);
         CPPUNIT_TEST_GATB (parser_check2);
 
         CPPUNIT_TEST_GATB (stringline_check1);
 
+        CPPUNIT_TEST_GATB (histogram_check1);
+
     CPPUNIT_TEST_SUITE_GATB_END();
 
 public:
@@ -234,6 +239,38 @@ public:
         CPPUNIT_ASSERT (ref3[2] == 21);
     }
 
+    /********************************************************************************/
+    /** A sub range of a BINARY data keeps the invalid nucleotides of the range, rebased to its start. */
+    void data_checkInvalidMask ()
+    {
+        /** 40 nucleotides with the invalid runs [2,5) [10,14) [30,31) */
+        Data* ref = new Data (Data::BINARY);
+        ref->resize (10);
+        ref->setSize (40);
+
+        u_int32_t runs[] = { 2,3, 10,4, 30,1 };
+        ref->getInvalidMask().assign (runs, runs + ARRAY_SIZE(runs));
+
+        /** Nucleotides [8,20): the first byte is 2 and the length is 12. */
+        Data sub (Data::ASCII);
+        sub.getInvalidMask().push_back (0);  sub.getInvalidMask().push_back (1);   // stale mask
+        sub.setRef (ref, 2, 12);
+
+        CPPUNIT_ASSERT (sub.getEncoding() == Data::BINARY);
+        CPPUNIT_ASSERT (sub.getInvalidMask().size() == 2);
+        CPPUNIT_ASSERT (sub.getInvalidMask()[0] == 2);
+        CPPUNIT_ASSERT (sub.getInvalidMask()[1] == 4);
+
+        /** Nucleotides [4,32): the runs are clipped to the range. */
+        sub.setRef (ref, 1, 28);
+        u_int32_t check[] = { 0,1, 6,4, 26,1 };
+        CPPUNIT_ASSERT (sub.getInvalidMask() == Data::InvalidMask (check, check + ARRAY_SIZE(check)));
+
+        /** Nucleotides [16,28): no invalid nucleotide. */
+        sub.setRef (ref, 4, 12);
+        CPPUNIT_ASSERT (sub.getInvalidMask().empty());
+    }
+
     /********************************************************************************/
     void parser_check1_aux (IOptionsParser* parser, const string& str, bool ok, size_t nbProps, const string& check)
     {
@@ -406,6 +443,38 @@ public:
         CPPUNIT_ASSERT (StringLine::format (s1).size() == StringLine::getDefaultWidth());
         CPPUNIT_ASSERT (StringLine::format (s2).size() == StringLine::getDefaultWidth());
     }
+
+    /********************************************************************************/
+    /** \brief test of HistogramCache class
+     *
+     * We fill several caches of one histogram and check that the histogram gets the same
+     * values as a histogram filled directly, whatever the number of 'flush' calls.
+     */
+    void histogram_check1 (void)
+    {
+        size_t length = 100;
+        size_t nbCaches = 4;
+
+        Histogram* histo = new Histogram (length);  LOCAL (histo);
+        Histogram  check (length);
+
+        vector<HistogramCache*> caches;
+        for (size_t i=0; i<nbCaches; i++)  {  caches.push_back (new HistogramCache (histo));  caches.back()->use();  }
+
+        /** We also use values beyond the histogram length. */
+        for (size_t n=0; n<10000; n++)
+        {
+            u_int16_t value = 1 + rand() % (2*length);
+            caches[n%nbCaches]->inc (value);
+            check.inc (value);
+        }
+
+        /** The first caches are merged explicitly (twice), the other ones when they are destroyed. */
+        for (size_t i=0; i<nbCaches/2; i++)  {  caches[i]->flush();  caches[i]->flush();  }
+        for (size_t i=0; i<nbCaches;   i++)  {  caches[i]->forget();  }
+
+        for (size_t i=1; i<=length; i++)  {  CPPUNIT_ASSERT (histo->get(i) == check.get(i));  }
+    }
 };
 
 /********************************************************************************/